@@ -5,8 +5,8 @@
 ##     - EFD_EXE
 ##     - EFD_HOME
 ##
-## Even though `Q_jku` can be executed on 'A_ibmqx3', it uses up all
-## travis available memory (3GB) when compiling 'adder.qasm'.
+## `Q_jku` keeps at most `--jku-max-nodes` A* nodes in memory, falling
+## back to a beam search when it reaches that limit.
 
 ALGS_QX2=""
 ALGS_QX2="${ALGS_QX2} Q_dynprog"
@@ -15,6 +15,9 @@ ALGS_QX2="${ALGS_QX2} Q_bmt"
 ALGS_QX2="${ALGS_QX2} Q_simplified_bmt"
 ALGS_QX2="${ALGS_QX2} Q_ibmt"
 ALGS_QX2="${ALGS_QX2} Q_simplified_ibmt"
+ALGS_QX2="${ALGS_QX2} Q_flat_bmt"
+ALGS_QX2="${ALGS_QX2} Q_dedup_bmt"
+ALGS_QX2="${ALGS_QX2} Q_err_bmt"
 ALGS_QX2="${ALGS_QX2} Q_opt_bmt"
 ALGS_QX2="${ALGS_QX2} Q_layered_bmt"
 ALGS_QX2="${ALGS_QX2} Q_ibm"
@@ -31,12 +34,16 @@ ALGS_QX3="${ALGS_QX3} Q_bmt"
 ALGS_QX3="${ALGS_QX3} Q_simplified_bmt"
 ALGS_QX3="${ALGS_QX3} Q_ibmt"
 ALGS_QX3="${ALGS_QX3} Q_simplified_ibmt"
+ALGS_QX3="${ALGS_QX3} Q_flat_bmt"
+ALGS_QX3="${ALGS_QX3} Q_dedup_bmt"
+ALGS_QX3="${ALGS_QX3} Q_err_bmt"
 ALGS_QX3="${ALGS_QX3} Q_opt_bmt"
-ALGS_QX2="${ALGS_QX3} Q_layered_bmt"
+ALGS_QX3="${ALGS_QX3} Q_layered_bmt"
 ALGS_QX3="${ALGS_QX3} Q_grdy"
 ALGS_QX3="${ALGS_QX3} Q_ibm"
 ALGS_QX3="${ALGS_QX3} Q_wpm"
 ALGS_QX3="${ALGS_QX3} Q_random"
+ALGS_QX3="${ALGS_QX3} Q_jku"
 ALGS_QX3="${ALGS_QX3} Q_sabre"
 ALGS_QX3="${ALGS_QX3} Q_chw"
 
@@ -2,11 +2,21 @@
 #define __EFD_DRIVER_H__
 
 #include "enfield/Analysis/Nodes.h"
+#include "enfield/Support/Stats.h"
 
 #include <iostream>
 #include <string>
+#include <vector>
 
 namespace efd {
+    /// \brief Number of bytes parsed by \em ParseFile (including the files
+    /// they include, and the standard library).
+    extern Stat<uint64_t> ParsedBytes;
+
+    /// \brief Holds the state of a single parse.
+    ///
+    /// Nothing else is shared among parses (each file has its own reentrant
+    /// scanner), so that different threads may parse at the same time.
     struct ASTWrapper {
         // The parser input
         std::string mFile;
@@ -16,12 +26,25 @@ namespace efd {
         Node::Ref mAST;
         // Has parsed standard library
         bool mStdLibParsed;
+
+        // Where to look for the included files (besides \em mPath). It is
+        // read from the `-I` option once, when the parse starts.
+        std::vector<std::string> mIncludePath;
+
+        // Number of bytes of the included files (and of the standard library)
+        // parsed along with this one.
+        uint64_t mIncludedBytes;
     };
 
     /// \brief Parse \p filename at \p path.
+    ///
+    /// The file is mapped into memory, and scanned in place (`yy_scan_buffer`).
+    /// The text of the tokens is only copied into the nodes built from them.
+    ///
+    /// It is safe to call it (and \em ParseString) from many threads at once.
     Node::uRef ParseFile(std::string filename, std::string path = "./", bool forceStdLib = true);
     /// \brief Parse the string \p program.
-    Node::uRef ParseString(std::string program, bool forceStdLib = true);
+    Node::uRef ParseString(const std::string& program, bool forceStdLib = true);
 };
 
 #endif
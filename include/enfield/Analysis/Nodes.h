@@ -2,7 +2,10 @@
 #define __EFD_NODES_H__
 
 #include "enfield/Support/WrapperVal.h"
+#include "enfield/Support/StringInterner.h"
+#include "enfield/Support/Arena.h"
 #include "enfield/Support/RTTI.h"
+#include "enfield/Support/Defs.h"
 
 #include <initializer_list>
 #include <iostream>
@@ -42,8 +45,9 @@ namespace efd {
             typedef std::unique_ptr<Node> uRef;
             typedef std::shared_ptr<Node> sRef;
 
-            typedef std::vector<uRef>::iterator Iterator;
-            typedef std::vector<uRef>::const_iterator ConstIterator;
+            typedef std::vector<uRef, ArenaAllocator<uRef>> ChildVector;
+            typedef ChildVector::iterator Iterator;
+            typedef ChildVector::const_iterator ConstIterator;
 
             enum Kind {
                 K_QASM_VERSION,
@@ -80,7 +84,7 @@ namespace efd {
             /// \brief True if it is a node inside an include node.
             bool mInInclude;
             /// \brief The childrem nodes.
-            std::vector<uRef> mChild;
+            ChildVector mChild;
             Ref mParent;
 
             /// \brief Constructs the node, initially empty (with no information).
@@ -99,6 +103,11 @@ namespace efd {
         public:
             virtual ~Node();
 
+            /// \brief Nodes (and their children vectors) are allocated from the
+            /// \em Arena in scope, if any.
+            static void* operator new(std::size_t size);
+            static void operator delete(void* ptr, std::size_t size);
+
             /// \brief Gets the i-th child.
             Ref getChild(uint32_t i) const;
             /// \brief Sets the i-th child.
@@ -168,16 +177,22 @@ namespace efd {
 
             protected:
                 T mVal;
+                /// \brief Interned symbol of the value (only for string values).
+                StringInterner::Symbol mSymbol;
 
                 NDValue(T val);
+                NDValue(T val, StringInterner::Symbol sym);
                 bool equalsImpl(Node::Ref ref) const override;
                 Node::uRef cloneImpl() const override;
 
             public:
                 typedef std::shared_ptr< NDValue<T> > NDRef;
 
-                /// \brief Returns a copy to the setted value.
-                T getVal() const;
+                /// \brief Returns a reference to the setted value.
+                const T& getVal() const;
+                /// \brief Returns the interned symbol of the value (only for
+                /// string values).
+                StringInterner::Symbol getSymbol() const;
 
                 std::string getOperation() const override;
                 std::string toString(bool pretty = false) const override;
@@ -204,6 +219,9 @@ namespace efd {
 
     template class NDValue<std::string>;
     template <> NDValue<std::string>::NDValue(std::string val);
+    template <> NDValue<std::string>::NDValue(std::string val, StringInterner::Symbol sym);
+    template <> Node::uRef NDValue<std::string>::cloneImpl() const;
+    template <> StringInterner::Symbol NDValue<std::string>::getSymbol() const;
     template <> bool NDValue<std::string>::ClassOf(const Node* node);
     template <> std::string NDValue<std::string>::getOperation() const;
     template <> std::string NDValue<std::string>::toString(bool pretty) const;
@@ -290,6 +308,37 @@ namespace efd {
             static std::unique_ptr<NDRegDecl> CreateC(NDId::uRef idNode, NDInt::uRef sizeNode);
     };
 
+    /// \brief Integer that identifies a bit reference, i.e.: the interned symbol
+    /// of its register in the upper half and its position in the lower one.
+    ///
+    /// Ids that are not indexed (e.g.: the arguments of a gate declaration) use
+    /// \em XbitKeyNoIndex as position.
+    typedef uint64_t XbitKey;
+
+    static const uint32_t XbitKeyNoIndex = 0xFFFFFFFF;
+
+    /// \brief Builds the key of the (not indexed) id \p sym.
+    inline XbitKey MakeXbitKey(StringInterner::Symbol sym) {
+        return (static_cast<XbitKey>(sym) << 32) | XbitKeyNoIndex;
+    }
+
+    /// \brief Builds the key of the bit \p index of register \p sym.
+    ///
+    /// \p index must be lower than \em XbitKeyNoIndex, otherwise it would
+    /// either be truncated or collide with the key of the id itself.
+    inline XbitKey MakeXbitKey(StringInterner::Symbol sym, uint64_t index) {
+        EfdAbortIf(index >= XbitKeyNoIndex,
+                   "Bit index too big (max `" << XbitKeyNoIndex - 1 << "`): `" << index << "`.");
+        return (static_cast<XbitKey>(sym) << 32) | index;
+    }
+
+    /// \brief Returns the key of \p node, which must be either an \em NDIdRef
+    /// or an \em NDId.
+    XbitKey GetXbitKey(Node::Ref node);
+    /// \brief Returns the key of the bit whose string representation is \p id,
+    /// e.g.: "q[3]" or "a".
+    XbitKey GetXbitKey(const std::string& id);
+
     /// \brief Node for id references (register specific positions).
     class NDIdRef : public Node {
         public:
@@ -302,9 +351,16 @@ namespace efd {
                 I_N
             };
 
+            /// \brief Cached key of the (register, index) pair, kept in
+            /// sync with the children by \em setId and \em setN.
+            XbitKey mKey;
+
             NDIdRef(NDId::uRef idNode, NDInt::uRef nNode);
             Node::uRef cloneImpl() const override;
 
+            /// \brief Recomputes \em mKey from the children.
+            void updateKey();
+
         public:
             /// \brief Gets the id.
             NDId::Ref getId() const;
@@ -315,6 +371,13 @@ namespace efd {
             /// \brief Sets an integer representing the position.
             void setN(NDInt::uRef ref);
 
+            /// \brief Gets the interned symbol of the register id.
+            StringInterner::Symbol getIdSymbol() const;
+            /// \brief Gets the position, as an integer.
+            uint32_t getIndex() const;
+            /// \brief Gets the key that identifies the referenced bit.
+            XbitKey getKey() const;
+
             std::string toString(bool pretty = false) const override;
 
             uint32_t getChildNumber() const override;
@@ -1020,7 +1083,7 @@ bool efd::NDValue<T>::equalsImpl(Node::Ref ref) const {
 }
 
 template <typename T>
-T efd::NDValue<T>::getVal() const {
+const T& efd::NDValue<T>::getVal() const {
     return mVal;
 }
 
@@ -1053,7 +1116,7 @@ bool efd::NDValue<T>::ClassOf(const Node* node) {
 
 template <typename T>
 typename efd::NDValue<T>::uRef efd::NDValue<T>::Create(T val) {
-    return uRef(new NDValue<T>(val));
+    return uRef(new NDValue<T>(std::move(val)));
 }
 
 #endif
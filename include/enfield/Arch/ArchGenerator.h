@@ -0,0 +1,47 @@
+#ifndef __EFD_ARCH_GENERATOR_H__
+#define __EFD_ARCH_GENERATOR_H__
+
+#include "enfield/Arch/ArchGraph.h"
+#include "enfield/Support/CommandLine.h"
+
+#include <functional>
+
+namespace efd {
+    extern Opt<double> ArchMaxError;
+    extern Opt<uint32_t> ArchErrorSeed;
+
+    /// \brief Builds the coupling graph of a family of architectures, given
+    /// its dimensions (e.g.: the number of rows and columns of a grid).
+    ///
+    /// It should put every coupling in both directions, with weight 1, and
+    /// leave the graph unfrozen.
+    typedef std::function<ArchGraph::uRef(const std::vector<uint32_t>&)> ArchGeneratorFn;
+
+    /// \brief Returns true if \p name is the name of a parametric architecture,
+    /// i.e.: `<kind>-<dims>`, where `<kind>` is a registered generator and
+    /// `<dims>` its dimensions separated by `x` (e.g.: `grid-32x32`).
+    ///
+    /// The built-in generators are:
+    ///     - `grid-RxC`: R rows of C qubits, coupled to their 4 neighbours.
+    ///     - `heavyhex-RxC`: R rows of 4C+3 qubits, with C+1 bridge qubits
+    ///     between consecutive rows, forming C heavy hexagons per row pair
+    ///     (e.g.: `heavyhex-7x3` is IBM's 127-qubit layout, plus the two dangling
+    ///     qubits it does not have).
+    ///     - `ring-N`: N qubits in a cycle.
+    ///     - `tree-N` and `tree-NxK`: N qubits in a complete K-ary tree (binary,
+    ///     by default), numbered in breadth-first order.
+    ///     - `alltoall-N`: N fully connected qubits.
+    bool IsParametricArchitecture(const std::string& name);
+    /// \brief Creates the parametric architecture \p name, with a single
+    /// register `q` (see \em IsParametricArchitecture).
+    ///
+    /// If the option `-arch-max-error` is set, each coupling gets a random
+    /// probability of error, uniformly distributed in [0, max error).
+    ArchGraph::uRef CreateParametricArchitecture(const std::string& name);
+    /// \brief Registers \p fn as the generator of the architectures named
+    /// `<kind>-<dims>`, which have between \p minDims and \p maxDims dimensions.
+    void RegisterArchGenerator(const std::string& kind, uint32_t minDims, uint32_t maxDims,
+                               ArchGeneratorFn fn);
+}
+
+#endif
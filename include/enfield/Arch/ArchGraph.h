@@ -22,6 +22,7 @@ namespace efd {
 
             std::vector<std::string> mId; 
             std::unordered_map<std::string, uint32_t> mStrToId;
+            std::unordered_map<XbitKey, uint32_t> mKeyToId;
 
             bool mGeneric;
             uint32_t mVID;
@@ -46,6 +47,12 @@ namespace efd {
             /// \brief Returns true if this architecture has a vertex whose string
             /// representation is \p s.
             bool hasSId(std::string s) const;
+            /// \brief Returns the uint32_t id of the vertex referenced by \p node
+            /// (either an \em NDIdRef or an \em NDId), without building strings.
+            uint32_t getUId(Node::Ref node) const;
+            /// \brief Returns true if this architecture has the vertex referenced
+            /// by \p node.
+            bool hasNode(Node::Ref node) const;
             /// \brief Returns the std::string id of the vertex whose uid is \p i.
             std::string getSId(uint32_t i);
 
@@ -59,6 +66,10 @@ namespace efd {
             /// \brief The end iterator for the \p mRegs.
             RegsIterator reg_end();
 
+            /// \brief Returns the json representation of this architecture, in the
+            /// format read by \em JsonBackendParser (without the distance table).
+            Json::Value toJson();
+
             /// \brief Returns true if \p g is of this type.
             static bool ClassOf(const Graph* g);
 
@@ -75,11 +86,23 @@ namespace efd {
         static const std::string _WeightLabel_;
         static const std::string _RegLabel_;
         static const std::string _IdLabel_;
+        static const std::string _DistancesLabel_;
     };
 
+    /// \brief Parses an architecture graph.
+    ///
+    /// If it has a `distances` object, it is loaded as the graph's distance table,
+    /// either inline (see \em DistanceTable::toJson) or, if it has a `file`
+    /// field, memory-mapped from that binary file (see \em DistanceTable::writeBinary).
+    /// A relative `file` is relative to \p dir (the current directory, if empty).
     template <> struct JsonBackendParser<ArchGraph> {
-        static std::unique_ptr<ArchGraph> Parse(const Json::Value& root);
+        static std::unique_ptr<ArchGraph> Parse(const Json::Value& root,
+                                                const std::string& dir = "");
     };
+
+    /// \brief Parses the architecture json file \p filename, whose distance table
+    /// file (if any) is relative to the directory of \p filename.
+    template <> std::unique_ptr<ArchGraph> JsonParser<ArchGraph>::ParseFile(std::string filename);
 }
 
 #endif
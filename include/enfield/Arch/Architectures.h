@@ -29,6 +29,12 @@ namespace efd {
     void RegisterArchitecture(EnumArchitecture key, ArchRegistry::CtorTy ctor);
     /// \brief Creates an architecture referenced by \p name.
     ArchRegistry::RetTy CreateArchitecture(EnumArchitecture key);
+
+    /// \brief Returns true if \p name is either a registered architecture
+    /// (e.g.: `A_ibmqx2`) or a parametric one (e.g.: `grid-8x8`).
+    bool IsArchitectureName(const std::string& name);
+    /// \brief Creates the architecture named \p name (see \em IsArchitectureName).
+    ArchGraph::uRef CreateArchitectureFromName(const std::string& name);
 }
 
 #endif
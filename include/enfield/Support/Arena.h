@@ -0,0 +1,131 @@
+#ifndef __EFD_ARENA_H__
+#define __EFD_ARENA_H__
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace efd {
+    /// \brief Bump allocator whose memory is released all at once.
+    ///
+    /// Memory is only taken from an arena while one of its \em Scope objects
+    /// is alive in the current thread. Otherwise (or for big blocks), \em Allocate
+    /// falls back to the heap. Either way, every block records where it came from, so that
+    /// \em Deallocate may be called on any of them.
+    ///
+    /// Blocks deallocated while their arena is in scope are kept, by size, and
+    /// handed out again by \em Allocate. Other blocks are not reused: the arena
+    /// just counts its live blocks, and frees all of its chunks when both the
+    /// last block and the last \em sRef to it are gone. So, blocks may safely
+    /// outlive the object that owns the arena, but a single one of them keeps
+    /// every chunk alive. Released chunks are kept (up to `-arena-cache`) for
+    /// reuse by new arenas.
+    ///
+    /// Threads: an arena may be in scope in only one thread at a time (this is
+    /// checked by \em Scope). That thread is the only one that allocates from
+    /// it, so allocating takes no lock. Blocks may be deallocated from any
+    /// thread, though only the ones deallocated in that thread are reused.
+    class Arena {
+        public:
+            typedef Arena* Ref;
+            typedef std::shared_ptr<Arena> sRef;
+
+            /// \brief Makes \p arena the one used by \em Allocate in the
+            /// current thread, until it goes out of scope.
+            ///
+            /// The scope holds a reference to \p arena, which may be nullptr
+            /// (i.e.: the heap).
+            class Scope {
+                private:
+                    sRef mArena;
+                    Arena::Ref mPrevious;
+
+                public:
+                    Scope(const sRef& arena);
+                    ~Scope();
+
+                    Scope(const Scope&) = delete;
+                    Scope& operator=(const Scope&) = delete;
+            };
+
+        private:
+            /// \brief Live blocks plus one for all the \em sRef.
+            std::atomic<uint64_t> mRefs;
+            /// \brief The chunks, with their sizes.
+            std::vector<std::pair<char*, uint64_t>> mChunks;
+            char* mCur;
+            char* mEnd;
+            uint64_t mNextChunkSize;
+            uint64_t mChunksSize;
+
+            /// \brief Deallocated blocks, by size (in pointers). Each block
+            /// points to the next one through its header.
+            std::vector<char*> mFree;
+            /// \brief Number of blocks in \em mFree (they are still counted
+            /// as live by \em mRefs).
+            uint64_t mFreeBlocks;
+
+            /// \brief The thread in which this arena is in scope, and how
+            /// many of its scopes are alive there.
+            std::mutex mScopeMutex;
+            std::thread::id mScopeThread;
+            uint32_t mScopes;
+
+            Arena();
+            ~Arena();
+
+            void* allocateImpl(std::size_t size);
+            void deallocateImpl(char* block, std::size_t size);
+            void release();
+            /// \brief Releases the reference shared by all \em sRef.
+            void releaseRoot();
+
+        public:
+            /// \brief Returns the number of bytes taken by the chunks of this arena.
+            uint64_t getChunksSize() const;
+            /// \brief Returns the number of blocks of this arena that were not
+            /// deallocated yet. It must not be in scope in another thread.
+            uint64_t getLiveBlocks() const;
+
+            /// \brief Allocates \p size bytes, either from the arena in
+            /// scope (if any) or from the heap.
+            static void* Allocate(std::size_t size);
+            /// \brief Deallocates a block of \p size bytes returned by
+            /// \em Allocate.
+            static void Deallocate(void* ptr, std::size_t size);
+
+            /// \brief Creates a new arena.
+            static sRef Create();
+    };
+
+    /// \brief Standard allocator that uses \em Arena::Allocate.
+    template <typename T>
+        struct ArenaAllocator {
+            static_assert(alignof(T) <= sizeof(void*),
+                          "Arena blocks are only aligned as pointers.");
+
+            typedef T value_type;
+
+            ArenaAllocator() {}
+            template <typename U> ArenaAllocator(const ArenaAllocator<U>&) {}
+
+            T* allocate(std::size_t n) {
+                return static_cast<T*>(Arena::Allocate(n * sizeof(T)));
+            }
+
+            void deallocate(T* ptr, std::size_t n) {
+                Arena::Deallocate(ptr, n * sizeof(T));
+            }
+        };
+
+    template <typename T, typename U>
+        bool operator==(const ArenaAllocator<T>&, const ArenaAllocator<U>&) { return true; }
+    template <typename T, typename U>
+        bool operator!=(const ArenaAllocator<T>&, const ArenaAllocator<U>&) { return false; }
+}
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef __EFD_BIT_PARALLEL_BFS_DISTANCE_H__
+#define __EFD_BIT_PARALLEL_BFS_DISTANCE_H__
+
+#include "enfield/Support/DistanceGetter.h"
+
+namespace efd {
+    /// \brief Calculates all the distances at once, with a multi-source BFS that
+    /// runs 64 sources at a time.
+    ///
+    /// Every vertex has one 64-bit word per set (seen, frontier and next),
+    /// where bit `b` belongs to the `b`-th source of the batch. A BFS level
+    /// OR-s the frontier of each active vertex into its neighbours, which
+    /// advances the 64 searches together. Edges are taken in both directions.
+    ///
+    /// Everything is computed by \em init (batches may run on several
+    /// threads), so \em get is a table lookup and is safe to call concurrently.
+    class BitParallelBFSDistance : public DistanceGetter<uint32_t> {
+        public:
+            typedef BitParallelBFSDistance* Ref;
+            typedef std::shared_ptr<BitParallelBFSDistance> sRef;
+            typedef std::unique_ptr<BitParallelBFSDistance> uRef;
+
+        private:
+            uint32_t mThreads;
+            uint32_t mN;
+            std::vector<uint32_t> mDist;
+
+            std::vector<uint32_t> mAdjBegin;
+            std::vector<uint32_t> mAdjList;
+            /// \brief The sources of the batch `i` are in [64 * i, 64 * (i + 1)).
+            std::vector<uint32_t> mSources;
+
+            struct Words {
+                std::vector<uint64_t> mSeen;
+                std::vector<uint64_t> mFrontier;
+                std::vector<uint64_t> mNext;
+                /// \brief Vertices with a non-empty frontier.
+                std::vector<uint32_t> mActive;
+                /// \brief Vertices with a non-empty \em mNext.
+                std::vector<uint32_t> mTouched;
+            };
+
+            /// \brief Splits the vertices in batches of nearby sources.
+            void groupSources();
+            /// \brief Fills the rows of the sources of the batch \p batch.
+            void searchBatch(uint32_t batch, Words& words);
+
+            BitParallelBFSDistance(uint32_t nThreads);
+
+        protected:
+            void initImpl() override;
+            uint32_t getImpl(uint32_t u, uint32_t v) override;
+
+        public:
+            /// \brief Returns the distances from \p u to every vertex.
+            const uint32_t* row(uint32_t u) const;
+
+            /// \brief Instantiate one object of this type, that uses \p nThreads
+            /// threads (0 means all hardware threads) for computing the distances.
+            static uRef Create(uint32_t nThreads = 1);
+    };
+}
+
+#endif
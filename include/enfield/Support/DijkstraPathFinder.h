@@ -6,12 +6,17 @@
 #include "enfield/Support/RTTI.h"
 #include "enfield/Support/Defs.h"
 
-#include <queue>
+#include <algorithm>
+#include <functional>
 #include <limits>
+#include <queue>
 
 namespace efd {
     /// \brief Dijkstra algorithm for finding a swap sequence in a
     /// weighted graph.
+    ///
+    /// It finds the path that minimizes the sum of the weights of its edges,
+    /// taken in both directions (the cheapest, if both exist).
     template <typename T>
     class DijkstraPathFinder : public PathFinder {
         public:
@@ -20,7 +25,6 @@ namespace efd {
 
         private:
             DijkstraPathFinder();
-            inline bool equal(T l, T r);
 
         public:
             std::vector<uint32_t> find(Graph::Ref g, uint32_t u, uint32_t v) override;
@@ -28,9 +32,6 @@ namespace efd {
             /// \brief Create an instance of this class.
             static uRef Create();
     };
-
-    template <> bool DijkstraPathFinder<uint32_t>::equal(uint32_t l, uint32_t r);
-    template <> bool DijkstraPathFinder<double>::equal(double l, double r);
 }
 
 template <typename T>
@@ -39,6 +40,8 @@ efd::DijkstraPathFinder<T>::DijkstraPathFinder() {}
 template <typename T>
 std::vector<uint32_t>
 efd::DijkstraPathFinder<T>::find(Graph::Ref g, uint32_t u, uint32_t v) {
+    typedef std::pair<T, uint32_t> QueueItem;
+
     auto wg = dynCast<WeightedGraph<T>>(g);
     EfdAbortIf(wg == nullptr, "Invalid weighted graph for this Dijkstra implementation.");
 
@@ -46,58 +49,49 @@ efd::DijkstraPathFinder<T>::find(Graph::Ref g, uint32_t u, uint32_t v) {
     uint32_t from = u;
     uint32_t to = v;
 
-    uint32_t inf = std::numeric_limits<uint32_t>::max();
-    uint32_t infw = std::numeric_limits<T>::max();
+    T inf = std::numeric_limits<T>::max();
 
-    std::vector<T> dist(inf, size);
-    std::vector<uint32_t> parent(inf, size);
-    std::vector<bool> visited(inf, false);
-    std::priority_queue<std::pair<T, uint32_t>> q;
+    std::vector<T> dist(size, inf);
+    std::vector<uint32_t> parent(size, _undef);
+    std::vector<bool> visited(size, false);
+    std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> q;
 
     // Dijkstra Algorithm
     dist[from] = 0;
     q.push(std::make_pair(0, from));
     while (!q.empty()) {
-        uint32_t u = q.front().second;
+        uint32_t u = q.top().second;
         q.pop();
 
         if (visited[u]) continue;
         visited[u] = true;
+        if (u == to) break;
 
-        for (auto v : wg->succ(u)) {
-            T newW = dist[u];
+        auto relax = [&](uint32_t v, T w) {
+            T newW = dist[u] + w;
             if (newW < dist[v]) {
+                dist[v] = newW;
                 parent[v] = u;
                 q.push(std::make_pair(newW, v));
             }
-        }
+        };
+
+        for (auto v : wg->succ(u)) relax(v, wg->getW(u, v));
+        for (auto v : wg->pred(u)) relax(v, wg->getW(v, u));
     }
 
     // Reconstructing the path
-    EfdAbortIf(equal(dist[to], infw), "No existing path in this graph.");
+    EfdAbortIf(!visited[to], "No existing path in this graph.");
     std::vector<uint32_t> path;
 
-    // If the path is "from -> x -> y -> to", the swap vector will contain
-    // "(y, to), (x, y)" in this order. In other words, "to" will go to "x".
-    while ((u = parent[v]) != from) {
-        path.push_back(v);
-        v = u;
+    for (uint32_t x = to; x != _undef; x = parent[x]) {
+        path.push_back(x);
     }
-    path.push_back(u);
 
+    std::reverse(path.begin(), path.end());
     return path;
 }
 
-template <> bool efd::DijkstraPathFinder<uint32_t>::equal(uint32_t l, uint32_t r) {
-    return l == r;
-}
-
-template <> bool efd::DijkstraPathFinder<double>::equal(double l, double r) {
-    double epsilon = 0.0001;
-    double diff = l - r;
-    return diff >= -epsilon && diff <= epsilon;
-}
-
 template <typename T>
 typename efd::DijkstraPathFinder<T>::uRef
 efd::DijkstraPathFinder<T>::Create() {
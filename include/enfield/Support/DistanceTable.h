@@ -0,0 +1,133 @@
+#ifndef __EFD_DISTANCE_TABLE_H__
+#define __EFD_DISTANCE_TABLE_H__
+
+#include "enfield/Support/Graph.h"
+#include "enfield/Support/CommandLine.h"
+
+namespace efd {
+    /// \brief Skips hashing the matrices of a binary table when loading it
+    /// (`-dist-table-no-verify`).
+    extern Opt<bool> DistTableNoVerify;
+
+    /// \brief Immutable all-pairs distance and next-hop table of a graph.
+    ///
+    /// It is built with one BFS per vertex (ignoring the direction of the edges),
+    /// and stored contiguously: the row of a vertex \p u holds the distances from
+    /// \p u to every vertex. Graphs with at least `-dist-table-bit-bfs-min`
+    /// vertices get their distances from a \em BitParallelBFSDistance instead,
+    /// and the paths are rebuilt from them. It is shared by everyone that uses the same graph
+    /// (see \em Graph::getDistanceTable).
+    ///
+    /// It may also be saved alongside an architecture, either inside its json
+    /// (\em toJson) or as a binary file (\em writeBinary) that is memory-mapped
+    /// when loaded. Both carry a \em checksum of the graph and of the table, so
+    /// that a table is never used with a graph it was not built for. The binary
+    /// file also carries a hash of the graph alone, so that loading it may skip
+    /// reading the whole file (see `-dist-table-no-verify`).
+    class DistanceTable {
+        public:
+            typedef DistanceTable* Ref;
+            typedef std::unique_ptr<DistanceTable> uRef;
+            typedef std::shared_ptr<DistanceTable> sRef;
+
+        private:
+            uint32_t mN;
+            /// \brief Owns the data, unless it was memory-mapped.
+            std::vector<uint32_t> mData;
+            /// \brief Keeps the mapped file (if any) alive.
+            std::shared_ptr<void> mMapping;
+
+            const uint32_t* mDist;
+            /// \brief `mParent[u * mN + v]` is the vertex before `v` in the path
+            /// from `u` to `v` (`_undef` for `u` and for unreachable vertices).
+            const uint32_t* mParent;
+
+            DistanceTable(uint32_t n);
+            DistanceTable(uint32_t n, std::shared_ptr<void> mapping, const uint32_t* data);
+
+            void bfs(Graph::Ref g, uint32_t src);
+            /// \brief Fills the parents of the paths from \p src, given its
+            /// distances.
+            void fillParents(Graph::Ref g, uint32_t src);
+
+            /// \brief Returns a hash of the edges of \p g.
+            static uint64_t GraphHash(Graph::Ref g);
+
+        public:
+            /// \brief Returns the number of vertices.
+            uint32_t size() const;
+
+            /// \brief Returns the distance from \p u to \p v (`_undef` if there
+            /// is no path).
+            uint32_t get(uint32_t u, uint32_t v) const;
+            /// \brief Returns the distances from \p u to every vertex.
+            const uint32_t* row(uint32_t u) const;
+
+            /// \brief Returns the vertex that follows \p u in a shortest path
+            /// from \p u to \p v (`_undef` if \p u is \p v, or there is no path).
+            uint32_t next(uint32_t u, uint32_t v) const;
+
+            /// \brief Returns the vertex that precedes \p v in the shortest path
+            /// from \p u to \p v (`_undef` if \p u is \p v, or there is no path).
+            uint32_t prev(uint32_t u, uint32_t v) const;
+
+            /// \brief Returns the shortest path from \p u to \p v, including both
+            /// (empty if there is none).
+            ///
+            /// It is the same path \em BFSPathFinder finds, unless the table was
+            /// built with the bit-parallel BFS.
+            std::vector<uint32_t> path(uint32_t u, uint32_t v) const;
+
+            /// \brief Returns a checksum of the edges of \p g together with
+            /// the contents of this table.
+            uint64_t checksum(Graph::Ref g) const;
+
+            /// \brief Returns the json representation of this table (built
+            /// for \p g): its checksum, the distance matrix and the next-hop
+            /// matrix, with `-1` for `_undef`.
+            Json::Value toJson(Graph::Ref g) const;
+            /// \brief Returns the json representation of this table (built for
+            /// \p g) that refers to the binary file \p file (see \em writeBinary),
+            /// instead of holding the matrices.
+            Json::Value toJson(Graph::Ref g, const std::string& file) const;
+            /// \brief Writes this table (built for \p g) to the binary file
+            /// \p filename.
+            void writeBinary(Graph::Ref g, const std::string& filename) const;
+
+            /// \brief Builds the table of \p g, using \p nThreads threads
+            /// (0 means all hardware threads).
+            static uRef Create(Graph::Ref g, uint32_t nThreads = 1);
+
+            /// \brief Wraps, without copying, the table of a graph with \p n vertices
+            /// stored in \p data: the distance matrix followed by the parent
+            /// matrix (the layout of \em writeBinary). \p data must outlive it.
+            static uRef CreateView(uint32_t n, const uint32_t* data);
+
+            /// \brief Reads the table of \p g from \p root (see \em toJson).
+            ///
+            /// Returns `nullptr` (with a warning) if the checksum does not
+            /// match, i.e.: the table was not built for \p g.
+            static uRef FromJson(Graph::Ref g, const Json::Value& root);
+            /// \brief Memory-maps the table of \p g from the binary file \p filename
+            /// (see \em writeBinary), and checks \p checksum against its header.
+            /// The matrices are hashed as well, unless `-dist-table-no-verify` is set.
+            ///
+            /// Returns `nullptr` (with a warning) if the file can't be opened, is
+            /// not a table of \p g, or does not match \p checksum.
+            static uRef LoadBinary(Graph::Ref g, const std::string& filename,
+                                   uint64_t checksum);
+
+            /// \brief Reads the checksum field of \p root (aborting if it is not
+            /// a hexadecimal number).
+            static uint64_t ChecksumFromJson(const Json::Value& root);
+    };
+
+    template <> struct JsonFields<DistanceTable> {
+        static const std::string _ChecksumLabel_;
+        static const std::string _DistLabel_;
+        static const std::string _NextLabel_;
+        static const std::string _FileLabel_;
+    };
+}
+
+#endif
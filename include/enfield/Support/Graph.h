@@ -9,6 +9,8 @@
 #include <memory>
 
 namespace efd {
+    class DistanceTable;
+
     /// \brief Graph representation.
     class Graph {
         public:
@@ -24,6 +26,24 @@ namespace efd {
 
             enum Type { Directed, Undirected };
 
+            /// \brief Read-only range of vertices, sorted in ascending order.
+            ///
+            /// It points into the graph, so it is invalidated by \em putEdge.
+            class AdjSpan {
+                private:
+                    const uint32_t* mBegin;
+                    const uint32_t* mEnd;
+
+                public:
+                    AdjSpan(const uint32_t* begin, const uint32_t* end)
+                        : mBegin(begin), mEnd(end) {}
+
+                    const uint32_t* begin() const { return mBegin; }
+                    const uint32_t* end() const { return mEnd; }
+                    uint32_t size() const { return mEnd - mBegin; }
+                    bool empty() const { return mBegin == mEnd; }
+            };
+
         protected:
             Kind mK;
             uint32_t mN;
@@ -31,6 +51,22 @@ namespace efd {
 
             std::vector<std::set<uint32_t>> mSuccessors;
             std::vector<std::set<uint32_t>> mPredecessors;
+            /// \brief Sorted union of successors and predecessors.
+            std::vector<std::vector<uint32_t>> mAdjacent;
+
+            /// \brief Frozen view (see \em freeze), in compressed sparse row form.
+            bool mFrozen;
+            std::vector<uint32_t> mAdjBegin;
+            std::vector<uint32_t> mAdjList;
+            std::vector<uint32_t> mSuccBegin;
+            std::vector<uint32_t> mSuccList;
+            /// \brief Adjacency matrix (of the successors), one bit per pair.
+            /// Empty if the graph is too big.
+            std::vector<uint64_t> mEdgeBits;
+
+            /// \brief Built on first use (see \em getDistanceTable). Only accessed
+            /// through the atomic operations for `shared_ptr`.
+            std::shared_ptr<DistanceTable> mDistTable;
 
             Graph(Kind k, uint32_t n, Type ty = Undirected);
 
@@ -49,17 +85,43 @@ namespace efd {
             uint32_t size() const;
     
             /// \brief Return the set of succesors of some vertex \p i.
-            std::set<uint32_t>& succ(uint32_t i);
+            const std::set<uint32_t>& succ(uint32_t i) const;
             /// \brief Return the set of predecessors of some vertex \p i.
-            std::set<uint32_t>& pred(uint32_t i); 
-            /// \brief Return the set of adjacent vertices of some vertex \p i.
-            std::set<uint32_t> adj(uint32_t i) const;
+            const std::set<uint32_t>& pred(uint32_t i) const;
+            /// \brief Return the adjacent vertices (successors and predecessors)
+            /// of some vertex \p i.
+            AdjSpan adj(uint32_t i) const;
     
             /// \brief Inserts an edge (i, j) in the successor's list and
             /// an edge (j, i) in the predecessor's list.
+            ///
+            /// It discards the frozen view, if any.
             void putEdge(uint32_t i, uint32_t j);
+            /// \brief Removes every successor and predecessor of the vertex \p i.
+            ///
+            /// Only the sets of \p i are cleared: the other end of each edge,
+            /// as well as \em adj, still see it. It discards the frozen view, if any.
+            void clearSuccAndPred(uint32_t i);
             /// \brief Returns true whether it has an edge (i, j).
-            bool hasEdge(uint32_t i, uint32_t j); 
+            ///
+            /// Constant time once the graph is frozen.
+            bool hasEdge(uint32_t i, uint32_t j) const; 
+
+            /// \brief Builds a read-only, contiguous view of the edges, used
+            /// by \em adj and \em hasEdge until the next \em putEdge.
+            void freeze();
+            /// \brief Returns true if the graph has an up-to-date frozen view.
+            bool isFrozen() const;
+
+            /// \brief Returns the all-pairs distance table of this graph.
+            ///
+            /// It is built on the first call (using `-threads` threads), and
+            /// shared by every caller until the next \em putEdge. It is safe to
+            /// call this concurrently.
+            std::shared_ptr<DistanceTable> getDistanceTable();
+            /// \brief Installs a precomputed distance table (e.g.: loaded from
+            /// a file), used instead of building one.
+            void setDistanceTable(std::shared_ptr<DistanceTable> table);
 
             /// \brief Returns true if this is a weighted graph.
             bool isWeighted() const;
@@ -0,0 +1,67 @@
+#ifndef __EFD_MAPPED_FILE_H__
+#define __EFD_MAPPED_FILE_H__
+
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <streambuf>
+#include <string>
+
+namespace efd {
+    /// \brief Stream buffer that reads directly from a memory region.
+    ///
+    /// The region is neither copied nor owned. So, it must outlive the buffer.
+    class MemoryStreamBuf : public std::streambuf {
+        public:
+            MemoryStreamBuf(const char* data, uint64_t size);
+    };
+
+    /// \brief Private view of a whole file, mapped into memory.
+    ///
+    /// Reading it (either through \em data or \em getStream) does not copy
+    /// the file into intermediate buffers. The contents are followed by
+    /// \em Padding zero bytes, and may be written to without changing the
+    /// file, so that a flex scanner may scan them in place (`yy_scan_buffer`).
+    class MappedFile {
+        public:
+            typedef MappedFile* Ref;
+            typedef std::unique_ptr<MappedFile> uRef;
+
+            /// \brief Number of zero bytes after the contents (what
+            /// `yy_scan_buffer` expects).
+            static const uint32_t Padding = 2;
+
+        private:
+            char* mData;
+            uint64_t mSize;
+            uint64_t mMapSize;
+
+            MemoryStreamBuf mBuf;
+            std::istream mStream;
+
+            MappedFile(char* data, uint64_t size, uint64_t mapSize);
+
+        public:
+            ~MappedFile();
+
+            /// \brief Returns the contents of the file.
+            const char* data() const;
+            /// \brief Returns the contents of the file, followed by \em Padding
+            /// zero bytes. Writing to it does not change the file.
+            char* data();
+            /// \brief Returns the size (in bytes) of the file.
+            uint64_t size() const;
+
+            /// \brief Returns a stream that reads the contents of the file.
+            std::istream& getStream();
+
+            /// \brief Maps the file \p path into memory. Returns nullptr (with
+            /// errno set) if it could not be opened.
+            ///
+            /// Files that are not regular (e.g.: pipes) fail with `ENODEV`
+            /// without being opened, so they may still be read some other way.
+            static uRef Open(const std::string& path);
+    };
+}
+
+#endif
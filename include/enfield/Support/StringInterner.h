@@ -0,0 +1,31 @@
+#ifndef __EFD_STRING_INTERNER_H__
+#define __EFD_STRING_INTERNER_H__
+
+#include <cstdint>
+#include <string>
+
+namespace efd {
+    /// \brief Process-wide table of unique strings.
+    ///
+    /// Every distinct string is assigned a symbol (a dense unsigned integer)
+    /// the first time it is interned. Comparing or hashing symbols is a
+    /// lot cheaper than doing so with the strings themselves.
+    ///
+    /// Symbols are never released, and it is safe to use this table from
+    /// multiple threads: interning locks only one of a few shards (picked by
+    /// the hash of the string), and looking a symbol up takes no lock.
+    class StringInterner {
+        public:
+            typedef uint32_t Symbol;
+
+            /// \brief Returns the symbol of \p str, assigning it a new one
+            /// if it was not interned yet.
+            static Symbol Intern(const std::string& str);
+            /// \brief Returns the string represented by \p sym.
+            static const std::string& Get(Symbol sym);
+            /// \brief Returns the number of strings interned so far.
+            static uint32_t Size();
+    };
+}
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef __EFD_THREAD_POOL_H__
+#define __EFD_THREAD_POOL_H__
+
+#include "enfield/Support/CommandLine.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace efd {
+    /// \brief Number of threads used by parallel algorithms (`-threads`).
+    extern Opt<uint32_t> Threads;
+
+    /// \brief Fixed-size pool of worker threads for data-parallel loops.
+    ///
+    /// The thread that calls \em run also works on the loop, as the thread
+    /// with id 0. So, a pool of size 1 has no worker threads at all, and
+    /// executes everything serially in the caller.
+    class ThreadPool {
+        public:
+            typedef ThreadPool* Ref;
+            typedef std::unique_ptr<ThreadPool> uRef;
+
+            /// \brief Body of a parallel loop. It receives the id of the thread
+            /// (in [0, size())) and the index of the iteration.
+            typedef std::function<void(uint32_t, uint32_t)> Task;
+
+        private:
+            std::vector<std::thread> mWorkers;
+
+            std::mutex mMutex;
+            std::condition_variable mStartCV;
+            std::condition_variable mDoneCV;
+
+            const Task* mTask;
+            uint32_t mN;
+            uint32_t mActive;
+            uint64_t mGeneration;
+            bool mStop;
+
+            std::atomic<uint32_t> mNext;
+
+            ThreadPool(uint32_t nThreads);
+
+            void workOn(uint32_t tid);
+            void workerLoop(uint32_t tid);
+
+        public:
+            ~ThreadPool();
+
+            /// \brief Returns the number of threads that execute the tasks,
+            /// including the caller.
+            uint32_t size() const;
+
+            /// \brief Executes \p task for every index in [0, \p n), and returns
+            /// only when all of them have finished.
+            ///
+            /// Indexes are handed out dynamically, so \p task must not rely on
+            /// the order in which they are executed.
+            void run(uint32_t n, const Task& task);
+
+            /// \brief Creates a pool with \p nThreads threads. If \p nThreads
+            /// is 0, uses the number of hardware threads available.
+            static uRef Create(uint32_t nThreads);
+    };
+}
+
+#endif
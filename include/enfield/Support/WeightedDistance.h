@@ -0,0 +1,286 @@
+#ifndef __EFD_WEIGHTED_DISTANCE_H__
+#define __EFD_WEIGHTED_DISTANCE_H__
+
+#include "enfield/Support/DistanceGetter.h"
+#include "enfield/Support/WeightedGraph.h"
+#include "enfield/Support/RTTI.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+
+namespace efd {
+    /// \brief All-pairs shortest paths on the weights of a graph.
+    ///
+    /// Edges are taken in both directions. The cost of going through the edge
+    /// (u, v) is given by an \em EdgeCostFn, which receives the weight of the
+    /// edge (or 1, if it is not a \em WeightedGraph<T>). If both (u, v) and (v, u)
+    /// exist, the cheapest one is used. Costs must not be negative.
+    ///
+    /// Everything is computed by \em init, so \em get is a table lookup and is
+    /// safe to call concurrently. There are two algorithms:
+    ///     - \em M_Dijkstra: one binary-heap Dijkstra per vertex. O(n m log(n)).
+    ///     - \em M_FloydWarshall: blocked Floyd-Warshall, whose inner loops are
+    ///     contiguous and branch-free, so that the compiler vectorizes them. O(n^3).
+    /// \em M_Auto chooses the Floyd-Warshall for dense graphs.
+    template <typename T>
+        class WeightedDistance : public DistanceGetter<T> {
+            public:
+                typedef WeightedDistance* Ref;
+                typedef std::unique_ptr<WeightedDistance> uRef;
+                typedef std::shared_ptr<WeightedDistance> sRef;
+
+                typedef std::function<T(uint32_t, uint32_t, T)> EdgeCostFn;
+
+                enum Method { M_Auto, M_Dijkstra, M_FloydWarshall };
+
+            private:
+                /// \brief Side of the square blocks of the Floyd-Warshall.
+                static const uint32_t _Block_ = 32;
+
+                Method mMethod;
+                EdgeCostFn mCost;
+
+                uint32_t mN;
+                std::vector<T> mDist;
+                /// \brief `mParent[u * mN + v]` is the vertex before `v` in the
+                /// path from `u` to `v`.
+                std::vector<uint32_t> mParent;
+
+                /// \brief Cheapest edge of each vertex to each of its neighbours,
+                /// with the same layout as \em Graph::adj.
+                std::vector<uint32_t> mAdjBegin;
+                std::vector<uint32_t> mAdjTo;
+                std::vector<T> mAdjCost;
+
+                void buildAdjacency();
+                void dijkstra(uint32_t src);
+                void floydWarshall();
+                void relaxBlock(uint32_t ib, uint32_t jb, uint32_t kb);
+
+                WeightedDistance(Method method, EdgeCostFn cost);
+
+            protected:
+                void initImpl() override;
+                T getImpl(uint32_t u, uint32_t v) override;
+
+            public:
+                /// \brief Returns the vertex that precedes \p v in the shortest path
+                /// from \p u to \p v (`_undef` if \p u is \p v, or there is no path).
+                uint32_t prev(uint32_t u, uint32_t v) const;
+                /// \brief Returns the shortest path from \p u to \p v, including both
+                /// (empty if there is none).
+                std::vector<uint32_t> path(uint32_t u, uint32_t v) const;
+
+                /// \brief The distance between unconnected vertices.
+                static T Inf();
+
+                /// \brief Creates an instance that uses \p method, with the
+                /// costs given by \p cost (by default, the weights themselves).
+                static uRef Create(Method method = M_Auto, EdgeCostFn cost = nullptr);
+        };
+}
+
+template <typename T>
+efd::WeightedDistance<T>::WeightedDistance(Method method, EdgeCostFn cost)
+    : DistanceGetter<T>(), mMethod(method), mCost(cost), mN(0) {
+    if (!mCost) mCost = [](uint32_t u, uint32_t v, T w) { return w; };
+}
+
+template <typename T>
+T efd::WeightedDistance<T>::Inf() {
+    // Half of the maximum, so that `Inf() + Inf()` does not overflow in the
+    // Floyd-Warshall inner loop.
+    return std::numeric_limits<T>::max() / 2;
+}
+
+template <typename T>
+void efd::WeightedDistance<T>::buildAdjacency() {
+    auto g = this->mG;
+    auto wg = dynCast<WeightedGraph<T>>(g);
+
+    mAdjBegin.assign(1, 0);
+    mAdjTo.clear();
+    mAdjCost.clear();
+
+    for (uint32_t u = 0; u < mN; ++u) {
+        for (uint32_t v : g->adj(u)) {
+            T cost = Inf();
+
+            if (g->hasEdge(u, v)) {
+                cost = std::min(cost, mCost(u, v, wg != nullptr ? wg->getW(u, v) : 1));
+            }
+
+            if (g->hasEdge(v, u)) {
+                cost = std::min(cost, mCost(v, u, wg != nullptr ? wg->getW(v, u) : 1));
+            }
+
+            EfdAbortIf(cost < 0, "Negative edge cost `" << cost << "` for `(" << u
+                       << ", " << v << ")`.");
+            mAdjTo.push_back(v);
+            mAdjCost.push_back(cost);
+        }
+
+        mAdjBegin.push_back(mAdjTo.size());
+    }
+}
+
+template <typename T>
+void efd::WeightedDistance<T>::dijkstra(uint32_t src) {
+    typedef std::pair<T, uint32_t> QueueItem;
+
+    T* dist = &mDist[(uint64_t) src * mN];
+    uint32_t* parent = &mParent[(uint64_t) src * mN];
+
+    std::vector<bool> done(mN, false);
+    std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> q;
+
+    dist[src] = 0;
+    q.push(std::make_pair(0, src));
+
+    while (!q.empty()) {
+        uint32_t u = q.top().second;
+        q.pop();
+
+        // Stale entry of an already improved vertex.
+        if (done[u]) continue;
+        done[u] = true;
+
+        for (uint32_t i = mAdjBegin[u], e = mAdjBegin[u + 1]; i < e; ++i) {
+            uint32_t v = mAdjTo[i];
+            T newDist = dist[u] + mAdjCost[i];
+
+            if (newDist < dist[v]) {
+                dist[v] = newDist;
+                parent[v] = u;
+                q.push(std::make_pair(newDist, v));
+            }
+        }
+    }
+}
+
+template <typename T>
+void efd::WeightedDistance<T>::relaxBlock(uint32_t ib, uint32_t jb, uint32_t kb) {
+    uint32_t iEnd = std::min(ib + _Block_, mN);
+    uint32_t jEnd = std::min(jb + _Block_, mN);
+    uint32_t kEnd = std::min(kb + _Block_, mN);
+
+    for (uint32_t k = kb; k < kEnd; ++k) {
+        const T* dk = &mDist[(uint64_t) k * mN];
+        const uint32_t* pk = &mParent[(uint64_t) k * mN];
+
+        for (uint32_t i = ib; i < iEnd; ++i) {
+            T* di = &mDist[(uint64_t) i * mN];
+            uint32_t* pi = &mParent[(uint64_t) i * mN];
+            T dik = di[k];
+
+            for (uint32_t j = jb; j < jEnd; ++j) {
+                T through = dik + dk[j];
+                bool better = through < di[j];
+                di[j] = better ? through : di[j];
+                pi[j] = better ? pk[j] : pi[j];
+            }
+        }
+    }
+}
+
+template <typename T>
+void efd::WeightedDistance<T>::floydWarshall() {
+    for (uint32_t u = 0; u < mN; ++u) {
+        mDist[(uint64_t) u * mN + u] = 0;
+
+        for (uint32_t i = mAdjBegin[u], e = mAdjBegin[u + 1]; i < e; ++i) {
+            mDist[(uint64_t) u * mN + mAdjTo[i]] = mAdjCost[i];
+            mParent[(uint64_t) u * mN + mAdjTo[i]] = u;
+        }
+    }
+
+    // For each diagonal block `k`: first the block itself, then the blocks in
+    // its row and column (which only depend on it), and then all the others.
+    for (uint32_t kb = 0; kb < mN; kb += _Block_) {
+        relaxBlock(kb, kb, kb);
+
+        for (uint32_t b = 0; b < mN; b += _Block_) {
+            if (b == kb) continue;
+            relaxBlock(kb, b, kb);
+            relaxBlock(b, kb, kb);
+        }
+
+        for (uint32_t ib = 0; ib < mN; ib += _Block_) {
+            if (ib == kb) continue;
+
+            for (uint32_t jb = 0; jb < mN; jb += _Block_) {
+                if (jb == kb) continue;
+                relaxBlock(ib, jb, kb);
+            }
+        }
+    }
+
+    // Unreachable pairs may have been "improved" to something above `Inf()`.
+    for (uint64_t i = 0, e = mDist.size(); i < e; ++i) {
+        if (mDist[i] >= Inf()) {
+            mDist[i] = Inf();
+            mParent[i] = _undef;
+        }
+    }
+}
+
+template <typename T>
+void efd::WeightedDistance<T>::initImpl() {
+    mN = this->mG->size();
+    mDist.assign((uint64_t) mN * mN, Inf());
+    mParent.assign((uint64_t) mN * mN, _undef);
+
+    buildAdjacency();
+
+    Method method = mMethod;
+
+    if (method == M_Auto) {
+        // Dijkstra does about `n * m * log(n)` work, against the `n^3` of
+        // the Floyd-Warshall.
+        uint64_t logN = 1;
+        while ((1ull << logN) < mN) ++logN;
+        method = (uint64_t) mAdjTo.size() * logN >= (uint64_t) mN * mN ?
+            M_FloydWarshall : M_Dijkstra;
+    }
+
+    if (method == M_FloydWarshall) {
+        floydWarshall();
+    } else {
+        for (uint32_t u = 0; u < mN; ++u) {
+            dijkstra(u);
+        }
+    }
+}
+
+template <typename T>
+T efd::WeightedDistance<T>::getImpl(uint32_t u, uint32_t v) {
+    return mDist[(uint64_t) u * mN + v];
+}
+
+template <typename T>
+uint32_t efd::WeightedDistance<T>::prev(uint32_t u, uint32_t v) const {
+    return mParent[(uint64_t) u * mN + v];
+}
+
+template <typename T>
+std::vector<uint32_t> efd::WeightedDistance<T>::path(uint32_t u, uint32_t v) const {
+    std::vector<uint32_t> path;
+    if (mDist[(uint64_t) u * mN + v] >= Inf()) return path;
+
+    for (uint32_t x = v; x != _undef; x = prev(u, x)) {
+        path.push_back(x);
+    }
+
+    std::reverse(path.begin(), path.end());
+    return path;
+}
+
+template <typename T>
+typename efd::WeightedDistance<T>::uRef
+efd::WeightedDistance<T>::Create(Method method, EdgeCostFn cost) {
+    return uRef(new WeightedDistance<T>(method, cost));
+}
+
+#endif
@@ -2,6 +2,8 @@
 #define __EFD_DEFAULT_BMT_QALLOCATOR_IMPL_H__
 
 #include "enfield/Transform/Allocators/BoundedMappingTreeQAllocator.h"
+#include "enfield/Support/DistanceTable.h"
+#include "enfield/Support/WeightedDistance.h"
 
 namespace efd {
     /// \brief Sequential generator.
@@ -11,17 +13,18 @@ namespace efd {
     class SeqNCandidatesGenerator : public NodeCandidatesGenerator {
         private:
             Node::Iterator mIt;
+            uint32_t mIndex;
 
         protected:
             void initImpl() override;
             bool finishedImpl() override;
-            std::vector<Node::Ref> generateImpl() override;
+            void generateImpl(std::vector<uint32_t>& candidates) override;
 
         public:
             typedef SeqNCandidatesGenerator* Ref;
             typedef std::unique_ptr<SeqNCandidatesGenerator> uRef;
 
-            void signalProcessed(Node::Ref node) override;
+            void signalProcessed(uint32_t i) override;
 
             static uRef Create();
     };
@@ -32,8 +35,9 @@ namespace efd {
             typedef FirstCandidateSelector* Ref;
             typedef std::unique_ptr<FirstCandidateSelector> uRef;
 
-            bmt::MCandidateVector select(uint32_t maxCandidates,
-                                         const bmt::MCandidateVector& candidates) override;
+            void select(uint32_t maxCandidates,
+                        const bmt::ACandidateVector& candidates,
+                        bmt::Vector& selected) override;
 
             static uRef Create();
     };
@@ -44,8 +48,7 @@ namespace efd {
     /// and the place where it should be.
     class GeoDistanceSwapCEstimator : public SwapCostEstimator {
         private:
-            bmt::Matrix mDist;
-            bmt::Vector distanceFrom(Graph::Ref g, uint32_t u);
+            DistanceTable::sRef mDist;
 
         protected:
             void initImpl() override;
@@ -55,13 +58,38 @@ namespace efd {
             typedef GeoDistanceSwapCEstimator* Ref;
             typedef std::unique_ptr<GeoDistanceSwapCEstimator> uRef;
 
+            SwapCostEstimator::uRef clone() const override;
+
+            static uRef Create();
+    };
+
+    /// \brief The estimation is the sum of all error-aware distances.
+    ///
+    /// Going through an edge whose probability of success is `p` costs
+    /// `1 - w * ln(p)`, where `w` is `-bmt-error-weight`. So, it is the
+    /// same as \em GeoDistanceSwapCEstimator for architectures without
+    /// error rates, and it steers away from noisy edges otherwise.
+    class ErrorGeoDistanceSwapCEstimator : public SwapCostEstimator {
+        private:
+            WeightedDistance<double>::sRef mDist;
+
+        protected:
+            void initImpl() override;
+            uint32_t estimateImpl(const Mapping& fromM, const Mapping& toM) override;
+
+        public:
+            typedef ErrorGeoDistanceSwapCEstimator* Ref;
+            typedef std::unique_ptr<ErrorGeoDistanceSwapCEstimator> uRef;
+
+            SwapCostEstimator::uRef clone() const override;
+
             static uRef Create();
     };
 
     /// \brief Forces \em toM to map all qubits mapped in \em fromM.
     class GeoNearestLQPProcessor : public LiveQubitsPreProcessor {
         private:
-            bmt::Matrix mDist;
+            DistanceTable::sRef mDist;
             uint32_t mPQubits;
             uint32_t mVQubits;
 
@@ -75,6 +103,8 @@ namespace efd {
             typedef GeoNearestLQPProcessor* Ref;
             typedef std::unique_ptr<GeoNearestLQPProcessor> uRef;
 
+            LiveQubitsPreProcessor::uRef clone() const override;
+
             static uRef Create();
     };
 
@@ -3,6 +3,7 @@
 
 #include "enfield/Transform/Allocators/BoundedMappingTreeQAllocator.h"
 #include "enfield/Transform/CircuitGraph.h"
+#include "enfield/Support/DistanceTable.h"
 
 #include <set>
 #include <unordered_map>
@@ -22,10 +23,10 @@ namespace efd {
         private:
             typedef std::set<uint32_t> AdjSet;
             typedef std::vector<AdjSet> AdjList;
-            typedef std::unordered_map<Node::Ref, uint32_t> NodeUIntMap;
-            typedef std::unordered_map<Node::Ref, CircuitGraph::CircuitNode::Ref> NodeCNodeMap;
+            typedef std::unordered_map<uint32_t, uint32_t> NodeUIntMap;
+            typedef std::unordered_map<uint32_t, CircuitGraph::CircuitNode::Ref> NodeCNodeMap;
 
-            CircuitGraph mCGraph;
+            std::shared_ptr<const CircuitGraph> mCGraph;
             CircuitGraph::Iterator mIt;
             NodeCNodeMap mNCNMap;
             NodeUIntMap mReached;
@@ -37,13 +38,13 @@ namespace efd {
         protected:
             void initImpl() override;
             bool finishedImpl() override;
-            std::vector<Node::Ref> generateImpl() override;
+            void generateImpl(std::vector<uint32_t>& candidates) override;
 
         public:
             typedef CircuitCandidatesGenerator* Ref;
             typedef std::unique_ptr<CircuitCandidatesGenerator> uRef;
 
-            void signalProcessed(Node::Ref node) override;
+            void signalProcessed(uint32_t i) override;
 
             static uRef Create();
     };
@@ -72,11 +73,53 @@ namespace efd {
             std::mt19937 mGen;
             std::uniform_real_distribution<double> mDist;
 
+            std::vector<uint32_t> mWeight;
+            std::vector<bool> mWasSelected;
+
             WeightedRouletteCandidateSelector();
 
         public:
-            bmt::MCandidateVector select(uint32_t maxCandidates,
-                                         const bmt::MCandidateVector& candidates) override;
+            void select(uint32_t maxCandidates,
+                        const bmt::ACandidateVector& candidates,
+                        bmt::Vector& selected) override;
+
+            static uRef Create();
+    };
+
+    /// \brief Same estimation as `GeoDistanceSwapCEstimator`, but using a
+    /// flat distance table.
+    ///
+    /// The distances are stored as `uint16_t` in one contiguous block, each row
+    /// padded to a multiple of 16 entries. When the processor supports AVX2,
+    /// eight distances are gathered at once. Otherwise, it falls back to a
+    /// scalar loop over the same table. If some distance doesn't fit in a
+    /// `uint16_t`, the flat table is not built, and the \em DistanceTable is
+    /// read instead.
+    class FlatGeoDistanceSwapCEstimator : public SwapCostEstimator {
+        private:
+            std::vector<uint16_t> mDist;
+            /// \brief Only set when the distances don't fit in \em mDist.
+            DistanceTable::sRef mTable;
+            uint32_t mStride;
+            bool mUseAVX2;
+
+        protected:
+            void initImpl() override;
+            uint32_t estimateImpl(const Mapping& fromM, const Mapping& toM) override;
+
+        public:
+            typedef FlatGeoDistanceSwapCEstimator* Ref;
+            typedef std::unique_ptr<FlatGeoDistanceSwapCEstimator> uRef;
+
+            FlatGeoDistanceSwapCEstimator();
+
+            /// \brief Enables (or disables) the AVX2 kernel. It is only enabled
+            /// if the processor supports it.
+            void setUseAVX2(bool use);
+            /// \brief Returns true if the AVX2 kernel is being used.
+            bool usesAVX2() const;
+
+            SwapCostEstimator::uRef clone() const override;
 
             static uRef Create();
     };
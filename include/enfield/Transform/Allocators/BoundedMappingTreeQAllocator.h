@@ -3,6 +3,7 @@
 
 #include "enfield/Transform/Allocators/QbitAllocator.h"
 #include "enfield/Transform/XbitToNumberPass.h"
+#include "enfield/Transform/InstructionStream.h"
 #include "enfield/Support/TokenSwapFinder.h"
 
 #include <queue>
@@ -12,17 +13,17 @@ namespace efd {
         /// \brief Used for ordering the nodes based on some weight.
         struct NodeCandidate {
             uint32_t mWeight;
-            Node::Ref mNode;
-            Dependencies mDeps;
+            /// \brief The statement index of the node.
+            uint32_t mIndex;
+            DepsSpan mDeps;
         };
 
-        typedef std::priority_queue<NodeCandidate,
-                                    std::vector<NodeCandidate>,
-                                    std::greater<NodeCandidate>> NCPQueue;
+        /// \brief Node candidates, sorted by \em operator> (lowest first).
+        typedef std::vector<NodeCandidate> NCVector;
 
         /// \brief `LessThan` operator that orders `NodeCandidate`s.
         ///
-        /// It compares the weights and the `Node` pointer only, since the
+        /// It compares the weights and the statement index only, since the
         /// `mDeps` depends on it.
         bool operator>(const NodeCandidate& lhs, const NodeCandidate& rhs);
 
@@ -32,9 +33,55 @@ namespace efd {
             uint32_t cost;
         };
 
+        /// \brief Slab of fixed-stride `uint32_t` rows.
+        ///
+        /// Used for storing the mappings (and their inverse) of the candidates
+        /// while they are being extended in phase 1. Clearing it keeps the
+        /// memory, so that, after a few steps, no allocation happens at all.
+        class MappingArena {
+            private:
+                uint32_t mStride;
+                uint32_t mRows;
+                uint32_t mGrowths;
+                std::vector<uint32_t> mData;
+
+            public:
+                MappingArena(uint32_t stride = 0);
+
+                /// \brief Removes all rows, but keeps the memory.
+                void clear();
+                /// \brief Appends a new row (uninitialized), and returns its index.
+                uint32_t push();
+                /// \brief Appends a copy of the row \p i of \p other, and returns its index.
+                uint32_t push(const MappingArena& other, uint32_t i);
+
+                /// \brief Gets a pointer to the beginning of row \p i. It is invalidated
+                /// by \em push.
+                uint32_t* row(uint32_t i);
+                const uint32_t* row(uint32_t i) const;
+
+                /// \brief Returns the number of rows.
+                uint32_t size() const;
+                /// \brief Returns the number of elements of each row.
+                uint32_t getStride() const;
+                /// \brief Returns the number of times the memory had to grow.
+                uint32_t getGrowths() const;
+        };
+
+        /// \brief Candidate in phase 1 whose mapping lives in a `MappingArena`.
+        ///
+        /// The first \em mVQubits elements of the row are the `Mapping`. The
+        /// following \em mPQubits are its `InverseMap`.
+        struct ArenaCandidate {
+            uint32_t row;
+            uint32_t cost;
+        };
+
         /// \brief Necessary information for getting the combinations in phase 2.
+        ///
+        /// The mapping itself is not kept. It is rebuilt from the candidates of
+        /// phase 1 while tracing back the path.
         struct TracebackInfo {
-            Mapping m;
             uint32_t parent;
             uint32_t mappingCost;
             uint32_t swapEstimatedCost;
@@ -46,6 +93,32 @@ namespace efd {
         typedef std::vector<MappingCandidate> MCandidateVector;
         typedef std::vector<MCandidateVector> MCandidateVCollection;
 
+        typedef std::vector<ArenaCandidate> ACandidateVector;
+
+        /// \brief Removes the candidates that have the same mapping, keeping only
+        /// the cheapest of them (in the position of the first one).
+        ///
+        /// The hash table is kept between calls, so that it is allocated only
+        /// when the number of candidates grows.
+        class CandidateDeduplicator {
+            private:
+                uint32_t mGrowths;
+                Vector mSlots;
+                std::vector<uint64_t> mHashes;
+
+            public:
+                CandidateDeduplicator();
+
+                /// \brief Deduplicates \p candidates, comparing the first \p n
+                /// elements of their rows in \p arena. Returns the number of
+                /// removed candidates.
+                uint32_t dedupe(const MappingArena& arena, uint32_t n,
+                                ACandidateVector& candidates);
+
+                /// \brief Returns the number of times the memory had to grow.
+                uint32_t getGrowths() const;
+        };
+
         typedef std::vector<TracebackInfo> TIVector;
         typedef std::vector<TIVector> TIMatrix;
 
@@ -67,12 +140,16 @@ namespace efd {
             uint32_t cost;
         };
 
-        typedef std::vector<Node::Ref> PPartition;
+        /// \brief Statement indexes of the nodes of a partition.
+        typedef std::vector<uint32_t> PPartition;
         typedef std::vector<PPartition> PPartitionCollection;
     }
 
     /// \brief Generates a vector with the `Node`s that can be chosen as the
     /// next instruction.
+    ///
+    /// The `Node`s are identified by their statement index (see
+    /// \em DependencyBuilder::getDepsAt).
     struct NodeCandidatesGenerator {
         typedef NodeCandidatesGenerator* Ref;
         typedef std::unique_ptr<NodeCandidatesGenerator> uRef;
@@ -80,14 +157,16 @@ namespace efd {
         virtual ~NodeCandidatesGenerator() = default;
         NodeCandidatesGenerator();
 
-        /// \brief Returns the next collection of candidates.
-        std::vector<Node::Ref> generate();
+        /// \brief Writes the next collection of candidates into \p candidates.
+        ///
+        /// \p candidates is cleared first, so that its storage may be reused.
+        void generate(std::vector<uint32_t>& candidates);
         /// \brief Returns whether we have finished processing the nodes.
         bool finished();
         /// \brief Initializes the generator.
         void init(QModule::Ref qmod);
         /// \brief Signals the generator which node has been selected.
-        virtual void signalProcessed(Node::Ref node);
+        virtual void signalProcessed(uint32_t i);
 
         private:
             bool mInitialized;
@@ -98,7 +177,7 @@ namespace efd {
 
             virtual void initImpl();
             virtual bool finishedImpl() = 0;
-            virtual std::vector<Node::Ref> generateImpl() = 0;
+            virtual void generateImpl(std::vector<uint32_t>& candidates) = 0;
     };
 
     /// \brief Interface for selecting candidates (if they are greater than
@@ -107,9 +186,14 @@ namespace efd {
         typedef CandidateSelector* Ref;
         typedef std::unique_ptr<CandidateSelector> uRef;
         virtual ~CandidateSelector() = default;
-        /// \brief Selects \em maxCandidates from \em candidates.
-        virtual bmt::MCandidateVector select(uint32_t maxCandidates,
-                                             const bmt::MCandidateVector& candidates) = 0;
+        /// \brief Selects \em maxCandidates from \em candidates, writing their
+        /// indexes in \em selected.
+        ///
+        /// \em selected is cleared before, so that its memory can be reused
+        /// between calls.
+        virtual void select(uint32_t maxCandidates,
+                            const bmt::ACandidateVector& candidates,
+                            bmt::Vector& selected) = 0;
     };
 
     /// \brief Interface for estimating the number of swaps in phase 2.
@@ -124,6 +208,9 @@ namespace efd {
         void init(Graph::Ref g);
         /// \brief Estimates the number of swaps to go from \em fromM to \toM.
         uint32_t estimate(const Mapping& fromM, const Mapping& toM);
+        /// \brief Creates a copy of this (already initialized) estimator, so that
+        /// it can be used by another thread.
+        virtual uRef clone() const = 0;
 
         protected:
             Graph::Ref mG;
@@ -148,6 +235,9 @@ namespace efd {
         /// \brief Processes `Mapping` \em toM, based on the graph \em g and on the
         /// last `Mapping` \em fromM.
         void process(Mapping& fromM, Mapping& toM);
+        /// \brief Creates a copy of this (already initialized) processor, so that
+        /// it can be used by another thread.
+        virtual uRef clone() const = 0;
 
         protected:
             Graph::Ref mG;
@@ -177,6 +267,10 @@ namespace efd {
     ///         together;
     ///     3. Reconstructs the selected sequence of subgraph isomorphisms
     ///         into a program.
+    ///
+    /// Phase 2 may be run in parallel (see `-threads`). Each thread uses its own
+    /// clone of the `SwapCostEstimator` and `LiveQubitsPreProcessor`, and the
+    /// result does not depend on the number of threads.
     class BoundedMappingTreeQAllocator : public QbitAllocator {
         public:
             typedef BoundedMappingTreeQAllocator* Ref;
@@ -185,8 +279,16 @@ namespace efd {
         protected:
             uint32_t mMaxChildren;
             uint32_t mMaxPartial;
-            DependencyBuilder mDBuilder;
-            XbitToNumber mXtoN;
+            uint32_t mThreads;
+            uint32_t mPhase1Growths;
+            uint64_t mDedupeTotal;
+            uint64_t mDedupeRemoved;
+            uint64_t mPrunedTransitions;
+            bool mDedupe;
+            bool mPrune;
+            std::shared_ptr<const DependencyBuilder> mDBuilder;
+            std::shared_ptr<const XbitToNumber> mXtoN;
+            std::shared_ptr<const InstructionStream> mStream;
             bmt::PPartitionCollection mPP;
 
             NodeCandidatesGenerator::uRef mNCGenerator;
@@ -202,16 +304,43 @@ namespace efd {
             bmt::MappingSwapSequence phase2(const bmt::MCandidateVCollection& collection);
             Mapping phase3(QModule::Ref qmod, const bmt::MappingSwapSequence& mss);
 
-            bmt::MCandidateVector extendCandidates(Dep& dep,
-                                                   const std::vector<bool>& mapped,
-                                                   const bmt::MCandidateVector& candidates,
-                                                   bool ignoreChildrenLimit);
-
-            bmt::NCPQueue rankCandidates(const std::vector<Node::Ref>& nodeCandidates,
-                                         const std::vector<bool>& mapped,
-                                         const std::vector<std::set<uint32_t>>& neighbors);
-
-            bmt::MappingSeq tracebackPath(const bmt::TIMatrix& mem, uint32_t idx);
+            // Buffers reused by `extendCandidates`.
+            bmt::ACandidateVector mChildren;
+            bmt::ACandidateVector mExtended;
+            bmt::Vector mSelected;
+            bmt::CandidateDeduplicator mDeduplicator;
+            // Buffers reused by `phase1`.
+            std::vector<uint32_t> mNodeCandidates;
+            bmt::NCVector mRanked;
+
+            /// \brief Extends the \em candidates (stored in \em arena), so that
+            /// they satisfy \em dep. The result is written in \em newArena and
+            /// \em newCandidates.
+            void extendCandidates(const Dep& dep,
+                                  const std::vector<bool>& mapped,
+                                  const bmt::MappingArena& arena,
+                                  const bmt::ACandidateVector& candidates,
+                                  bool ignoreChildrenLimit,
+                                  bmt::MappingArena& newArena,
+                                  bmt::ACandidateVector& newCandidates);
+
+            /// \brief Resets \em arena and \em candidates to a single empty mapping.
+            void resetCandidates(bmt::MappingArena& arena, bmt::ACandidateVector& candidates);
+            /// \brief Copies the mappings of \em candidates out of the \em arena.
+            bmt::MCandidateVector toMCandidateVector(const bmt::MappingArena& arena,
+                                                     const bmt::ACandidateVector& candidates);
+
+            /// \brief Sorts the \em nodeCandidates into \em mRanked.
+            ///
+            /// \p neighbors is a `mVQubits * mVQubits` table, whose entry
+            /// `a * mVQubits + b` is set if `a` and `b` were already coupled
+            /// in this partition.
+            void rankCandidates(const std::vector<uint32_t>& nodeCandidates,
+                                const std::vector<bool>& mapped,
+                                const std::vector<uint8_t>& neighbors);
+
+            bmt::MappingSeq tracebackPath(const bmt::MCandidateVCollection& collection,
+                                          const bmt::TIMatrix& mem, uint32_t idx);
             SwapSeq getTransformingSwapsFor(const Mapping& fromM, Mapping toM);
             void normalize(bmt::MappingSwapSequence& mss);
 
@@ -233,6 +362,16 @@ namespace efd {
             void setMapSeqSelector(MapSeqSelector::uRef sel);
             /// \brief Sets the implementation for finding the swap sequences in phase 3.
             void setTokenSwapFinder(TokenSwapFinder::uRef finder);
+            /// \brief Removes duplicate mappings in phase 1, before selecting the
+            /// partial solutions.
+            void setDedupeCandidates(bool dedupe);
+            /// \brief Skips, in phase 2, the predecessors that can't beat the best
+            /// one found so far (enabled by default). The result is the same.
+            void setPhase2Pruning(bool prune);
+
+            /// \brief Returns the number of transitions pruned in phase 2 by the
+            /// last allocation.
+            uint64_t getPrunedTransitions() const;
 
             static uRef Create(ArchGraph::sRef ag);
     };
@@ -2,7 +2,7 @@
 #define __EFD_CHALLENGE_WINNER_QALLOCATOR_H__
 
 #include "enfield/Transform/Allocators/QbitAllocator.h"
-#include "enfield/Support/BFSCachedDistance.h"
+#include "enfield/Support/DistanceTable.h"
 
 namespace efd {
 
@@ -21,7 +21,7 @@ namespace efd {
         private:
             using UIntPair = std::pair<uint32_t, uint32_t>;
 
-            BFSCachedDistance mDistance;
+            DistanceTable::sRef mDistance;
 
             uint32_t getOrAssignPQubitFor(uint32_t a,
                                           const Mapping& mapping,
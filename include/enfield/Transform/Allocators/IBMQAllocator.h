@@ -3,6 +3,7 @@
 
 #include "enfield/Transform/Allocators/StdSolutionQAllocator.h"
 #include "enfield/Transform/LayersBuilderPass.h"
+#include "enfield/Support/DistanceTable.h"
 #include "enfield/Support/Defs.h"
 
 namespace efd {
@@ -25,11 +26,12 @@ namespace efd {
 
             uint32_t mPQubits;
             uint32_t mLQubits;
-            std::vector<std::vector<uint32_t>> mDist;
+            DistanceTable::sRef mDist;
 
-            AllocationResult tryAllocateLayer(Layer& layer, Mapping current,
+            /// \brief Tries to allocate the statements whose indexes are in \p layer.
+            AllocationResult tryAllocateLayer(const std::vector<uint32_t>& layer, Mapping current,
                                               std::set<uint32_t> qubitsSet,
-                                              DependencyBuilder& depData);
+                                              const DependencyBuilder& depData);
 
         public:
             IBMQAllocator(ArchGraph::sRef archGraph);
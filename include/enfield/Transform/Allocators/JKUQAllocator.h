@@ -3,18 +3,31 @@
 
 #include "enfield/Transform/Allocators/QbitAllocator.h"
 #include "enfield/Transform/DependencyBuilderPass.h"
+#include "enfield/Transform/InstructionStream.h"
 #include "enfield/Transform/LayersBuilderPass.h"
-#include "enfield/Support/BFSPathFinder.h"
+#include "enfield/Support/DistanceTable.h"
+#include "enfield/Support/CommandLine.h"
+#include "enfield/Support/Stats.h"
 #include "enfield/Support/Defs.h"
 
 #include <queue>
 
 namespace efd {
 namespace jku {
-    struct AStarNode;
+    class AStarPool;
     struct ExpandNodeState;
 }
 
+    /// \brief Number of A* nodes (open or expanded) kept in memory (`-jku-max-nodes`).
+    extern Opt<uint32_t> JKUMaxNodes;
+    /// \brief Number of open A* nodes kept by the beam (`-jku-beam-width`).
+    extern Opt<uint32_t> JKUBeamWidth;
+
+    /// \brief Number of A* nodes dropped because their mapping was already expanded.
+    extern Stat<uint32_t> JKUDuplicates;
+    /// \brief Number of times the A* search was cut down to a beam.
+    extern Stat<uint32_t> JKUBeamFallbacks;
+
     /// \brief JKU QAllocator.
     ///
     /// Implemented from Zulehner et. al.:
@@ -23,6 +36,13 @@ namespace jku {
     ///
     /// Main C implementation can be found at:
     /// http://iic.jku.at/eda/research/ibm_qx_mapping/
+    ///
+    /// The A* nodes live in a pool, and share their swap history through
+    /// parent pointers. Mappings that were already expanded are not expanded
+    /// again. Whenever the pool and the expanded mappings add up to
+    /// `-jku-max-nodes`, the search falls back to a beam: only the best
+    /// `-jku-beam-width` open nodes are kept, and the expanded mappings are
+    /// forgotten if they take half of the cap.
     class JKUQAllocator : public QbitAllocator {
         public:
             typedef JKUQAllocator* Ref;
@@ -30,19 +50,23 @@ namespace jku {
 
         private:
             std::vector<std::vector<uint32_t>> mTable;
-            DependencyBuilder mDBuilder;
-            BFSPathFinder mBFS;
+            std::shared_ptr<const DependencyBuilder> mDBuilder;
+            std::shared_ptr<const InstructionStream> mStream;
+            uint32_t mMaxNodes;
+            uint32_t mBeamWidth;
 
             void buildCostTable();
-            void expandNodeRecursively(const jku::AStarNode& aNode,
-                                       uint32_t i,
-                                       jku::ExpandNodeState& state);
-
-            jku::AStarNode astar(std::queue<uint32_t>& cnotLayersIdQ,
-                                 const Layers& layers,
-                                 uint32_t i,
-                                 Mapping& mapping,
-                                 InverseMap& inverse);
+            void expandNodeRecursively(uint32_t i, jku::ExpandNodeState& state);
+
+            /// \brief Searches for the swaps that make layer \p i executable.
+            ///
+            /// Both \p mapping and \p inverse are updated to the mapping
+            /// after those swaps, which are returned in order.
+            std::vector<Swap> astar(std::queue<uint32_t>& cnotLayersIdQ,
+                                    const LayersIndexes& layers,
+                                    uint32_t i,
+                                    Mapping& mapping,
+                                    InverseMap& inverse);
         public:
             JKUQAllocator(ArchGraph::sRef archGraph);
 
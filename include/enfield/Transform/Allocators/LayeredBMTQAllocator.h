@@ -3,8 +3,9 @@
 
 #include "enfield/Transform/Allocators/QbitAllocator.h"
 #include "enfield/Transform/XbitToNumberPass.h"
+#include "enfield/Transform/InstructionStream.h"
 #include "enfield/Transform/LayersBuilderPass.h"
-#include "enfield/Support/BFSCachedDistance.h"
+#include "enfield/Support/DistanceTable.h"
 #include "enfield/Support/TokenSwapFinder.h"
 
 #include <random>
@@ -35,19 +36,20 @@ namespace l_bmt {
         protected:
             uint32_t mMaxPartial;
 
-            DependencyBuilder mDBuilder;
-            XbitToNumber mXtoN;
-            BFSCachedDistance mBFSDistance;
+            std::shared_ptr<const DependencyBuilder> mDBuilder;
+            std::shared_ptr<const XbitToNumber> mXtoN;
+            std::shared_ptr<const InstructionStream> mStream;
 
             std::vector<std::vector<Node::Ref>> mPP;
-            std::vector<std::vector<uint32_t>> mDistance;
+            DistanceTable::sRef mDistance;
 
             TokenSwapFinder::uRef mTSFinder;
 
             std::mt19937 mGen;
             std::uniform_real_distribution<double> mDistribution;
 
-            Layers mLayers;
+            /// \brief Statement indexes of the nodes of each layer.
+            std::shared_ptr<const LayersIndexes> mLayers;
 
         private:
             std::vector<std::vector<l_bmt::MappingCandidate>>
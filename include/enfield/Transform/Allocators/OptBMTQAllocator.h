@@ -3,7 +3,8 @@
 
 #include "enfield/Transform/Allocators/QbitAllocator.h"
 #include "enfield/Transform/XbitToNumberPass.h"
-#include "enfield/Support/BFSCachedDistance.h"
+#include "enfield/Transform/InstructionStream.h"
+#include "enfield/Support/DistanceTable.h"
 #include "enfield/Support/TokenSwapFinder.h"
 
 #include <random>
@@ -34,12 +35,13 @@ namespace opt_bmt {
         protected:
             uint32_t mMaxPartial;
 
-            DependencyBuilder mDBuilder;
-            XbitToNumber mXtoN;
-            BFSCachedDistance mBFSDistance;
+            std::shared_ptr<const DependencyBuilder> mDBuilder;
+            std::shared_ptr<const XbitToNumber> mXtoN;
+            std::shared_ptr<const InstructionStream> mStream;
 
-            std::vector<std::vector<Node::Ref>> mPP;
-            std::vector<std::vector<uint32_t>> mDistance;
+            /// \brief Statement indexes of the nodes of each partition.
+            std::vector<std::vector<uint32_t>> mPP;
+            DistanceTable::sRef mDistance;
 
             TokenSwapFinder::uRef mTSFinder;
 
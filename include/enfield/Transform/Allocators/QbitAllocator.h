@@ -8,6 +8,11 @@
 #include "enfield/Support/Stats.h"
 
 namespace efd {
+    /// \brief Seed used by the randomized allocators (`-seed`).
+    extern Opt<uint32_t> Seed;
+    /// \brief Seed used by the last randomized allocation.
+    extern Stat<uint32_t> SeedStat;
+
     /// \brief Base abstract class that allocates the qbits used in the program to
     /// the qbits that are in the physical architecture.
     class QbitAllocator : public PassT<Mapping> {
@@ -71,6 +76,9 @@ namespace efd {
 
     /// \brief Prints the mapping \p m to a string and returns it.
     std::string MappingToString(Mapping m);
+
+    /// \brief Hashes the first \p n elements of the mapping \p m.
+    uint64_t HashMapping(const uint32_t* m, uint32_t n);
 }
 
 #endif
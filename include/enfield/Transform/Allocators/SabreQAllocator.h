@@ -3,16 +3,28 @@
 
 #include "enfield/Transform/Allocators/QbitAllocator.h"
 #include "enfield/Transform/DependencyBuilderPass.h"
-#include "enfield/Support/BFSCachedDistance.h"
+#include "enfield/Transform/InstructionStream.h"
 
 #include <random>
 #include <queue>
 
 namespace efd {
+    /// \brief How much the error of an edge adds to the cost of going through it
+    /// (`-sabre-error-weight`).
+    extern Opt<double> SabreErrorWeight;
+
     /// \brief SABRE QAllocator
     ///
     /// Implemented from Gushu et. al.:
     /// Tackling the Qubit Mapping Problem for NISQ-Era Quantum Devices
+    ///
+    /// The iterations (see `-sabre-iterations`) run in parallel (see `-threads`).
+    /// Each one starts from a random mapping generated with its own seed, derived
+    /// from `-seed`. So, the result does not depend on the number of threads.
+    ///
+    /// With `-sabre-error-weight`, the swaps are scored by the error-weighted
+    /// distances of the architecture (see \em WeightedDistance), instead of
+    /// by the number of edges.
     class SabreQAllocator : public QbitAllocator {
         public:
             typedef SabreQAllocator* Ref;
@@ -20,14 +32,51 @@ namespace efd {
 
         private:
             typedef std::pair<Mapping, uint32_t> MappingAndNSwaps;
+            typedef std::vector<std::vector<uint32_t>> Matrix;
+
+            /// \brief Everything SABRE needs from a `QModule`.
+            ///
+            /// It is computed once (using the `PassCache`), and only read
+            /// afterwards. Therefore, it may be shared among threads.
+            ///
+            /// Statements are identified by their index in the module (which is
+            /// also their index in `depBuilder`), and the circuit graph is
+            /// flattened into two tables (in CSR form):
+            /// the xbits of each statement, and the gate statements of each
+            /// xbit (in program order).
+            struct ModuleInfo {
+                QModule::Ref qmod;
+                uint32_t xbitNumber;
+                std::vector<Node::Ref> stmts;
+                std::shared_ptr<const DependencyBuilder> depBuilder;
+
+                /// \brief Xbits of statement `s` are in [xbitsBegin[s], xbitsBegin[s + 1]).
+                std::vector<uint32_t> xbitsBegin;
+                std::vector<uint32_t> xbits;
+
+                /// \brief Statements of xbit `x` are in [wireBegin[x], wireBegin[x + 1]).
+                std::vector<uint32_t> wireBegin;
+                std::vector<uint32_t> wire;
+            };
 
             uint32_t mLookAhead;
             uint32_t mIterations;
-            BFSCachedDistance mBFSDistance;
-            XbitToNumber mXbitToNumber;
+            /// \brief Cost of moving between two physical qubits `u` and `v`, at
+            /// `mCost[u * mPQubits + v]`: their distance, weighted by the error of
+            /// the edges in between with `-sabre-error-weight`.
+            std::vector<double> mCost;
+            std::shared_ptr<const XbitToNumber> mXbitToNumber;
+            std::shared_ptr<const InstructionStream> mStream;
+
+            ModuleInfo buildModuleInfo(QModule::Ref qmod);
+            void buildCostTable();
 
+            /// \brief Runs SABRE once, starting from \p initialMapping.
+            ///
+            /// Unless \p issueInstructions is true, it does not modify anything,
+            /// and may be called concurrently.
             MappingAndNSwaps allocateWithInitialMapping(const Mapping& initialMapping,
-                                                        QModule::Ref qmod,
+                                                        const ModuleInfo& info,
                                                         bool issueInstructions);
 
         protected:
@@ -49,6 +49,7 @@ namespace efd {
 
                     Type mType;
                     Node::Ref mNode;
+                    uint32_t mIndex;
                     std::unordered_map
                         <uint32_t, std::pair<CircuitNode::sRef, CircuitNode::sRef>>
                         mStepMap;
@@ -58,6 +59,12 @@ namespace efd {
                 public:
                     /// \brief Returns the \em Node::Ref associated with this circuit node.
                     Node::Ref node();
+                    /// \brief Returns the number of gate nodes appended before this one
+                    /// (`_undef` for input and output nodes).
+                    ///
+                    /// For the \em CircuitGraphBuilderPass, it is the index of the statement
+                    /// (see \em DependencyBuilder::getDepsAt).
+                    uint32_t index();
 
                     /// \brief Returns the number of \p Xbit's in this node.
                     uint32_t numberOfXbits();
@@ -81,6 +88,7 @@ namespace efd {
             bool mInit;
             uint32_t mQubits;
             uint32_t mCbits;
+            uint32_t mGateNodes;
             std::vector<CircuitNode::sRef> mGraphHead;
             std::vector<CircuitNode::sRef> mGraphTail;
 
@@ -117,11 +125,16 @@ namespace efd {
 
             CircuitGraph();
             CircuitGraph(uint32_t qubits, uint32_t cbits);
+            /// \brief Copies must be explicit (see \em PassCache::CopyData).
+            explicit CircuitGraph(const CircuitGraph&) = default;
+            CircuitGraph(CircuitGraph&&) = default;
+            CircuitGraph& operator=(const CircuitGraph&) = default;
+            CircuitGraph& operator=(CircuitGraph&&) = default;
 
             /// \brief Initializes the CircuitGraph.
             void init(uint32_t qubits, uint32_t cbits);
             /// \brief Checks if the CircuitGraph is initialized. Exits with error if not.
-            void checkInitialized();
+            void checkInitialized() const;
 
             /// \brief Returns the number of qubits.
             uint32_t getQSize() const;
@@ -134,7 +147,7 @@ namespace efd {
             void append(std::vector<Xbit> xbits, Node::Ref node);
 
             /// \brief Builds an iterator instance for this \p CircuitGraph.
-            Iterator build_iterator();
+            Iterator build_iterator() const;
     };
 }
 
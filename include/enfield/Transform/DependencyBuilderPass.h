@@ -49,44 +49,106 @@ namespace efd {
         ConstIterator end() const;
     };
 
+    /// \brief Read-only view of the dependencies of one instruction, stored in
+    /// the flat table of \em DependencyBuilder.
+    ///
+    /// It is only valid while the \em DependencyBuilder it came from is alive.
+    struct DepsSpan {
+        typedef const Dep* ConstIterator;
+
+        const Dep* mBegin;
+        const Dep* mEnd;
+        Node::Ref mCallPoint;
+
+        /// \brief Returns the \p i-th dependency.
+        const Dep& operator[](uint32_t i) const;
+
+        /// \brief Returns true if there is no dependency.
+        bool empty() const;
+        /// \brief Returns the number of dependencies.
+        uint32_t size() const;
+
+        ConstIterator begin() const;
+        ConstIterator end() const;
+
+        /// \brief Copies the dependencies into a new \em Dependencies.
+        Dependencies toDependencies() const;
+    };
+
     /// \brief Keep track of the dependencies of each qbit for the whole program,
     /// as well as the dependencies for every gate.
     ///
     /// Each gate, as well as the whole program have one 'DepsVector' variable. The idea is
     /// to store a sequence of parallel dependencies. Here, parallel dependency is a
     /// dependency that can't be broken down (unless the gate is inlined).
+    ///
+    /// Besides that, each instruction has a dense index, and its dependencies are
+    /// kept in a flat table (see \em getDeps). The statements of the module are
+    /// indexed by their position, so that one may use \em getDepsAt directly.
     struct DependencyBuilder {
         typedef DependencyBuilder* Ref;
         typedef std::vector<Dependencies> DepsVector;
 
-        XbitToNumber mXbitToNumber;
+        /// \brief Shared with the \em XbitToNumberWrapperPass it came from.
+        std::shared_ptr<const XbitToNumber> mXbitToNumber;
 
         std::unordered_map<NDGateDecl*, DepsVector> mLDeps;
-        std::map<Node*, Dependencies> mIDeps;
         DepsVector mGDeps;
 
+        /// \brief Dense index of each instruction.
+        std::unordered_map<Node*, uint32_t> mIndex;
+        /// \brief The dependencies of the instruction of index `i` are
+        /// `mDepList[mDepsBegin[i]]` up to (not including) `mDepList[mDepsEnd[i]]`.
+        std::vector<uint32_t> mDepsBegin;
+        std::vector<uint32_t> mDepsEnd;
+        std::vector<Node::Ref> mCallPoint;
+        std::vector<Dep> mDepList;
+
         DependencyBuilder();
+        /// \brief Copies must be explicit (see \em PassCache::CopyData).
+        explicit DependencyBuilder(const DependencyBuilder&) = default;
+        DependencyBuilder(DependencyBuilder&&) = default;
+        DependencyBuilder& operator=(const DependencyBuilder&) = default;
+        DependencyBuilder& operator=(DependencyBuilder&&) = default;
 
         /// \brief Gets an unsingned id for \p ref.
-        uint32_t getUId(Node::Ref ref, NDGateDecl::Ref gate);
+        uint32_t getUId(Node::Ref ref, NDGateDecl::Ref gate) const;
         /// \brief Gets the DepsVector corresponding to the current quantum gate,
         /// or the global (if current gate is null).
         const DepsVector* getDepsVector(NDGateDecl::Ref gate = nullptr) const;
         DepsVector* getDepsVector(NDGateDecl::Ref gate = nullptr);
 
         /// \brief Returns the structure that mapped the qbits.
-        XbitToNumber& getXbitToNumber();
+        const XbitToNumber& getXbitToNumber() const;
         /// \brief Sets the structure that will map the qbits.
-        void setXbitToNumber(XbitToNumber& xtn);
+        void setXbitToNumber(std::shared_ptr<const XbitToNumber> xtn);
 
         /// \brief Gets the dependencies for some gate declaration. If it is a
         /// nullptr, then it is returned the dependencies for the whole program.
         const DepsVector& getDependencies(NDGateDecl::Ref ref = nullptr) const;
         DepsVector& getDependencies(NDGateDecl::Ref ref = nullptr);
 
+        /// \brief Gives \p ref the next free index (if it has none), and sets
+        /// its dependencies to \p deps.
+        void putDeps(Node::Ref ref, const std::vector<Dep>& deps);
+
+        /// \brief Returns the index of the instruction \p ref (`_undef` if it
+        /// was never seen).
+        uint32_t getIndex(Node::Ref ref) const;
+        /// \brief Returns the number of indexed instructions.
+        uint32_t getNumberOfIndexes() const;
+
+        /// \brief Gets the dependencies of the instruction whose index is \p i.
+        DepsSpan getDepsAt(uint32_t i) const;
         /// \brief Gets the dependencies for a specific instruction.
-        const Dependencies getDeps(Node* ref) const;
-        Dependencies getDeps(Node* ref);
+        ///
+        /// Instructions that were never seen have none. An `if` has those of
+        /// its operation.
+        DepsSpan getDeps(Node::Ref ref) const;
+    };
+
+    template <> struct DataSizeTrait<DependencyBuilder> {
+        static uint64_t Get(const DependencyBuilder& data);
     };
 
     /// \brief WrapperPass that yields a \em DependencyBuilder structure.
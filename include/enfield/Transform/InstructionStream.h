@@ -0,0 +1,134 @@
+#ifndef __EFD_INSTRUCTION_STREAM_H__
+#define __EFD_INSTRUCTION_STREAM_H__
+
+#include "enfield/Analysis/Nodes.h"
+#include "enfield/Transform/Pass.h"
+#include "enfield/Transform/QModule.h"
+#include "enfield/Transform/XbitToNumberPass.h"
+#include "enfield/Support/StringInterner.h"
+#include "enfield/Support/Defs.h"
+
+#include <initializer_list>
+#include <vector>
+
+namespace efd {
+
+    /// \brief Flat representation of the statements of a flattened and inlined
+    /// \em QModule (see \em FlattenPass and \em InlineAllPass).
+    ///
+    /// Each statement is one instruction, indexed by its position (the same index
+    /// the \em DependencyBuilder gives it). Instructions are kept as a structure of
+    /// arrays: an opcode, the qubit uids (a slice of \em mQArgs), the cbit uid, a
+    /// parameter slot and a condition slot. The slots index tables shared by the
+    /// whole stream.
+    ///
+    /// The parameter table holds the source operations whose id and arguments are
+    /// reused when the stream is turned back into statements (see \em materialize).
+    /// So, the source \em QModule must be alive while this stream is materialized.
+    ///
+    /// The allocators that remap the statements themselves issue their output
+    /// through it. The ones that only build a \em StdSolution leave the
+    /// remapping to \em StdSolutionQAllocator, which also uses it.
+    struct InstructionStream {
+        enum Opcode : uint8_t {
+            K_CX = 0,
+            K_U,
+            K_GATE,
+            K_MEASURE,
+            K_RESET,
+            K_BARRIER,
+            K_SWAP,
+            K_REV_CX,
+            K_LCX
+        };
+
+        /// \brief Condition of an `if` statement: `if (mReg == mVal)`.
+        struct Condition {
+            StringInterner::Symbol mReg;
+            IntVal mVal;
+        };
+
+        std::vector<uint8_t> mOpcode;
+        /// \brief The qubits of the instruction `i` are `mQArgs[mQArgsBegin[i]]`
+        /// up to (not including) `mQArgs[mQArgsBegin[i + 1]]`.
+        std::vector<uint32_t> mQArgsBegin;
+        std::vector<uint32_t> mQArgs;
+        /// \brief The cbit uid (only for \em K_MEASURE), or `_undef`.
+        std::vector<uint32_t> mCBit;
+        /// \brief Index into \em mParams (only for \em K_U and \em K_GATE), or `_undef`.
+        std::vector<uint32_t> mParam;
+        /// \brief Index into \em mConds, or `_undef`.
+        std::vector<uint32_t> mCond;
+
+        std::vector<NDQOp::Ref> mParams;
+        std::vector<Condition> mConds;
+
+        InstructionStream();
+        /// \brief Copies must be explicit (see \em PassCache::CopyData).
+        explicit InstructionStream(const InstructionStream&) = default;
+        InstructionStream(InstructionStream&&) = default;
+        InstructionStream& operator=(const InstructionStream&) = default;
+        InstructionStream& operator=(InstructionStream&&) = default;
+
+        /// \brief Returns the number of instructions.
+        uint32_t size() const;
+        /// \brief Removes every instruction and table entry.
+        void clear();
+
+        /// \brief Returns the opcode of the \p i-th instruction.
+        Opcode getOpcode(uint32_t i) const;
+        /// \brief Returns the number of qubits of the \p i-th instruction.
+        uint32_t getQArgsNumber(uint32_t i) const;
+        /// \brief Returns a pointer to the first qubit of the \p i-th instruction.
+        const uint32_t* qargs_begin(uint32_t i) const;
+        /// \brief Returns a pointer past the last qubit of the \p i-th instruction.
+        const uint32_t* qargs_end(uint32_t i) const;
+        /// \brief Returns the cbit of the \p i-th instruction.
+        uint32_t getCBit(uint32_t i) const;
+        /// \brief Returns the condition slot of the \p i-th instruction.
+        uint32_t getCond(uint32_t i) const;
+
+        /// \brief Appends an instruction, returning its index.
+        uint32_t append(Opcode op, const uint32_t* qbegin, const uint32_t* qend,
+                        uint32_t cbit = _undef, uint32_t param = _undef, uint32_t cond = _undef);
+        /// \brief Appends an instruction that has only qubits (and maybe a condition).
+        uint32_t append(Opcode op, std::initializer_list<uint32_t> qargs, uint32_t cond = _undef);
+        /// \brief Appends a copy of the \p i-th instruction of \p from, replacing
+        /// its qubits by the ones they are mapped to in \p mapping.
+        ///
+        /// As the \em QubitRemapVisitor, if any of them is not mapped, none is
+        /// replaced. \p from must share the tables of this stream (see \em WithTablesOf).
+        uint32_t appendMapped(const InstructionStream& from, uint32_t i, const Mapping& mapping);
+
+        /// \brief Builds the statements of this stream.
+        ///
+        /// The qubit (and cbit) uids are turned into the nodes given by \p xtn.
+        std::vector<Node::uRef> materialize(const XbitToNumber& xtn) const;
+
+        /// \brief Returns an empty stream that uses the same tables as \p src, so
+        /// that the instructions of \p src may be appended to it.
+        static InstructionStream WithTablesOf(const InstructionStream& src);
+    };
+
+    template <> struct DataSizeTrait<InstructionStream> {
+        static uint64_t Get(const InstructionStream& data);
+    };
+
+    /// \brief WrapperPass that yields an \em InstructionStream of the statements
+    /// of a \em QModule.
+    class InstructionStreamWrapperPass : public PassT<InstructionStream> {
+        public:
+            typedef InstructionStreamWrapperPass* Ref;
+            typedef std::unique_ptr<InstructionStreamWrapperPass> uRef;
+            typedef std::shared_ptr<InstructionStreamWrapperPass> sRef;
+
+            static uint8_t ID;
+
+            bool run(QModule::Ref qmod) override;
+
+            /// \brief Returns a new instance of this class.
+            static uRef Create();
+    };
+}
+
+#endif
@@ -11,9 +11,15 @@ namespace efd {
     class QModule;
     typedef std::vector<Node::Ref> Layer;
     typedef std::vector<Layer> Layers;
+    /// \brief The statement index of each node of every \em Layer (see
+    /// \em DependencyBuilder::getDepsAt).
+    typedef std::vector<std::vector<uint32_t>> LayersIndexes;
 
     /// \brief Create the layers of the 'QModule'.
     class LayersBuilderPass : public PassT<Layers> {
+        private:
+            LayersIndexes mIndexes;
+
         public:
             typedef std::unique_ptr<LayersBuilderPass> uRef;
             typedef LayersBuilderPass* Ref;
@@ -22,6 +28,10 @@ namespace efd {
 
             bool run(QModule* qmod) override;
 
+            /// \brief Returns the layers, with the index of each statement instead
+            /// of the statement itself.
+            const LayersIndexes& getIndexes() const;
+
             /// \brief Create an instance of this class.
             static uRef Create();
     };
@@ -2,6 +2,7 @@
 #define __EFD_PASS_H__
 
 #include <memory>
+#include <cstdint>
 
 namespace efd {
     class QModule;
@@ -36,6 +37,14 @@ namespace efd {
             Kind getKind() const;
     };
 
+    /// \brief Approximate size (in bytes) of the data of a pass, used for accounting
+    /// the copies made out of the \em PassCache.
+    ///
+    /// One should specialize it for data that owns heap memory.
+    template <typename T> struct DataSizeTrait {
+        static uint64_t Get(const T& data) { return sizeof(T); }
+    };
+
     /// \brief Should serve as base class for classes that produces
     /// some data of type \em T.
     template <typename T>
@@ -44,6 +53,7 @@ namespace efd {
                 typedef PassT<T>* Ref;
                 typedef std::shared_ptr<PassT<T>> sRef;
                 typedef std::unique_ptr<PassT<T>> uRef;
+                typedef T DataTy;
 
             protected:
                 T mData;
@@ -54,8 +64,9 @@ namespace efd {
                 /// \brief Gets the resulting data.
                 ///
                 /// This should return the data generated by the processing of the
-                /// \em run function of the \em Pass class.
-                T getData() const;
+                /// \em run function of the \em Pass class. Copying it is up
+                /// to the caller (see \em PassCache::GetData).
+                const T& getData() const;
                 T& getData();
 
                 static bool ClassOf(Pass* ref);
@@ -75,7 +86,7 @@ efd::PassT<T>::PassT() : Pass(K_GEN) {
 }
 
 template <typename T>
-T efd::PassT<T>::getData() const {
+const T& efd::PassT<T>::getData() const {
     return mData;
 }
 
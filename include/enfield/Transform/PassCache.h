@@ -3,9 +3,14 @@
 
 #include "enfield/Transform/Pass.h"
 #include "enfield/Transform/QModule.h"
+#include "enfield/Support/Stats.h"
+#include "enfield/Support/Defs.h"
 #include <set>
 
 namespace efd {
+    /// \brief Number of bytes copied out of the \em PassCache (see \em PassCache::CopyData).
+    extern Stat<uint64_t> PassCacheBytesCopied;
+
     /// \brief Static class that caches passes that were run by this compiler.
     class PassCache {
         public:
@@ -72,6 +77,31 @@ namespace efd {
                 if (!Has<T>(qmod)) Run<T>(qmod);
                 return (T*) mPasses[qmod][&T::ID].get();
             }
+
+            /// \brief Gets the data of the pass \p T run in \p qmod, running it if
+            /// needed. Nothing is copied.
+            ///
+            /// The handle shares the ownership of the pass, so it is still valid after
+            /// the cache is cleared (e.g.: \p qmod was modified).
+            template <typename T>
+            static std::shared_ptr<const typename T::DataTy> GetData(QModule::Ref qmod) {
+                Get<T>(qmod);
+
+                auto pass = std::static_pointer_cast<T>(mPasses[qmod][&T::ID]);
+                EfdAbortIf(pass.get() == nullptr, "Pass modified the `QModule`, so it "
+                           "has no data to share.");
+
+                return std::shared_ptr<const typename T::DataTy>(pass, &pass->getData());
+            }
+
+            /// \brief Gets a copy of the data of the pass \p T run in \p qmod, for
+            /// those that need to modify it. It is accounted in \em PassCacheBytesCopied.
+            template <typename T>
+            static typename T::DataTy CopyData(QModule::Ref qmod) {
+                auto& data = Get<T>(qmod)->getData();
+                PassCacheBytesCopied += DataSizeTrait<typename T::DataTy>::Get(data);
+                return typename T::DataTy(data);
+            }
     };
 }
 
@@ -36,6 +36,10 @@ namespace efd {
             typedef GatesVector::const_iterator GateConstIterator;
 
         private:
+            /// \brief Arena that holds the nodes created when parsing or cloning
+            /// this module (if any). It is shared by the module and its clones.
+            Arena::sRef mArena;
+
             NDQasmVersion::uRef mVersion;
             IncludeVector mIncludes;
 
@@ -147,7 +151,14 @@ namespace efd {
             /// \brief Returns true if there is a quantum gate \p id.
             bool hasQGate(std::string id) const;
 
+            /// \brief Returns the arena that holds the nodes of this module
+            /// (nullptr if they were allocated in the heap).
+            Arena::sRef getArena() const;
+
             /// \brief Clones the current qmodule.
+            ///
+            /// The nodes of the clone are allocated from the arena of this
+            /// module (or a new one, if it has none).
             uRef clone() const;
 
             /// \brief Create a new empty QModule.
@@ -157,7 +168,7 @@ namespace efd {
             /// \brief Parses the file \p filename and returns a QModule.
             static uRef Parse(std::string filename, std::string path = "./");
             /// \brief Parses the string \p program and returns a QModule.
-            static uRef ParseString(std::string program);
+            static uRef ParseString(const std::string& program);
     };
 }
 
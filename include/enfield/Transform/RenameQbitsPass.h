@@ -19,8 +19,10 @@ namespace efd {
 
             static uint8_t ID;
 
+            typedef std::unordered_map<XbitKey, Node::Ref> ArchKeyMap;
+
         private:
-            ArchMap mAMap;
+            ArchKeyMap mAMap;
 
             RenameQbitPass(ArchMap map);
 
@@ -28,12 +28,25 @@ namespace efd {
 
         typedef std::map<std::string, XbitInfo> XbitMap;
         typedef std::map<std::string, std::vector<uint32_t>> XRegMap;
+        typedef std::unordered_map<XbitKey, uint32_t> XbitKeyMap;
 
         std::unordered_map<NDGateDecl*, XbitMap> lidQMap;
         XbitMap gidQMap;
         XbitMap gidCMap;
         XRegMap gidRegMap;
 
+        /// \brief Integer indexes of the maps above, keyed by \em XbitKey.
+        std::unordered_map<NDGateDecl*, XbitKeyMap> lidQKeyMap;
+        XbitKeyMap gidQKeyMap;
+        XbitKeyMap gidCKeyMap;
+
+        XbitToNumber() = default;
+        /// \brief Copies must be explicit (see \em PassCache::CopyData).
+        explicit XbitToNumber(const XbitToNumber&) = default;
+        XbitToNumber(XbitToNumber&&) = default;
+        XbitToNumber& operator=(const XbitToNumber&) = default;
+        XbitToNumber& operator=(XbitToNumber&&) = default;
+
         /// \brief Gets a constant reference to the mapping of qubtis of a gate.
         const XbitMap& getQbitMap(NDGateDecl::Ref gate = nullptr) const;
 
@@ -46,6 +59,14 @@ namespace efd {
         /// \brief Returns an uint32_t number representing the classic bit;
         uint32_t getCUId(std::string id) const;
 
+        /// \brief Returns an uint32_t number representing the qubit \p ref
+        /// (either an \em NDIdRef or an \em NDId) in this specific gate (if any).
+        ///
+        /// Contrary to the std::string overload, no string is built.
+        uint32_t getQUId(Node::Ref ref, NDGateDecl::Ref gate = nullptr) const;
+        /// \brief Returns an uint32_t number representing the classic bit \p ref.
+        uint32_t getCUId(Node::Ref ref) const;
+
         /// \brief Returns the number of qbits in a given gate (if any).
         uint32_t getQSize(NDGateDecl::Ref gate = nullptr) const;
         /// \brief Returns the number of cbits in a given gate (if any).
@@ -65,6 +86,10 @@ namespace efd {
         Node::Ref getCNode(uint32_t id) const;
     };
 
+    template <> struct DataSizeTrait<XbitToNumber> {
+        static uint64_t Get(const XbitToNumber& data);
+    };
+
     /// \brief WrapperPass that yields a \em XbitToNumber structure.
     class XbitToNumberWrapperPass : public PassT<XbitToNumber> {
         public:
@@ -11,6 +11,9 @@ efd::Node::Node(Kind k, bool empty) : mK(k), mIsEmpty(empty), mWasGenerated(fals
 }
 
 void efd::Node::innerAddChild(uRef ref) {
+    // Nodes built with this function have, at most, four children. Reserving
+    // them at once avoids reallocating the vector as it grows.
+    if (mChild.empty()) mChild.reserve(4);
     ref->setParent(this);
     mChild.push_back(std::move(ref));
 }
@@ -18,6 +21,14 @@ void efd::Node::innerAddChild(uRef ref) {
 efd::Node::~Node() {
 }
 
+void* efd::Node::operator new(std::size_t size) {
+    return Arena::Allocate(size);
+}
+
+void efd::Node::operator delete(void* ptr, std::size_t size) {
+    Arena::Deallocate(ptr, size);
+}
+
 efd::Node::Ref efd::Node::getChild(uint32_t i) const {
     return mChild[i].get();
 }
@@ -125,7 +136,8 @@ efd::Node::uRef efd::Node::clone() const {
 // -------------- Value Specializations -----------------
 // -------------- Value<efd::IntVal> -----------------
 template <> 
-efd::NDValue<efd::IntVal>::NDValue(efd::IntVal val) : Node(K_LIT_INT), mVal(val) {
+efd::NDValue<efd::IntVal>::NDValue(efd::IntVal val)
+    : Node(K_LIT_INT), mVal(std::move(val)), mSymbol(0) {
 }
 
 template <> 
@@ -140,7 +152,8 @@ void efd::NDValue<efd::IntVal>::apply(NodeVisitor::Ref visitor) {
 
 // -------------- Value<efd::RealVal> -----------------
 template <> 
-efd::NDValue<efd::RealVal>::NDValue(efd::RealVal val) : Node(K_LIT_REAL), mVal(val) {
+efd::NDValue<efd::RealVal>::NDValue(efd::RealVal val)
+    : Node(K_LIT_REAL), mVal(std::move(val)), mSymbol(0) {
 }
 
 template <> 
@@ -155,7 +168,24 @@ void efd::NDValue<efd::RealVal>::apply(NodeVisitor::Ref visitor) {
 
 // -------------- Value<std::string> -----------------
 template <> 
-efd::NDValue<std::string>::NDValue(std::string val) : Node(K_LIT_STRING), mVal(val) {
+efd::NDValue<std::string>::NDValue(std::string val) : Node(K_LIT_STRING), mVal(std::move(val)) {
+    mSymbol = StringInterner::Intern(mVal);
+}
+
+template <> 
+efd::NDValue<std::string>::NDValue(std::string val, StringInterner::Symbol sym)
+    : Node(K_LIT_STRING), mVal(std::move(val)), mSymbol(sym) {
+}
+
+template <> 
+efd::Node::uRef efd::NDValue<std::string>::cloneImpl() const {
+    // The symbol is already known, so there is no need to intern it again.
+    return Node::uRef(new NDValue<std::string>(mVal, mSymbol));
+}
+
+template <> 
+efd::StringInterner::Symbol efd::NDValue<std::string>::getSymbol() const {
+    return mSymbol;
 }
 
 template <> 
@@ -277,9 +307,49 @@ efd::NDRegDecl::uRef efd::NDRegDecl::CreateC(NDId::uRef idNode, NDInt::uRef size
 }
 
 // -------------- ID reference Operation -----------------
+efd::XbitKey efd::GetXbitKey(Node::Ref node) {
+    if (auto idref = dynCast<NDIdRef>(node)) {
+        return idref->getKey();
+    }
+
+    auto id = dynCast<NDId>(node);
+    EfdAbortIf(id == nullptr, "Node is not a bit reference: `" << node->toString(false) << "`.");
+    return MakeXbitKey(id->getSymbol());
+}
+
+efd::XbitKey efd::GetXbitKey(const std::string& id) {
+    auto open = id.find('[');
+    auto indexStr = (open == std::string::npos || id.back() != ']') ?
+        std::string() : id.substr(open + 1, id.size() - open - 2);
+
+    if (indexStr.empty() ||
+        indexStr.find_first_not_of("0123456789") != std::string::npos) {
+        return MakeXbitKey(StringInterner::Intern(id));
+    }
+
+    return MakeXbitKey(StringInterner::Intern(id.substr(0, open)), std::stoull(indexStr));
+}
+
 efd::NDIdRef::NDIdRef(NDId::uRef idNode, NDInt::uRef nNode) : Node(K_ID_REF) {
     innerAddChild(std::move(idNode));
     innerAddChild(std::move(nNode));
+    updateKey();
+}
+
+void efd::NDIdRef::updateKey() {
+    mKey = MakeXbitKey(getId()->getSymbol(), getN()->getVal().mV);
+}
+
+efd::StringInterner::Symbol efd::NDIdRef::getIdSymbol() const {
+    return mKey >> 32;
+}
+
+uint32_t efd::NDIdRef::getIndex() const {
+    return mKey & 0xFFFFFFFF;
+}
+
+efd::XbitKey efd::NDIdRef::getKey() const {
+    return mKey;
 }
 
 efd::Node::uRef efd::NDIdRef::cloneImpl() const {
@@ -294,6 +364,7 @@ efd::NDId::Ref efd::NDIdRef::getId() const {
 
 void efd::NDIdRef::setId(NDId::uRef ref) {
     setChild(I_ID, std::move(ref));
+    updateKey();
 }
 
 efd::NDInt::Ref efd::NDIdRef::getN() const {
@@ -302,6 +373,7 @@ efd::NDInt::Ref efd::NDIdRef::getN() const {
 
 void efd::NDIdRef::setN(NDInt::uRef ref) {
     setChild(I_N, std::move(ref));
+    updateKey();
 }
 
 uint32_t efd::NDIdRef::getChildNumber() const {
@@ -337,6 +409,7 @@ efd::NDList::~NDList() {
 }
 
 void efd::NDList::cloneChildrem(const NDList* list) {
+    mChild.reserve(list->mChild.size());
     for (auto& child : *list)
         addChild(child->clone());
 }
@@ -7,9 +7,22 @@
     #include "enfield/Support/RTTI.h"
     #include "enfield/Support/Defs.h"
     #include "enfield/Support/CommandLine.h"
+    #include "enfield/Support/MappedFile.h"
+    #include "enfield/Support/Timer.h"
 
     namespace efd {
         class EfdScanner;
+
+        /// \brief Text of a token, pointing into the buffer being scanned.
+        ///
+        /// The buffer outlives the parse. So, the text is only copied once
+        /// the node that holds it is built.
+        struct TokenText {
+            const char* mPtr;
+            uint32_t mLen;
+
+            std::string str() const { return std::string(mPtr, mLen); }
+        };
     };
 }
 
@@ -18,54 +31,49 @@
     #include <sstream>
 
     extern efd::Opt<std::vector<std::string>> IncludePath;
-    extern std::unordered_map<std::string, std::string> StdLib;
+    extern const std::unordered_map<std::string, std::string> StdLib;
+
+    /// \brief Accounts \p bytes of input parsed in \p seconds.
+    void RecordParse(uint64_t bytes, double seconds);
 }
 
 %code provides {
-    #if ! defined(yyFlexLexerOnce)
-    #include <FlexLexer.h>
-    #endif
-
     #define YYDEBUG 1
 
     #include <cstdio>
     #include <cstring>
     #include <cerrno>
 
-    /* Size of default input buffer. */
-    #ifndef YY_BUF_SIZE
-    #ifdef __ia64__
-    /* On IA-64, the buffer size is 16k, not 8k.
-     * Moreover, YY_BUF_SIZE is 2*YY_READ_BUF_SIZE in the general case.
-     * Ditto for the __ia64__ case accordingly.
-     */
-    #define YY_BUF_SIZE 32768
-    #else
-    #define YY_BUF_SIZE 16384
-    #endif /* __ia64__ */
-    #endif
-
     #include <iostream>
     #include <fstream>
+    #include <iterator>
 
     namespace efd {
-        class EfdScanner : public yyFlexLexer {
+        /// \brief Reentrant flex scanner (see Scanner.l), that scans a buffer
+        /// in place.
+        class EfdScanner {
+            private:
+                // The flex `yyscan_t`.
+                void* mScanner;
+
             public:
-                EfdScanner(std::istream* iStream, std::ostream* oStream);
+                /// \brief Location of the current token, in the file being parsed.
+                yy::location mLoc;
+
+                /// \brief Scans the \p size bytes at \p buffer, which must be
+                /// followed by \em MappedFile::Padding zero bytes.
+                EfdScanner(char* buffer, uint64_t size, ASTWrapper& ast);
+                ~EfdScanner();
+
+                EfdScanner(const EfdScanner&) = delete;
+                EfdScanner& operator=(const EfdScanner&) = delete;
+
                 yy::EfdParser::symbol_type lex();
         };
     }
-
-    #undef YY_DECL
-    #define YY_DECL \
-        efd::yy::EfdParser::symbol_type efd::EfdScanner::lex()
 }
 
 %code {
-    efd::EfdScanner::EfdScanner(std::istream* iStream, std::ostream* oStream)
-       : yyFlexLexer(iStream, oStream) {
-    }
-
     void efd::yy::EfdParser::error(efd::yy::location const& loc, std::string const& err) {
         std::string filename = "unknown";
         if (loc.begin.filename) filename = *loc.begin.filename;
@@ -126,10 +134,10 @@
 %token COMMA    ","
 %token SEMICOL  ";"
 
-%token <efd::IntVal> INT;
-%token <efd::RealVal> REAL;
-%token <std::string> ID;
-%token <std::string> STRING;
+%token <efd::TokenText> INT;
+%token <efd::TokenText> REAL;
+%token <efd::TokenText> ID;
+%token <efd::TokenText> STRING;
 
 %token EOF 0 "end of file";
 
@@ -188,42 +196,48 @@ statement: decl         { $$ = $1; }
          ;
 
 include: INCLUDE string ";"     {
-                                    std::istream* istr = nullptr;
-                                    std::ifstream ifs;
-                                    std::istringstream iss;
+                                    char* buffer = nullptr;
+                                    efd::MappedFile::uRef mapped;
+                                    std::string contents;
                                     efd::ASTWrapper _ast;
 
                                     std::string file = efd::dynCast<efd::NDString>($2)->getVal();
+                                    uint64_t bytes = 0;
 
                                     if (StdLib.find(file) != StdLib.end()) {
-                                        _ast = efd::ASTWrapper { file, "./", nullptr, false };
-                                        iss.str(StdLib[file]);
-                                        istr = &iss;
+                                        _ast = efd::ASTWrapper { file, "./", nullptr, false, ast.mIncludePath, 0 };
+                                        // It is shared among parses, so it is scanned from a copy.
+                                        contents = StdLib.at(file);
+                                        bytes = contents.size();
+                                        contents.append(efd::MappedFile::Padding, '\0');
+                                        buffer = &contents[0];
                                         ast.mStdLibParsed = true;
                                     } else {
-                                        std::vector<std::string> includePaths = IncludePath.getVal();
+                                        std::vector<std::string> includePaths = ast.mIncludePath;
                                         includePaths.push_back(ast.mPath);
 
                                         for (auto path : includePaths) {
-                                            _ast = efd::ASTWrapper { file, path, nullptr, false };
-                                            ifs.open((_ast.mPath + _ast.mFile).c_str());
-                                            if (!ifs.fail()) {
-                                                istr = &ifs;
+                                            _ast = efd::ASTWrapper { file, path, nullptr, false, ast.mIncludePath, 0 };
+                                            mapped = efd::MappedFile::Open(_ast.mPath + _ast.mFile);
+                                            if (mapped.get() != nullptr) {
+                                                buffer = mapped->data();
+                                                bytes = mapped->size();
                                                 break;
                                             }
                                         }
                                     }
 
-                                    if (istr == nullptr) {
+                                    if (buffer == nullptr) {
                                         error(@$, "Could not open file: " + _ast.mPath + _ast.mFile);
                                         error(@$, "Error: " + std::string(strerror(errno)));
                                         return 1;
                                     }
 
-                                    efd::yy::EfdParser parser(_ast, scanner);
-                                    scanner.yypush_buffer_state(scanner.yy_create_buffer(istr, YY_BUF_SIZE));
+                                    // The included file has its own scanner (and locations).
+                                    efd::EfdScanner _scanner(buffer, bytes, _ast);
+                                    efd::yy::EfdParser parser(_ast, _scanner);
                                     if (parser.parse()) return 1;
-                                    scanner.yypop_buffer_state();
+                                    ast.mIncludedBytes += bytes + _ast.mIncludedBytes;
 
                                     $$ = efd::NDInclude::Create(efd::NDString::uRef($2), efd::Node::uRef(_ast.mAST)).release();
                                 }
@@ -380,21 +394,22 @@ idref: id "[" integer "]"   {
                             }
      ;
 
-id: ID { $$ = efd::NDId::Create($1).release(); }
+id: ID { $$ = efd::NDId::Create($1.str()).release(); }
   ;
 
-integer: INT { $$ = efd::NDInt::Create($1).release(); }
+integer: INT { $$ = efd::NDInt::Create(efd::IntVal($1.str())).release(); }
        ;
 
-string: STRING { $$ = efd::NDString::Create($1.substr(1, $1.length() - 2)).release(); }
+string: STRING { $$ = efd::NDString::Create(std::string($1.mPtr + 1, $1.mLen - 2)).release(); }
 
-real: REAL { $$ = efd::NDReal::Create($1).release(); }
+real: REAL { $$ = efd::NDReal::Create(efd::RealVal($1.str())).release(); }
     ;
 
 %%
 
-static int Parse(std::istream& istr, efd::ASTWrapper& ast, bool forceStdLib) {
-    efd::EfdScanner scanner(&istr, nullptr);
+// Parses the \p size bytes at \p buffer (followed by `MappedFile::Padding` zeros).
+static int Parse(char* buffer, uint64_t size, efd::ASTWrapper& ast, bool forceStdLib) {
+    efd::EfdScanner scanner(buffer, size, ast);
     efd::yy::EfdParser parser(ast, scanner);
 
     int ret = parser.parse();
@@ -412,7 +427,8 @@ static int Parse(std::istream& istr, efd::ASTWrapper& ast, bool forceStdLib) {
             EfdAbortIf(true, "AST Root node is neither a `NDQasmVersion` nor a `NDStmtList`.");
         }
 
-        for (auto pair : StdLib) {
+        for (const auto& pair : StdLib) {
+            ast.mIncludedBytes += pair.second.size();
             auto refInclude = efd::NDInclude::Create
                 (efd::NDString::Create(pair.first), efd::ParseString(pair.second, false));
             auto inclNode = efd::Node::uRef(refInclude.release());
@@ -426,28 +442,59 @@ static int Parse(std::istream& istr, efd::ASTWrapper& ast, bool forceStdLib) {
 }
 
 efd::Node::uRef efd::ParseFile(std::string filename, std::string path, bool forceStdLib) {
-    ASTWrapper ast { filename, path, nullptr, false };
+    ASTWrapper ast { filename, path, nullptr, false, IncludePath.getVal(), 0 };
+
+    efd::Timer timer;
+    timer.start();
+
+    // Regular files are scanned in place, where they are mapped. The others
+    // (e.g.: pipes) can't be mapped, so they are read whole, and scanned from
+    // memory as well. Either way, the bytes and the time accounted are those
+    // of the same work.
+    char* buffer = nullptr;
+    std::string contents;
+    uint64_t bytes = 0;
+
+    auto mapped = efd::MappedFile::Open(ast.mPath + ast.mFile);
+
+    if (mapped.get() != nullptr) {
+        buffer = mapped->data();
+        bytes = mapped->size();
+    } else if (errno == ENODEV) {
+        std::ifstream ifs((ast.mPath + ast.mFile).c_str());
+
+        if (!ifs.fail()) {
+            contents.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+            bytes = contents.size();
+            contents.append(efd::MappedFile::Padding, '\0');
+            buffer = &contents[0];
+        }
+    }
 
-    std::ifstream ifs((ast.mPath + ast.mFile).c_str());
-    if (ifs.fail()) {
+    if (buffer == nullptr) {
         std::cerr << "Could not open file: " << ast.mPath + ast.mFile << std::endl;
         std::cerr << "Error: " << strerror(errno) << std::endl;
         return nullptr;
     }
 
-    if (Parse(ifs, ast, forceStdLib)) return efd::Node::uRef(nullptr);
+    if (Parse(buffer, bytes, ast, forceStdLib)) return efd::Node::uRef(nullptr);
+
+    timer.stop();
+    RecordParse(bytes + ast.mIncludedBytes, (double) timer.getNanoseconds() / 1000000000.0);
 
-    ifs.close();
     return efd::Node::uRef(ast.mAST);
 }
 
-efd::Node::uRef efd::ParseString(std::string program, bool forceStdLib) {
+efd::Node::uRef efd::ParseString(const std::string& program, bool forceStdLib) {
     std::string filename = "qasm-" + std::to_string((uint64_t) &program) + ".qasm";
     std::string path =  "./";
-    std::stringstream ss(program);
 
-    ASTWrapper ast { filename, path, nullptr, false };
-    int ret = Parse(ss, ast, forceStdLib);
+    // The scanner writes into (and needs the padding after) the buffer.
+    std::string contents = program;
+    contents.append(efd::MappedFile::Padding, '\0');
+
+    ASTWrapper ast { filename, path, nullptr, false, IncludePath.getVal(), 0 };
+    int ret = Parse(&contents[0], program.size(), ast, forceStdLib);
 
     if (ret) return efd::Node::uRef(nullptr);
     return efd::Node::uRef(ast.mAST);
@@ -1,5 +1,8 @@
+#include "enfield/Analysis/Driver.h"
 #include "enfield/Support/CommandLine.h"
+#include "enfield/Support/Stats.h"
 
+#include <mutex>
 #include <unordered_map>
 
 static std::string Qelib1 =
@@ -11,6 +14,29 @@ static std::string Qelib1 =
 efd::Opt<std::vector<std::string>> IncludePath
     ("I", "The include path.", std::vector<std::string>(), false);
 
-std::unordered_map<std::string, std::string> StdLib = {
+// It is only read while parsing, so that many parses may share it.
+extern const std::unordered_map<std::string, std::string> StdLib;
+const std::unordered_map<std::string, std::string> StdLib = {
     { "qelib1.inc", Qelib1 }
 };
+
+efd::Stat<uint64_t> efd::ParsedBytes
+("ParsedBytes", "Number of bytes of the input files parsed (with the files they include).");
+static efd::Stat<double> ParseTime
+("ParseTime", "Time spent parsing the input files (in seconds).");
+static efd::Stat<double> ParseThroughput
+("ParseThroughput", "Parsing throughput of the input files (in MB/s).");
+
+// Parses may run in different threads.
+static std::mutex ParseStatsMutex;
+
+void RecordParse(uint64_t bytes, double seconds) {
+    std::lock_guard<std::mutex> lock(ParseStatsMutex);
+
+    efd::ParsedBytes += bytes;
+    ParseTime += seconds;
+
+    if (ParseTime.getVal() > 0) {
+        ParseThroughput = (double) efd::ParsedBytes.getVal() / ParseTime.getVal() / 1000000.0;
+    }
+}
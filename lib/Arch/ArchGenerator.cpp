@@ -0,0 +1,230 @@
+#include "enfield/Arch/ArchGenerator.h"
+#include "enfield/Analysis/Nodes.h"
+#include "enfield/Support/CommandLine.h"
+#include "enfield/Support/Defs.h"
+#include "enfield/Support/uRefCast.h"
+
+#include <limits>
+#include <map>
+#include <random>
+
+using namespace efd;
+
+Opt<double> efd::ArchMaxError
+("-arch-max-error", "Maximum probability of error of each coupling of the \
+parametric architectures (e.g.: `grid-8x8`). By default, they have no errors.", 0, false);
+Opt<uint32_t> efd::ArchErrorSeed
+("-arch-error-seed", "Seed for the random errors of the parametric architectures.", 0, false);
+
+namespace {
+    struct ArchGeneratorEntry {
+        uint32_t mMinDims;
+        uint32_t mMaxDims;
+        ArchGeneratorFn mFn;
+    };
+
+    typedef std::map<std::string, ArchGeneratorEntry> ArchGeneratorMap;
+
+    /// \brief Creates an architecture with \p n qubits, in a register `q`.
+    ArchGraph::uRef CreateWithQubits(uint32_t n) {
+        auto graph = ArchGraph::Create(n);
+        graph->putReg("q", std::to_string(n));
+
+        auto idNode = NDId::Create("q");
+        for (uint32_t i = 0; i < n; ++i) {
+            auto clone = uniqueCastForward<NDId>(idNode->clone());
+            graph->putVertex(NDIdRef::Create(NDId::uRef(std::move(clone)),
+                                             NDInt::Create(std::to_string(i))));
+        }
+
+        return graph;
+    }
+
+    void PutCoupling(ArchGraph::Ref graph, uint32_t u, uint32_t v) {
+        graph->putEdge(u, v, 1);
+        graph->putEdge(v, u, 1);
+    }
+
+    void CheckDims(const std::string& kind, const std::vector<uint32_t>& dims) {
+        for (uint32_t d : dims) {
+            EfdAbortIf(d == 0, "Architecture `" << kind << "` with a 0 dimension.");
+        }
+    }
+
+    /// \brief Returns \p n, the number of qubits of an architecture \p kind,
+    /// aborting if it does not fit the 32-bit qubit indices.
+    uint32_t CheckQubits(const std::string& kind, uint64_t n) {
+        EfdAbortIf(n > std::numeric_limits<uint32_t>::max(),
+                   "Architecture `" << kind << "` has too many qubits: `" << n << "`.");
+        return n;
+    }
+
+    ArchGraph::uRef CreateGrid(const std::vector<uint32_t>& dims) {
+        CheckDims("grid", dims);
+        uint32_t rows = dims[0], cols = dims[1];
+        auto graph = CreateWithQubits(CheckQubits("grid", (uint64_t) rows * cols));
+
+        for (uint32_t i = 0; i < rows; ++i) {
+            for (uint32_t j = 0; j < cols; ++j) {
+                uint32_t u = i * cols + j;
+                if (j + 1 < cols) PutCoupling(graph.get(), u, u + 1);
+                if (i + 1 < rows) PutCoupling(graph.get(), u, u + cols);
+            }
+        }
+
+        return graph;
+    }
+
+    ArchGraph::uRef CreateHeavyHex(const std::vector<uint32_t>& dims) {
+        CheckDims("heavyhex", dims);
+        uint32_t rows = dims[0], cells = dims[1];
+        uint64_t width64 = 4 * (uint64_t) cells + 3, bridges64 = (uint64_t) cells + 1;
+        uint32_t qubits = CheckQubits("heavyhex", rows * width64 + (rows - 1) * bridges64);
+        // Both fit, since there are at least as many qubits.
+        uint32_t width = width64, bridges = bridges64;
+        auto graph = CreateWithQubits(qubits);
+
+        // Each row is followed by the bridges to the next one. The bridges
+        // start at column 0 for even rows, and at column 2 for odd rows.
+        for (uint32_t i = 0; i < rows; ++i) {
+            uint32_t rowBegin = i * (width + bridges);
+
+            for (uint32_t j = 0; j + 1 < width; ++j) {
+                PutCoupling(graph.get(), rowBegin + j, rowBegin + j + 1);
+            }
+
+            if (i + 1 == rows) continue;
+
+            uint32_t bridgeBegin = rowBegin + width;
+            uint32_t nextRowBegin = bridgeBegin + bridges;
+            uint32_t offset = (i % 2 == 0) ? 0 : 2;
+
+            for (uint32_t b = 0; b < bridges; ++b) {
+                uint32_t col = offset + 4 * b;
+                PutCoupling(graph.get(), rowBegin + col, bridgeBegin + b);
+                PutCoupling(graph.get(), bridgeBegin + b, nextRowBegin + col);
+            }
+        }
+
+        return graph;
+    }
+
+    ArchGraph::uRef CreateRing(const std::vector<uint32_t>& dims) {
+        CheckDims("ring", dims);
+        uint32_t n = dims[0];
+        auto graph = CreateWithQubits(n);
+
+        for (uint32_t i = 0; i < n; ++i) {
+            uint32_t next = (i + 1) % n;
+            if (next != i) PutCoupling(graph.get(), i, next);
+        }
+
+        return graph;
+    }
+
+    ArchGraph::uRef CreateTree(const std::vector<uint32_t>& dims) {
+        CheckDims("tree", dims);
+        uint32_t n = dims[0], arity = dims.size() > 1 ? dims[1] : 2;
+        auto graph = CreateWithQubits(n);
+
+        for (uint32_t i = 1; i < n; ++i) {
+            PutCoupling(graph.get(), (i - 1) / arity, i);
+        }
+
+        return graph;
+    }
+
+    ArchGraph::uRef CreateAllToAll(const std::vector<uint32_t>& dims) {
+        CheckDims("alltoall", dims);
+        uint32_t n = dims[0];
+        auto graph = CreateWithQubits(n);
+
+        for (uint32_t i = 0; i < n; ++i) {
+            for (uint32_t j = i + 1; j < n; ++j) {
+                PutCoupling(graph.get(), i, j);
+            }
+        }
+
+        return graph;
+    }
+
+    ArchGeneratorMap& GetGenerators() {
+        static ArchGeneratorMap Generators {
+            { "grid", { 2, 2, CreateGrid } },
+            { "heavyhex", { 2, 2, CreateHeavyHex } },
+            { "ring", { 1, 1, CreateRing } },
+            { "tree", { 1, 2, CreateTree } },
+            { "alltoall", { 1, 1, CreateAllToAll } },
+        };
+        return Generators;
+    }
+
+    /// \brief Splits \p name into its kind and its dimensions. Returns false
+    /// if it is not of the form `<kind>-<dims>`.
+    bool ParseName(const std::string& name, std::string& kind, std::vector<uint32_t>& dims) {
+        auto dash = name.find('-');
+        if (dash == std::string::npos) return false;
+
+        kind = name.substr(0, dash);
+        dims.clear();
+
+        std::string number;
+        for (uint32_t i = dash + 1, e = name.size(); i <= e; ++i) {
+            if (i == e || name[i] == 'x') {
+                // Up to 9 digits, so that it fits in 32 bits.
+                if (number.empty() || number.size() > 9) return false;
+                dims.push_back(std::stoul(number));
+                number.clear();
+            } else if (name[i] >= '0' && name[i] <= '9') {
+                number += name[i];
+            } else {
+                return false;
+            }
+        }
+
+        auto it = GetGenerators().find(kind);
+        return it != GetGenerators().end() &&
+            dims.size() >= it->second.mMinDims &&
+            dims.size() <= it->second.mMaxDims;
+    }
+}
+
+bool efd::IsParametricArchitecture(const std::string& name) {
+    std::string kind;
+    std::vector<uint32_t> dims;
+    return ParseName(name, kind, dims);
+}
+
+ArchGraph::uRef efd::CreateParametricArchitecture(const std::string& name) {
+    std::string kind;
+    std::vector<uint32_t> dims;
+    EfdAbortIf(!ParseName(name, kind, dims), "No such parametric architecture: `"
+               << name << "`.");
+
+    auto graph = GetGenerators()[kind].mFn(dims);
+
+    if (ArchMaxError.getVal() > 0) {
+        std::mt19937 gen(ArchErrorSeed.getVal());
+        std::uniform_real_distribution<double> error(0, ArchMaxError.getVal());
+
+        // Both directions of a coupling have the same error.
+        for (uint32_t u = 0, e = graph->size(); u < e; ++u) {
+            for (uint32_t v : graph->succ(u)) {
+                if (v < u) continue;
+                double w = 1 - error(gen);
+                graph->setW(u, v, w);
+                graph->setW(v, u, w);
+            }
+        }
+    }
+
+    graph->freeze();
+    return graph;
+}
+
+void efd::RegisterArchGenerator(const std::string& kind, uint32_t minDims, uint32_t maxDims,
+                                ArchGeneratorFn fn) {
+    EfdAbortIf(kind.empty() || kind.find('-') != std::string::npos,
+               "Invalid architecture generator name: `" << kind << "`.");
+    GetGenerators()[kind] = { minDims, maxDims, fn };
+}
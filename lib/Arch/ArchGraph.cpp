@@ -2,6 +2,7 @@
 #include "enfield/Analysis/Nodes.h"
 #include "enfield/Support/RTTI.h"
 #include "enfield/Support/Defs.h"
+#include "enfield/Support/DistanceTable.h"
 #include "enfield/Support/uRefCast.h"
 
 #include <fstream>
@@ -46,6 +47,7 @@ uint32_t ArchGraph::putVertex(std::string s) {
     uint32_t id = mVID++;
     mId[id] = s;
     mStrToId[s] = id;
+    mKeyToId[GetXbitKey(s)] = id;
     return id;
 }
 
@@ -73,6 +75,17 @@ bool ArchGraph::hasSId(std::string s) const {
     return mStrToId.find(s) != mStrToId.end();
 }
 
+uint32_t ArchGraph::getUId(Node::Ref node) const {
+    auto it = mKeyToId.find(GetXbitKey(node));
+    EfdAbortIf(it == mKeyToId.end(),
+               "No such vertex with this id: `" << node->toString(false) << "`.");
+    return it->second;
+}
+
+bool ArchGraph::hasNode(Node::Ref node) const {
+    return mKeyToId.find(GetXbitKey(node)) != mKeyToId.end();
+}
+
 std::string ArchGraph::getSId(uint32_t i) {
     EfdAbortIf(i >= mId.size(),
                "Vertex index out of bounds (of `" << mId.size() << "`): `" << i << "`.");
@@ -91,6 +104,43 @@ ArchGraph::RegsIterator ArchGraph::reg_end() {
     return mRegs.end();
 }
 
+Json::Value ArchGraph::toJson() {
+    Json::Value root;
+    root[JsonFields<ArchGraph>::_QubitsLabel_] = size();
+
+    Json::Value registers(Json::arrayValue);
+    for (const auto& reg : mRegs) {
+        Json::Value jReg;
+        jReg[JsonFields<ArchGraph>::_NameLabel_] = reg.first;
+        jReg[JsonFields<ArchGraph>::_QubitsLabel_] = reg.second;
+        registers.append(jReg);
+    }
+
+    Json::Value adj(Json::arrayValue);
+    for (uint32_t i = 0, e = size(); i < e; ++i) {
+        Json::Value iList(Json::arrayValue);
+
+        for (uint32_t j : succ(i)) {
+            Json::Value jElem;
+            jElem[JsonFields<ArchGraph>::_VLabel_] = mId[j];
+
+            // We keep the probability of success, but the json has the
+            // probability of error.
+            if (getW(i, j) != 1) {
+                jElem[JsonFields<ArchGraph>::_WeightLabel_] = 1 - getW(i, j);
+            }
+
+            iList.append(jElem);
+        }
+
+        adj.append(iList);
+    }
+
+    root[JsonFields<ArchGraph>::_RegistersLabel_] = registers;
+    root[JsonFields<ArchGraph>::_AdjListLabel_] = adj;
+    return root;
+}
+
 bool ArchGraph::ClassOf(const Graph* g) {
     return g->isArch();
 }
@@ -108,9 +158,11 @@ const std::string JsonFields<ArchGraph>::_VLabel_ = "v";
 const std::string JsonFields<ArchGraph>::_WeightLabel_ = "w";
 const std::string JsonFields<ArchGraph>::_RegLabel_ = "reg";
 const std::string JsonFields<ArchGraph>::_IdLabel_ = "id";
+const std::string JsonFields<ArchGraph>::_DistancesLabel_ = "distances";
 
 // ----------------------------- JsonBackendParser -------------------------------
-std::unique_ptr<ArchGraph> JsonBackendParser<ArchGraph>::Parse(const Json::Value& root) {
+std::unique_ptr<ArchGraph> JsonBackendParser<ArchGraph>::Parse(const Json::Value& root,
+                                                               const std::string& dir) {
     typedef Json::ValueType Ty;
     const std::string _ArchGraphErrorPrefix_ = "ArchGraph parsing error";
 
@@ -186,5 +238,46 @@ std::unique_ptr<ArchGraph> JsonBackendParser<ArchGraph>::Parse(const Json::Value
         }
     }
 
+    graph->freeze();
+
+    if (root.isMember(JsonFields<ArchGraph>::_DistancesLabel_)) {
+        JsonCheckTypeError(_ArchGraphErrorPrefix_, root,
+                           JsonFields<ArchGraph>::_DistancesLabel_,
+                           { Ty::objectValue });
+
+        auto &distances = root[JsonFields<ArchGraph>::_DistancesLabel_];
+        DistanceTable::uRef table;
+
+        if (distances.isMember(JsonFields<DistanceTable>::_FileLabel_)) {
+            JsonCheckTypeError(_ArchGraphErrorPrefix_, distances,
+                               JsonFields<DistanceTable>::_FileLabel_,
+                               { Ty::stringValue });
+            auto file = distances[JsonFields<DistanceTable>::_FileLabel_].asString();
+            if (!dir.empty() && !file.empty() && file[0] != '/') file = dir + "/" + file;
+
+            table = DistanceTable::LoadBinary(graph.get(), file,
+                                              DistanceTable::ChecksumFromJson(distances));
+        } else {
+            table = DistanceTable::FromJson(graph.get(), distances);
+        }
+
+        // If it is not valid, it will be built on demand.
+        if (table.get() != nullptr) {
+            graph->setDistanceTable(std::move(table));
+        }
+    }
+
     return graph;
 }
+
+// ----------------------------- JsonParser -------------------------------
+template <>
+std::unique_ptr<ArchGraph> efd::JsonParser<ArchGraph>::ParseFile(std::string filename) {
+    std::ifstream ifs(filename.c_str());
+    Json::Value root;
+    ifs >> root;
+
+    auto slash = filename.find_last_of('/');
+    auto dir = (slash == std::string::npos) ? "" : filename.substr(0, std::max<size_t>(slash, 1));
+    return JsonBackendParser<ArchGraph>::Parse(root, dir);
+}
@@ -1,7 +1,10 @@
 #include "enfield/Arch/Architectures.h"
+#include "enfield/Arch/ArchGenerator.h"
+#include "enfield/Arch/ArchTables.gen.h"
 #include "enfield/Analysis/Nodes.h"
-#include "enfield/Support/JsonParser.h"
+#include "enfield/Support/DistanceTable.h"
 #include "enfield/Support/RTTI.h"
+#include "enfield/Support/uRefCast.h"
 
 namespace efd {
     typedef std::shared_ptr<ArchRegistry> ArchRegistryPtr;
@@ -15,13 +18,48 @@ namespace efd {
         "last"
     };
 
+    /// \brief Builds an architecture from the tables generated at build time
+    /// (see `GenArchTables.cpp`). It is the same graph the json parser builds,
+    /// with its distance table already set.
+    static ArchRegistry::RetTy CreateArchFromTables(uint32_t qubits,
+                                                    uint32_t regs,
+                                                    const char* const* regNames,
+                                                    const uint32_t* regSizes,
+                                                    uint32_t edges,
+                                                    const uint32_t* edgeFrom,
+                                                    const uint32_t* edgeTo,
+                                                    const double* edgeW,
+                                                    const uint32_t* distances) {
+        auto graph = ArchGraph::Create(qubits);
+
+        for (uint32_t i = 0; i < regs; ++i) {
+            graph->putReg(regNames[i], std::to_string(regSizes[i]));
+
+            auto idNode = NDId::Create(regNames[i]);
+            for (uint32_t j = 0; j < regSizes[i]; ++j) {
+                auto clone = uniqueCastForward<NDId>(idNode->clone());
+                graph->putVertex(NDIdRef::Create(NDId::uRef(std::move(clone)),
+                                                 NDInt::Create(std::to_string(j))));
+            }
+        }
+
+        for (uint32_t i = 0; i < edges; ++i) {
+            graph->putEdge(edgeFrom[i], edgeTo[i], 1);
+            graph->setW(edgeFrom[i], edgeTo[i], edgeW[i]);
+        }
+
+        graph->freeze();
+        graph->setDistanceTable(DistanceTable::CreateView(qubits, distances));
+        return graph;
+    }
+
 // Creating functions for each architecture, so that it
 // will get the following signature: (int) -> ArchGraph*
 #define EFD_ARCH(_Name_, _Json_) \
     ArchRegistry::RetTy CreateArch_##_Name_(int pad) {\
-        auto json = std::string(#_Json_);\
-        auto arch = JsonParser<ArchGraph>::ParseString(json.substr(1, json.length() - 2));\
-        return ArchRegistry::RetTy(arch.release());\
+        using namespace archtables::_Name_;\
+        return CreateArchFromTables(Qubits, Regs, RegNames, RegSizes,\
+                                    Edges, EdgeFrom, EdgeTo, EdgeW, Distances);\
     }
 #include "enfield/Arch/Architectures.def"
 #undef EFD_ARCH
@@ -50,3 +88,18 @@ void efd::RegisterArchitecture(EnumArchitecture key, ArchRegistry::CtorTy ctor)
 efd::ArchRegistry::RetTy efd::CreateArchitecture(EnumArchitecture key) {
     return GetRegistry()->createObj(key, 0);
 }
+
+bool efd::IsArchitectureName(const std::string& name) {
+    return (EnumArchitecture::Has(name) && HasArchitecture(EnumArchitecture(name))) ||
+        IsParametricArchitecture(name);
+}
+
+efd::ArchGraph::uRef efd::CreateArchitectureFromName(const std::string& name) {
+    EfdAbortIf(!IsArchitectureName(name), "No such architecture: `" << name << "`.");
+
+    if (EnumArchitecture::Has(name)) {
+        return CreateArchitecture(EnumArchitecture(name));
+    }
+
+    return CreateParametricArchitecture(name);
+}
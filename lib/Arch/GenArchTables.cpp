@@ -0,0 +1,156 @@
+// Build-time generator of the tables of the architectures in `Architectures.def`.
+//
+// It parses each architecture's json once, here, and prints a header with
+// its registers, its edges (with their final weights) and its distance table
+// as `constexpr` arrays. `Architectures.cpp` builds the `ArchGraph`s from
+// those arrays, so that no json is parsed and no BFS is run at startup.
+
+#include "enfield/Support/DistanceTable.h"
+#include "enfield/Support/Defs.h"
+
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <unordered_map>
+
+using namespace efd;
+
+namespace {
+    struct ArchSource {
+        const char* mName;
+        const char* mJson;
+    };
+
+    const ArchSource _Archs_[] = {
+#define EFD_ARCH(_Name_, _Json_) \
+        { #_Name_, #_Json_ },
+#include "enfield/Arch/Architectures.def"
+#undef EFD_ARCH
+    };
+
+    std::string DoubleToString(double d) {
+        char buf[64];
+        std::snprintf(buf, sizeof(buf), "%.17g", d);
+        return buf;
+    }
+
+    template <typename T, typename F>
+    void PrintArray(std::ostream& out, const std::string& ty, const std::string& name,
+                    const std::vector<T>& values, F toString) {
+        out << "    constexpr " << ty << " " << name << "[] = {";
+
+        // Zero-sized arrays are not allowed.
+        if (values.empty()) out << " " << toString(T());
+
+        for (uint32_t i = 0, e = values.size(); i < e; ++i) {
+            if (i % 16 == 0) out << "\n       ";
+            out << " " << toString(values[i]) << ",";
+        }
+
+        out << "\n    };\n";
+    }
+
+    void PrintArch(std::ostream& out, const ArchSource& src) {
+        const std::string name = src.mName;
+        const std::string prefix = "Architecture `" + name + "`";
+
+        // The json is stringified with its surrounding parenthesis.
+        std::string json = src.mJson;
+        std::istringstream iss(json.substr(1, json.length() - 2));
+
+        Json::Value root;
+        iss >> root;
+
+        auto qubits = root["qubits"].asUInt();
+        auto& registers = root["registers"];
+        auto& adj = root["adj"];
+
+        std::vector<std::string> regNames;
+        std::vector<uint32_t> regSizes;
+        std::unordered_map<std::string, uint32_t> regOffset;
+
+        uint32_t total = 0;
+        for (uint32_t i = 0, e = registers.size(); i < e; ++i) {
+            auto regName = registers[i]["name"].asString();
+            regNames.push_back(regName);
+            regSizes.push_back(registers[i]["qubits"].asUInt());
+            regOffset[regName] = total;
+            total += regSizes.back();
+        }
+
+        EfdAbortIf(total != qubits, prefix << ": sum of qubits doesn't match the total.");
+        EfdAbortIf(adj.size() != qubits, prefix << ": `adj` should have one list per qubit.");
+
+        auto graph = Graph::Create(qubits, Graph::Directed);
+        std::vector<uint32_t> edgeFrom, edgeTo;
+        std::vector<double> edgeW;
+
+        for (uint32_t i = 0; i < qubits; ++i) {
+            for (uint32_t j = 0, f = adj[i].size(); j < f; ++j) {
+                auto& elem = adj[i][j];
+                auto v = elem["v"].asString();
+                auto bracket = v.find('[');
+
+                EfdAbortIf(bracket == std::string::npos ||
+                           regOffset.find(v.substr(0, bracket)) == regOffset.end(),
+                           prefix << ": no such qubit `" << v << "`.");
+
+                uint32_t k = regOffset[v.substr(0, bracket)] + std::stoul(v.substr(bracket + 1));
+                graph->putEdge(i, k);
+
+                // Same as the json parser: `w` is the probability of error, and
+                // we keep the probability of success.
+                edgeFrom.push_back(i);
+                edgeTo.push_back(k);
+                edgeW.push_back(elem.isMember("w") ? 1 - elem["w"].asDouble() : 1);
+            }
+        }
+
+        graph->freeze();
+        auto table = DistanceTable::Create(graph.get());
+
+        std::vector<uint32_t> distances;
+        for (uint32_t u = 0; u < qubits; ++u)
+            for (uint32_t v = 0; v < qubits; ++v)
+                distances.push_back(table->get(u, v));
+        for (uint32_t u = 0; u < qubits; ++u)
+            for (uint32_t v = 0; v < qubits; ++v)
+                distances.push_back(table->prev(u, v));
+
+        auto uintToString = [](uint32_t x) { return std::to_string(x) + "u"; };
+        auto strToString = [](const std::string& s) { return "\"" + s + "\""; };
+
+        out << "namespace " << name << " {\n";
+        out << "    constexpr uint32_t Qubits = " << qubits << ";\n";
+        out << "    constexpr uint32_t Regs = " << regNames.size() << ";\n";
+        out << "    constexpr uint32_t Edges = " << edgeFrom.size() << ";\n";
+        PrintArray(out, "const char*", "RegNames", regNames, strToString);
+        PrintArray(out, "uint32_t", "RegSizes", regSizes, uintToString);
+        PrintArray(out, "uint32_t", "EdgeFrom", edgeFrom, uintToString);
+        PrintArray(out, "uint32_t", "EdgeTo", edgeTo, uintToString);
+        PrintArray(out, "double", "EdgeW", edgeW, DoubleToString);
+        out << "    /// Distance matrix followed by the parent matrix (see DistanceTable).\n";
+        PrintArray(out, "uint32_t", "Distances", distances, uintToString);
+        out << "}\n\n";
+    }
+}
+
+int main(int argc, char** argv) {
+    std::ostream& out = std::cout;
+
+    out << "// Generated from `Architectures.def` by GenArchTables. Do not edit.\n";
+    out << "#ifndef __EFD_ARCH_TABLES_GEN_H__\n";
+    out << "#define __EFD_ARCH_TABLES_GEN_H__\n\n";
+    out << "#include <cstdint>\n\n";
+    out << "namespace efd {\n";
+    out << "namespace archtables {\n\n";
+
+    for (auto& src : _Archs_) {
+        PrintArch(out, src);
+    }
+
+    out << "}\n";
+    out << "}\n\n";
+    out << "#endif\n";
+    return 0;
+}
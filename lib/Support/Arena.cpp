@@ -0,0 +1,238 @@
+#include "enfield/Support/Arena.h"
+#include "enfield/Support/CommandLine.h"
+#include "enfield/Support/Stats.h"
+#include "enfield/Support/Defs.h"
+
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+
+using namespace efd;
+
+static Opt<uint32_t> ArenaCacheSize
+("-arena-cache", "Maximum size (in MB) of the chunks kept for reuse by new arenas.",
+ 64, false);
+
+static Stat<uint64_t> ArenaChunks
+("ArenaChunks", "Number of chunks requested by arenas.");
+static Stat<uint64_t> ArenaChunksReused
+("ArenaChunksReused", "Number of chunks requested by arenas that were reused.");
+static Stat<uint64_t> ArenaBytes
+("ArenaBytes", "Number of bytes requested by arenas.");
+
+// Arenas may be filled and released in different threads.
+static std::mutex ArenaChunksMutex;
+
+static thread_local Arena::Ref CurrentArena = nullptr;
+
+// Every block is preceded by the arena it came from (nullptr for the heap).
+// Blocks are only aligned as pointers (see ArenaAllocator).
+static const std::size_t HeaderSize = sizeof(void*);
+static const std::size_t Alignment = sizeof(void*);
+
+static const uint64_t FirstChunkSize = 64 * 1024;
+static const uint64_t MaxChunkSize = 4 * 1024 * 1024;
+// Only blocks up to this size (header included) are reused. Nodes and their
+// children vectors are a lot smaller.
+static const std::size_t MaxFreeBlockSize = 512;
+// Bigger blocks (e.g.: the children of a statement list) come from the heap,
+// so that they are released as soon as they are deallocated.
+static const std::size_t MaxArenaBlockSize = FirstChunkSize / 4;
+
+static std::size_t AlignUp(std::size_t size) {
+    return (size + Alignment - 1) & ~(Alignment - 1);
+}
+
+namespace {
+    // Chunks of released arenas, by size. Reusing them is a lot cheaper than
+    // faulting fresh pages in.
+    struct ChunkCache {
+        std::unordered_map<uint64_t, std::vector<char*>> mChunks;
+        uint64_t mSize = 0;
+    };
+}
+
+static ChunkCache& GetChunkCache() {
+    // Never destroyed, since arenas may be released by static destructors.
+    static ChunkCache* cache = new ChunkCache();
+    return *cache;
+}
+
+static char* AcquireChunk(uint64_t size) {
+    std::lock_guard<std::mutex> lock(ArenaChunksMutex);
+    auto& cache = GetChunkCache();
+    char* chunk = nullptr;
+
+    auto it = cache.mChunks.find(size);
+    if (it != cache.mChunks.end() && !it->second.empty()) {
+        chunk = it->second.back();
+        it->second.pop_back();
+        cache.mSize -= size;
+        ArenaChunksReused += 1;
+    } else {
+        chunk = static_cast<char*>(std::malloc(size));
+        if (chunk == nullptr) throw std::bad_alloc();
+    }
+
+    ArenaChunks += 1;
+    ArenaBytes += size;
+    return chunk;
+}
+
+static void ReleaseChunk(char* chunk, uint64_t size) {
+    std::lock_guard<std::mutex> lock(ArenaChunksMutex);
+    auto& cache = GetChunkCache();
+
+    if (cache.mSize + size <= (uint64_t) ArenaCacheSize.getVal() * 1024 * 1024) {
+        cache.mChunks[size].push_back(chunk);
+        cache.mSize += size;
+    } else {
+        std::free(chunk);
+    }
+}
+
+// ---------------------- Arena::Scope ----------------------
+Arena::Scope::Scope(const sRef& arena) : mArena(arena), mPrevious(CurrentArena) {
+    if (mArena.get() != nullptr) {
+        std::lock_guard<std::mutex> lock(mArena->mScopeMutex);
+        auto id = std::this_thread::get_id();
+
+        EfdAbortIf(mArena->mScopes > 0 && mArena->mScopeThread != id,
+                   "Arena is already in scope in another thread.");
+
+        mArena->mScopeThread = id;
+        ++mArena->mScopes;
+    }
+
+    CurrentArena = mArena.get();
+}
+
+Arena::Scope::~Scope() {
+    CurrentArena = mPrevious;
+
+    if (mArena.get() != nullptr) {
+        std::lock_guard<std::mutex> lock(mArena->mScopeMutex);
+        --mArena->mScopes;
+    }
+}
+
+// ---------------------- Arena ----------------------
+Arena::Arena() : mRefs(1), mCur(nullptr), mEnd(nullptr),
+    mNextChunkSize(FirstChunkSize), mChunksSize(0),
+    mFree(MaxFreeBlockSize / Alignment + 1, nullptr), mFreeBlocks(0), mScopes(0) {}
+
+Arena::~Arena() {
+    for (auto& chunk : mChunks) {
+        ReleaseChunk(chunk.first, chunk.second);
+    }
+}
+
+void* Arena::allocateImpl(std::size_t size) {
+    std::size_t sizeClass = size / Alignment;
+
+    // Freed blocks already count as live.
+    if (sizeClass < mFree.size() && mFree[sizeClass] != nullptr) {
+        char* block = mFree[sizeClass];
+        mFree[sizeClass] = *reinterpret_cast<char**>(block);
+        --mFreeBlocks;
+        return block;
+    }
+
+    if ((std::size_t)(mEnd - mCur) < size) {
+        uint64_t chunkSize = mNextChunkSize;
+        char* chunk = AcquireChunk(chunkSize);
+
+        mChunks.push_back(std::make_pair(chunk, chunkSize));
+        mChunksSize += chunkSize;
+
+        mCur = chunk;
+        mEnd = chunk + chunkSize;
+
+        if (mNextChunkSize < MaxChunkSize) {
+            mNextChunkSize *= 2;
+        }
+    }
+
+    void* ptr = mCur;
+    mCur += size;
+    mRefs.fetch_add(1, std::memory_order_relaxed);
+    return ptr;
+}
+
+void Arena::deallocateImpl(char* block, std::size_t size) {
+    std::size_t sizeClass = size / Alignment;
+
+    if (sizeClass < mFree.size()) {
+        *reinterpret_cast<char**>(block) = mFree[sizeClass];
+        mFree[sizeClass] = block;
+        ++mFreeBlocks;
+    } else {
+        release();
+    }
+}
+
+void Arena::release() {
+    if (mRefs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        delete this;
+    }
+}
+
+void Arena::releaseRoot() {
+    // Every scope holds a sRef, so none is alive: the freed blocks won't be
+    // handed out anymore.
+    uint64_t refs = mFreeBlocks + 1;
+    mFree.assign(mFree.size(), nullptr);
+    mFreeBlocks = 0;
+
+    if (mRefs.fetch_sub(refs, std::memory_order_acq_rel) == refs) {
+        delete this;
+    }
+}
+
+uint64_t Arena::getChunksSize() const {
+    return mChunksSize;
+}
+
+uint64_t Arena::getLiveBlocks() const {
+    // Minus the reference shared by all sRef.
+    return mRefs.load(std::memory_order_acquire) - mFreeBlocks - 1;
+}
+
+void* Arena::Allocate(std::size_t size) {
+    std::size_t total = AlignUp(HeaderSize + size);
+    Arena::Ref arena = total <= MaxArenaBlockSize ? CurrentArena : nullptr;
+    char* block;
+
+    if (arena != nullptr) {
+        block = static_cast<char*>(arena->allocateImpl(total));
+    } else {
+        block = static_cast<char*>(::operator new(total));
+    }
+
+    *reinterpret_cast<Arena::Ref*>(block) = arena;
+    return block + HeaderSize;
+}
+
+void Arena::Deallocate(void* ptr, std::size_t size) {
+    if (ptr == nullptr) return;
+
+    char* block = static_cast<char*>(ptr) - HeaderSize;
+    Arena::Ref arena = *reinterpret_cast<Arena::Ref*>(block);
+
+    if (arena == nullptr) {
+        ::operator delete(block);
+    } else if (arena == CurrentArena) {
+        // Only the thread in which the arena is in scope touches its freed
+        // blocks.
+        arena->deallocateImpl(block, AlignUp(HeaderSize + size));
+    } else {
+        arena->release();
+    }
+}
+
+Arena::sRef Arena::Create() {
+    // Dropping the last sRef only releases the reference they share (and the
+    // blocks kept for reuse).
+    return sRef(new Arena(), [](Arena::Ref arena) { arena->releaseRoot(); });
+}
@@ -24,8 +24,8 @@ std::vector<uint32_t> efd::BFSPathFinder::find(Graph::Ref g, uint32_t u, uint32_
 
         if (x == v) break;
 
-        std::set<uint32_t> &succ = g->succ(x);
-        std::set<uint32_t> &pred = g->pred(x);
+        const std::set<uint32_t> &succ = g->succ(x);
+        const std::set<uint32_t> &pred = g->pred(x);
         for (uint32_t k : succ) {
             if (!marked[k]) {
                 q.push(k);
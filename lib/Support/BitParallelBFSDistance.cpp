@@ -0,0 +1,148 @@
+#include "enfield/Support/BitParallelBFSDistance.h"
+#include "enfield/Support/ThreadPool.h"
+
+#include <algorithm>
+
+using namespace efd;
+
+BitParallelBFSDistance::BitParallelBFSDistance(uint32_t nThreads)
+    : DistanceGetter(), mThreads(nThreads), mN(0) {}
+
+void BitParallelBFSDistance::searchBatch(uint32_t batch, Words& words) {
+    const uint32_t* sources = &mSources[batch * 64];
+    uint32_t count = std::min(64u, mN - batch * 64);
+
+    auto& seen = words.mSeen;
+    auto& frontier = words.mFrontier;
+    auto& next = words.mNext;
+    auto& active = words.mActive;
+    auto& touched = words.mTouched;
+
+    seen.assign(mN, 0);
+    frontier.assign(mN, 0);
+    next.assign(mN, 0);
+    active.clear();
+
+    for (uint32_t b = 0; b < count; ++b) {
+        uint32_t src = sources[b];
+        seen[src] = 1ull << b;
+        frontier[src] = 1ull << b;
+        mDist[(uint64_t) src * mN + src] = 0;
+        active.push_back(src);
+    }
+
+    for (uint32_t d = 1; !active.empty(); ++d) {
+        touched.clear();
+
+        // Pushes the frontier of the active vertices to their neighbours.
+        for (uint32_t u : active) {
+            uint64_t f = frontier[u];
+
+            for (uint32_t i = mAdjBegin[u], e = mAdjBegin[u + 1]; i < e; ++i) {
+                uint32_t v = mAdjList[i];
+                if (next[v] == 0) touched.push_back(v);
+                next[v] |= f;
+            }
+        }
+
+        for (uint32_t u : active) {
+            frontier[u] = 0;
+        }
+
+        active.clear();
+
+        // Keeps only the sources that did not reach each vertex before.
+        for (uint32_t v : touched) {
+            uint64_t reached = next[v] & ~seen[v];
+            next[v] = 0;
+
+            if (reached) {
+                seen[v] |= reached;
+                frontier[v] = reached;
+                active.push_back(v);
+
+                for (uint64_t bits = reached; bits; bits &= bits - 1) {
+                    uint32_t b = __builtin_ctzll(bits);
+                    mDist[(uint64_t) sources[b] * mN + v] = d;
+                }
+            }
+        }
+    }
+}
+
+void BitParallelBFSDistance::groupSources() {
+    // The fewer distinct distances from the sources of a batch to a vertex,
+    // the fewer levels it is active in. So, batches are filled with balls:
+    // the unassigned vertices closest to the first unassigned one.
+    std::vector<bool> assigned(mN, false);
+    std::vector<uint32_t> stamp(mN, _undef);
+    std::vector<uint32_t> queue;
+
+    mSources.clear();
+
+    for (uint32_t start = 0, ball = 0; start < mN; ++start, ++ball) {
+        if (assigned[start]) continue;
+
+        queue.assign(1, start);
+        stamp[start] = ball;
+
+        for (uint32_t qi = 0; qi < queue.size(); ++qi) {
+            uint32_t u = queue[qi];
+
+            if (!assigned[u]) {
+                assigned[u] = true;
+                mSources.push_back(u);
+                // This batch is full.
+                if (mSources.size() % 64 == 0) break;
+            }
+
+            for (uint32_t i = mAdjBegin[u], e = mAdjBegin[u + 1]; i < e; ++i) {
+                uint32_t v = mAdjList[i];
+
+                if (stamp[v] != ball) {
+                    stamp[v] = ball;
+                    queue.push_back(v);
+                }
+            }
+        }
+    }
+}
+
+void BitParallelBFSDistance::initImpl() {
+    mN = mG->size();
+    mDist.assign((uint64_t) mN * mN, _undef);
+
+    mAdjBegin.assign(1, 0);
+    mAdjList.clear();
+
+    for (uint32_t u = 0; u < mN; ++u) {
+        for (uint32_t v : mG->adj(u)) {
+            mAdjList.push_back(v);
+        }
+
+        mAdjBegin.push_back(mAdjList.size());
+    }
+
+    groupSources();
+
+    uint32_t batches = (mN + 63) / 64;
+    auto pool = ThreadPool::Create(std::min(mThreads, std::max(batches, 1u)));
+    std::vector<Words> words(pool->size());
+
+    // Each batch only writes its own rows.
+    pool->run(batches, [&](uint32_t tid, uint32_t i) {
+        searchBatch(i, words[tid]);
+    });
+}
+
+uint32_t BitParallelBFSDistance::getImpl(uint32_t u, uint32_t v) {
+    return mDist[(uint64_t) u * mN + v];
+}
+
+const uint32_t* BitParallelBFSDistance::row(uint32_t u) const {
+    return &mDist[(uint64_t) u * mN];
+}
+
+BitParallelBFSDistance::uRef BitParallelBFSDistance::Create(uint32_t nThreads) {
+    return uRef(new BitParallelBFSDistance(nThreads));
+}
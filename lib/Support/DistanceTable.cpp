@@ -0,0 +1,377 @@
+#include "enfield/Support/DistanceTable.h"
+#include "enfield/Support/ThreadPool.h"
+#include "enfield/Support/BitParallelBFSDistance.h"
+#include "enfield/Support/CommandLine.h"
+#include "enfield/Support/Defs.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <queue>
+#include <sstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace efd;
+
+static Opt<uint32_t> BitParallelMin
+("-dist-table-bit-bfs-min", "Minimum number of vertices for building the distance \
+tables with a bit-parallel BFS. Their paths may differ from the ones `BFSPathFinder` \
+finds (though they are also shortest).", 128, false);
+
+Opt<bool> efd::DistTableNoVerify
+("-dist-table-no-verify", "Only checks the header of a binary distance table when \
+loading it, instead of hashing the whole table (which touches every page of the file).", false, false);
+
+namespace {
+    /// \brief Header of the binary file, followed by the distance matrix and
+    /// then by the parent matrix (`n * n` native `uint32_t` each).
+    ///
+    /// \em mGraphHash covers only the graph, so that it can be checked without
+    /// reading the matrices. \em mChecksum covers both (see \em checksum).
+    struct BinaryHeader {
+        char mMagic[8];
+        uint32_t mVersion;
+        uint32_t mN;
+        uint64_t mGraphHash;
+        uint64_t mChecksum;
+    };
+
+    const char _Magic_[8] = { 'E', 'F', 'D', 'D', 'I', 'S', 'T', '\0' };
+    const uint32_t _Version_ = 2;
+
+    // FNV-1a, one 64-bit word at a time.
+    const uint64_t _FNVBasis_ = 0xcbf29ce484222325ULL;
+    const uint64_t _FNVPrime_ = 0x100000001b3ULL;
+
+    inline uint64_t HashWord(uint64_t h, uint64_t w) {
+        return (h ^ w) * _FNVPrime_;
+    }
+
+    uint64_t HashWords(uint64_t h, const uint32_t* data, uint64_t n) {
+        uint64_t i = 0;
+
+        for (; i + 1 < n; i += 2) {
+            h = HashWord(h, ((uint64_t) data[i] << 32) | data[i + 1]);
+        }
+
+        if (i < n) h = HashWord(h, data[i]);
+        return h;
+    }
+
+    std::string ChecksumToString(uint64_t checksum) {
+        std::ostringstream ss;
+        ss << std::hex << std::setw(16) << std::setfill('0') << checksum;
+        return ss.str();
+    }
+
+    Json::Value MatrixToJson(uint32_t n, std::function<uint32_t(uint32_t, uint32_t)> at) {
+        Json::Value matrix(Json::arrayValue);
+
+        for (uint32_t u = 0; u < n; ++u) {
+            Json::Value row(Json::arrayValue);
+
+            for (uint32_t v = 0; v < n; ++v) {
+                uint32_t x = at(u, v);
+                row.append(x == _undef ? Json::Value(-1) : Json::Value(x));
+            }
+
+            matrix.append(row);
+        }
+
+        return matrix;
+    }
+
+    void MatrixFromJson(const Json::Value& root, const std::string& key, uint32_t n,
+                        std::function<void(uint32_t, uint32_t, uint32_t)> set) {
+        typedef Json::ValueType Ty;
+        const std::string _DistanceTableErrorPrefix_ = "DistanceTable parsing error";
+
+        JsonCheckTypeError(_DistanceTableErrorPrefix_, root, key, { Ty::arrayValue });
+        auto& matrix = root[key];
+        EfdAbortIf(matrix.size() != n,
+                   _DistanceTableErrorPrefix_ << ": `" << key << "` has `" << matrix.size()
+                   << "` rows. Expected: `" << n << "`.");
+
+        for (uint32_t u = 0; u < n; ++u) {
+            JsonCheckTypeError(_DistanceTableErrorPrefix_, matrix, u, { Ty::arrayValue });
+            auto& row = matrix[u];
+            EfdAbortIf(row.size() != n,
+                       _DistanceTableErrorPrefix_ << ": row `" << u << "` of `" << key
+                       << "` has `" << row.size() << "` columns. Expected: `" << n << "`.");
+
+            for (uint32_t v = 0; v < n; ++v) {
+                JsonCheckTypeError(_DistanceTableErrorPrefix_, row, v,
+                                   { Ty::intValue, Ty::uintValue });
+                auto x = row[v].asInt64();
+                set(u, v, x < 0 ? _undef : (uint32_t) x);
+            }
+        }
+    }
+}
+
+DistanceTable::DistanceTable(uint32_t n)
+    : mN(n), mData(2 * (uint64_t) n * n, _undef) {
+    mDist = mData.data();
+    mParent = mData.data() + (uint64_t) n * n;
+}
+
+DistanceTable::DistanceTable(uint32_t n, std::shared_ptr<void> mapping, const uint32_t* data)
+    : mN(n), mMapping(mapping), mDist(data), mParent(data + (uint64_t) n * n) {}
+
+void DistanceTable::bfs(Graph::Ref g, uint32_t src) {
+    uint32_t* dist = &mData[(uint64_t) src * mN];
+    uint32_t* parent = &mData[((uint64_t) mN + src) * mN];
+
+    std::queue<uint32_t> q;
+    q.push(src);
+    dist[src] = 0;
+
+    auto visit = [&](uint32_t x, uint32_t k) {
+        if (dist[k] == _undef) {
+            dist[k] = dist[x] + 1;
+            parent[k] = x;
+            q.push(k);
+        }
+    };
+
+    // Successors first, and then predecessors: the same order `BFSPathFinder`
+    // uses, so that we find the same paths.
+    while (!q.empty()) {
+        uint32_t x = q.front();
+        q.pop();
+
+        for (uint32_t k : g->succ(x)) visit(x, k);
+        for (uint32_t k : g->pred(x)) visit(x, k);
+    }
+}
+
+uint32_t DistanceTable::size() const {
+    return mN;
+}
+
+uint32_t DistanceTable::get(uint32_t u, uint32_t v) const {
+    return mDist[(uint64_t) u * mN + v];
+}
+
+const uint32_t* DistanceTable::row(uint32_t u) const {
+    return &mDist[(uint64_t) u * mN];
+}
+
+uint32_t DistanceTable::next(uint32_t u, uint32_t v) const {
+    // Edges are taken in both directions, so the vertex before `u` in the
+    // path from `v` follows `u` in a path from `u` to `v`.
+    return mParent[(uint64_t) v * mN + u];
+}
+
+uint32_t DistanceTable::prev(uint32_t u, uint32_t v) const {
+    return mParent[(uint64_t) u * mN + v];
+}
+
+std::vector<uint32_t> DistanceTable::path(uint32_t u, uint32_t v) const {
+    std::vector<uint32_t> path;
+    if (get(u, v) == _undef) return path;
+
+    for (uint32_t x = v; x != _undef; x = prev(u, x)) {
+        path.push_back(x);
+    }
+
+    std::reverse(path.begin(), path.end());
+    return path;
+}
+
+void DistanceTable::fillParents(Graph::Ref g, uint32_t src) {
+    const uint32_t* dist = &mData[(uint64_t) src * mN];
+    uint32_t* parent = &mData[((uint64_t) mN + src) * mN];
+
+    // Any neighbour one step closer to `src` is the last hop of a shortest path.
+    for (uint32_t v = 0; v < mN; ++v) {
+        if (v == src || dist[v] == _undef) continue;
+
+        for (uint32_t x : g->adj(v)) {
+            if (dist[x] + 1 == dist[v]) {
+                parent[v] = x;
+                break;
+            }
+        }
+    }
+}
+
+DistanceTable::uRef DistanceTable::Create(Graph::Ref g, uint32_t nThreads) {
+    uint32_t n = g->size();
+    uRef table(new DistanceTable(n));
+
+    auto pool = ThreadPool::Create(std::min(nThreads, std::max(n, 1u)));
+
+    if (n >= BitParallelMin.getVal()) {
+        auto distance = BitParallelBFSDistance::Create(nThreads);
+        distance->init(g);
+
+        // Each source only writes its own rows.
+        pool->run(n, [&](uint32_t tid, uint32_t u) {
+            std::copy(distance->row(u), distance->row(u) + n, &table->mData[(uint64_t) u * n]);
+        });
+
+        pool->run(n, [&](uint32_t tid, uint32_t u) { table->fillParents(g, u); });
+    } else {
+        // Each BFS only writes its own row.
+        pool->run(n, [&](uint32_t tid, uint32_t u) { table->bfs(g, u); });
+    }
+
+    return table;
+}
+
+uint64_t DistanceTable::GraphHash(Graph::Ref g) {
+    uint64_t h = HashWord(_FNVBasis_, ((uint64_t) g->size() << 1) | g->isDirectedGraph());
+
+    for (uint32_t u = 0, e = g->size(); u < e; ++u) {
+        auto& succ = g->succ(u);
+        h = HashWord(h, ((uint64_t) u << 32) | succ.size());
+        for (uint32_t v : succ) h = HashWord(h, v);
+    }
+
+    return h;
+}
+
+uint64_t DistanceTable::checksum(Graph::Ref g) const {
+    return HashWords(GraphHash(g), mDist, 2 * (uint64_t) mN * mN);
+}
+
+Json::Value DistanceTable::toJson(Graph::Ref g) const {
+    Json::Value root(Json::objectValue);
+    root[JsonFields<DistanceTable>::_ChecksumLabel_] = ChecksumToString(checksum(g));
+    root[JsonFields<DistanceTable>::_DistLabel_] =
+        MatrixToJson(mN, [this](uint32_t u, uint32_t v) { return get(u, v); });
+    root[JsonFields<DistanceTable>::_NextLabel_] =
+        MatrixToJson(mN, [this](uint32_t u, uint32_t v) { return next(u, v); });
+    return root;
+}
+
+Json::Value DistanceTable::toJson(Graph::Ref g, const std::string& file) const {
+    Json::Value root(Json::objectValue);
+    root[JsonFields<DistanceTable>::_ChecksumLabel_] = ChecksumToString(checksum(g));
+    root[JsonFields<DistanceTable>::_FileLabel_] = file;
+    return root;
+}
+
+void DistanceTable::writeBinary(Graph::Ref g, const std::string& filename) const {
+    BinaryHeader header;
+    std::memcpy(header.mMagic, _Magic_, sizeof(_Magic_));
+    header.mVersion = _Version_;
+    header.mN = mN;
+    header.mGraphHash = GraphHash(g);
+    header.mChecksum = checksum(g);
+
+    std::ofstream ofs(filename, std::ios::binary);
+    EfdAbortIf(!ofs, "Could not open `" << filename << "` for writing.");
+
+    uint64_t entries = (uint64_t) mN * mN;
+    ofs.write((const char*) &header, sizeof(header));
+    ofs.write((const char*) mDist, entries * sizeof(uint32_t));
+    ofs.write((const char*) mParent, entries * sizeof(uint32_t));
+    EfdAbortIf(!ofs, "Could not write the distance table to `" << filename << "`.");
+}
+
+DistanceTable::uRef DistanceTable::CreateView(uint32_t n, const uint32_t* data) {
+    return uRef(new DistanceTable(n, nullptr, data));
+}
+
+DistanceTable::uRef DistanceTable::FromJson(Graph::Ref g, const Json::Value& root) {
+    uint32_t n = g->size();
+    uRef table(new DistanceTable(n));
+    uint32_t* dist = table->mData.data();
+    uint32_t* parent = dist + (uint64_t) n * n;
+
+    // `next(u, v)` is stored as `mParent[v * n + u]`.
+    MatrixFromJson(root, JsonFields<DistanceTable>::_DistLabel_, n,
+                   [&](uint32_t u, uint32_t v, uint32_t x) { dist[(uint64_t) u * n + v] = x; });
+    MatrixFromJson(root, JsonFields<DistanceTable>::_NextLabel_, n,
+                   [&](uint32_t u, uint32_t v, uint32_t x) { parent[(uint64_t) v * n + u] = x; });
+
+    auto checksum = ChecksumFromJson(root);
+
+    if (table->checksum(g) != checksum) {
+        WAR << "Distance table checksum mismatch (expected `" << ChecksumToString(checksum)
+            << "`). Ignoring it." << std::endl;
+        return nullptr;
+    }
+
+    return table;
+}
+
+DistanceTable::uRef DistanceTable::LoadBinary(Graph::Ref g, const std::string& filename,
+                                              uint64_t checksum) {
+    uint32_t n = g->size();
+    uint64_t length = sizeof(BinaryHeader) + 2 * (uint64_t) n * n * sizeof(uint32_t);
+
+    int fd = open(filename.c_str(), O_RDONLY);
+
+    if (fd < 0) {
+        WAR << "Could not open the distance table file `" << filename << "`. "
+            << "Ignoring it." << std::endl;
+        return nullptr;
+    }
+
+    struct stat st;
+    bool sizeMatches = fstat(fd, &st) == 0 && (uint64_t) st.st_size == length;
+    void* addr = sizeMatches ? mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    close(fd);
+
+    if (addr == MAP_FAILED) {
+        WAR << "Distance table file `" << filename << "` does not fit a graph with `"
+            << n << "` vertices. Ignoring it." << std::endl;
+        return nullptr;
+    }
+
+    std::shared_ptr<void> mapping(addr, [length](void* p) { munmap(p, length); });
+    auto header = (const BinaryHeader*) addr;
+
+    if (std::memcmp(header->mMagic, _Magic_, sizeof(_Magic_)) != 0 ||
+            header->mVersion != _Version_ || header->mN != n) {
+        WAR << "`" << filename << "` is not a distance table for this graph. "
+            << "Ignoring it." << std::endl;
+        return nullptr;
+    }
+
+    auto data = (const uint32_t*) ((const char*) addr + sizeof(BinaryHeader));
+    uRef table(new DistanceTable(n, mapping, data));
+
+    // Hashing the matrices reads the whole file. Unless that is turned off,
+    // a corrupted body is refused as well.
+    if (header->mChecksum != checksum || header->mGraphHash != GraphHash(g) ||
+            (!DistTableNoVerify.getVal() && table->checksum(g) != checksum)) {
+        WAR << "Distance table checksum mismatch in `" << filename << "` (expected `"
+            << ChecksumToString(checksum) << "`). Ignoring it." << std::endl;
+        return nullptr;
+    }
+
+    return table;
+}
+
+uint64_t DistanceTable::ChecksumFromJson(const Json::Value& root) {
+    typedef Json::ValueType Ty;
+    const std::string _DistanceTableErrorPrefix_ = "DistanceTable parsing error";
+
+    JsonCheckTypeError(_DistanceTableErrorPrefix_, root,
+                       JsonFields<DistanceTable>::_ChecksumLabel_,
+                       { Ty::stringValue });
+
+    auto str = root[JsonFields<DistanceTable>::_ChecksumLabel_].asString();
+    EfdAbortIf(str.empty() || str.size() > 16 ||
+               str.find_first_not_of("0123456789abcdefABCDEF") != std::string::npos,
+               _DistanceTableErrorPrefix_ << ": `" << JsonFields<DistanceTable>::_ChecksumLabel_
+               << "` is not a 64-bit hexadecimal number: `" << str << "`.");
+
+    return std::stoull(str, nullptr, 16);
+}
+
+// ----------------------------- JsonFields -------------------------------
+const std::string JsonFields<DistanceTable>::_ChecksumLabel_ = "checksum";
+const std::string JsonFields<DistanceTable>::_DistLabel_ = "dist";
+const std::string JsonFields<DistanceTable>::_NextLabel_ = "next";
+const std::string JsonFields<DistanceTable>::_FileLabel_ = "file";
@@ -1,20 +1,29 @@
 #include "enfield/Support/Graph.h"
+#include "enfield/Support/DistanceTable.h"
+#include "enfield/Support/ThreadPool.h"
 
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <sstream>
 
 using namespace efd;
 
+// Graphs up to this number of vertices get an adjacency bit matrix, when
+// frozen (i.e. 2MB at most).
+static const uint32_t MaxEdgeBitsVertices = 4096;
+
 // ----------------------------- Graph -------------------------------
-Graph::Graph(Kind k, uint32_t n, Type ty) : mK(k), mN(n), mTy(ty) {
+Graph::Graph(Kind k, uint32_t n, Type ty) : mK(k), mN(n), mTy(ty), mFrozen(false) {
     mSuccessors.assign(n, std::set<uint32_t>());
     mPredecessors.assign(n, std::set<uint32_t>());
+    mAdjacent.assign(n, std::vector<uint32_t>());
 }
 
-Graph::Graph(uint32_t n, Type ty) : mK(K_GRAPH), mN(n), mTy(ty) {
+Graph::Graph(uint32_t n, Type ty) : mK(K_GRAPH), mN(n), mTy(ty), mFrozen(false) {
     mSuccessors.assign(n, std::set<uint32_t>());
     mPredecessors.assign(n, std::set<uint32_t>());
+    mAdjacent.assign(n, std::vector<uint32_t>());
 }
 
 std::string Graph::vertexToString(uint32_t i) const {
@@ -37,30 +46,46 @@ uint32_t Graph::size() const {
     return mN;
 }
 
-std::set<uint32_t>& Graph::succ(uint32_t i) {
+const std::set<uint32_t>& Graph::succ(uint32_t i) const {
     return mSuccessors[i];
 }
 
-std::set<uint32_t>& Graph::pred(uint32_t i) {
+const std::set<uint32_t>& Graph::pred(uint32_t i) const {
     return mPredecessors[i];
 }
 
-std::set<uint32_t> Graph::adj(uint32_t i) const {
-    std::set<uint32_t> adj;
-
-    auto& succ = mSuccessors[i];
-    auto& pred = mPredecessors[i];
+Graph::AdjSpan Graph::adj(uint32_t i) const {
+    if (mFrozen) {
+        const uint32_t* list = mAdjList.data();
+        return AdjSpan(list + mAdjBegin[i], list + mAdjBegin[i + 1]);
+    }
 
-    adj.insert(pred.begin(), pred.end());
-    adj.insert(succ.begin(), succ.end());
-    return adj;
+    auto& adj = mAdjacent[i];
+    return AdjSpan(adj.data(), adj.data() + adj.size());
 }
 
-bool Graph::hasEdge(uint32_t i, uint32_t j) {
-    std::set<uint32_t>& succ = this->succ(i);
+bool Graph::hasEdge(uint32_t i, uint32_t j) const {
+    if (mFrozen) {
+        if (!mEdgeBits.empty()) {
+            uint64_t bit = (uint64_t) i * mN + j;
+            return (mEdgeBits[bit >> 6] >> (bit & 63)) & 1;
+        }
+
+        auto begin = mSuccList.begin() + mSuccBegin[i];
+        auto end = mSuccList.begin() + mSuccBegin[i + 1];
+        return std::binary_search(begin, end, j);
+    }
+
+    auto& succ = mSuccessors[i];
     return succ.find(j) != succ.end();
 }
 
+// Inserts \p x in the sorted vector \p v, if it is not there yet.
+static void InsertSorted(std::vector<uint32_t>& v, uint32_t x) {
+    auto it = std::lower_bound(v.begin(), v.end(), x);
+    if (it == v.end() || *it != x) v.insert(it, x);
+}
+
 void Graph::putEdge(uint32_t i, uint32_t j) {
     mSuccessors[i].insert(j);
     mPredecessors[j].insert(i);
@@ -69,6 +94,78 @@ void Graph::putEdge(uint32_t i, uint32_t j) {
         mSuccessors[j].insert(i);
         mPredecessors[i].insert(j);
     }
+
+    InsertSorted(mAdjacent[i], j);
+    InsertSorted(mAdjacent[j], i);
+
+    mFrozen = false;
+    std::atomic_store(&mDistTable, std::shared_ptr<DistanceTable>());
+}
+
+void Graph::clearSuccAndPred(uint32_t i) {
+    mSuccessors[i].clear();
+    mPredecessors[i].clear();
+
+    mFrozen = false;
+    std::atomic_store(&mDistTable, std::shared_ptr<DistanceTable>());
+}
+
+void Graph::freeze() {
+    mAdjBegin.assign(1, 0);
+    mAdjList.clear();
+    mSuccBegin.assign(1, 0);
+    mSuccList.clear();
+
+    for (uint32_t i = 0; i < mN; ++i) {
+        mAdjList.insert(mAdjList.end(), mAdjacent[i].begin(), mAdjacent[i].end());
+        mAdjBegin.push_back(mAdjList.size());
+        mSuccList.insert(mSuccList.end(), mSuccessors[i].begin(), mSuccessors[i].end());
+        mSuccBegin.push_back(mSuccList.size());
+    }
+
+    mEdgeBits.clear();
+
+    if (mN <= MaxEdgeBitsVertices) {
+        mEdgeBits.assign(((uint64_t) mN * mN + 63) / 64, 0);
+
+        for (uint32_t i = 0; i < mN; ++i) {
+            for (uint32_t j : mSuccessors[i]) {
+                uint64_t bit = (uint64_t) i * mN + j;
+                mEdgeBits[bit >> 6] |= (uint64_t) 1 << (bit & 63);
+            }
+        }
+    }
+
+    mFrozen = true;
+}
+
+bool Graph::isFrozen() const {
+    return mFrozen;
+}
+
+std::shared_ptr<DistanceTable> Graph::getDistanceTable() {
+    auto table = std::atomic_load(&mDistTable);
+
+    if (table.get() == nullptr) {
+        // If some other thread gets there first, we just use its table.
+        std::shared_ptr<DistanceTable> built(DistanceTable::Create(this, Threads.getVal()));
+        std::shared_ptr<DistanceTable> expected;
+
+        if (std::atomic_compare_exchange_strong(&mDistTable, &expected, built)) {
+            table = built;
+        } else {
+            table = expected;
+        }
+    }
+
+    return table;
+}
+
+void Graph::setDistanceTable(std::shared_ptr<DistanceTable> table) {
+    EfdAbortIf(table.get() != nullptr && table->size() != size(),
+               "Distance table of size `" << table->size() << "` does not fit a graph "
+               << "with `" << size() << "` vertices.");
+    std::atomic_store(&mDistTable, table);
 }
 
 bool Graph::isWeighted() const {
@@ -95,8 +192,8 @@ std::string Graph::dotify(std::string name) const {
     for (uint32_t i = 0; i < mN; ++i) {
         dot += "    " + vertexToString(i) + ";\n";
 
-        auto adjacent = mSuccessors[i];
-        if (!isDirected) adjacent = adj(i);
+        std::vector<uint32_t> adjacent(mSuccessors[i].begin(), mSuccessors[i].end());
+        if (!isDirected) adjacent.assign(adj(i).begin(), adj(i).end());
 
         for (uint32_t j : adjacent) {
             if (isDirected || (!isDirected && j >= i))
@@ -159,5 +256,6 @@ std::unique_ptr<Graph> JsonBackendParser<Graph>::Parse(const Json::Value& root)
         }
     }
 
+    graph->freeze();
     return graph;
 }
@@ -0,0 +1,93 @@
+#include "enfield/Support/MappedFile.h"
+
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace efd;
+
+// ---------------------- MemoryStreamBuf ----------------------
+MemoryStreamBuf::MemoryStreamBuf(const char* data, uint64_t size) {
+    // The get area is never written to.
+    char* begin = const_cast<char*>(data);
+    setg(begin, begin, begin + size);
+}
+
+// ---------------------- MappedFile ----------------------
+const uint32_t MappedFile::Padding;
+
+MappedFile::MappedFile(char* data, uint64_t size, uint64_t mapSize)
+    : mData(data), mSize(size), mMapSize(mapSize), mBuf(data, size), mStream(&mBuf) {}
+
+MappedFile::~MappedFile() {
+    munmap(mData, mMapSize);
+}
+
+const char* MappedFile::data() const {
+    return mData;
+}
+
+char* MappedFile::data() {
+    return mData;
+}
+
+uint64_t MappedFile::size() const {
+    return mSize;
+}
+
+std::istream& MappedFile::getStream() {
+    return mStream;
+}
+
+MappedFile::uRef MappedFile::Open(const std::string& path) {
+    struct stat st;
+    // Checked before opening it, so that the caller may still open (and read)
+    // pipes: opening one here would block on, and close, its writer.
+    if (stat(path.c_str(), &st) < 0) return uRef(nullptr);
+    if (!S_ISREG(st.st_mode)) {
+        errno = S_ISDIR(st.st_mode) ? EISDIR : ENODEV;
+        return uRef(nullptr);
+    }
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return uRef(nullptr);
+
+    auto fail = [fd](int err) {
+        close(fd);
+        errno = err;
+        return uRef(nullptr);
+    };
+
+    if (fstat(fd, &st) < 0) return fail(errno);
+    // Only regular files can be mapped (it may have been replaced since).
+    if (!S_ISREG(st.st_mode)) return fail(S_ISDIR(st.st_mode) ? EISDIR : ENODEV);
+
+    uint64_t size = st.st_size;
+    uint64_t mapSize = size + Padding;
+
+    // The file can't be mapped past its last page. So, zeroed pages are
+    // reserved for the contents and the padding, and the file is mapped
+    // over them. The rest of its last page reads as zero as well.
+    void* addr = mmap(nullptr, mapSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (addr == MAP_FAILED) return fail(errno);
+
+    // Empty files can't be mapped.
+    if (size > 0) {
+        void* fileAddr = mmap(addr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0);
+
+        if (fileAddr == MAP_FAILED) {
+            int err = errno;
+            munmap(addr, mapSize);
+            return fail(err);
+        }
+
+        // It is read once, from beginning to end.
+        madvise(addr, size, MADV_SEQUENTIAL);
+    }
+
+    // The mapping stays valid after the descriptor is closed.
+    close(fd);
+    return uRef(new MappedFile(static_cast<char*>(addr), size, mapSize));
+}
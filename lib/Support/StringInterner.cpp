@@ -0,0 +1,113 @@
+#include "enfield/Support/StringInterner.h"
+#include "enfield/Support/Defs.h"
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+
+using namespace efd;
+
+namespace {
+    typedef std::atomic<const std::string*> Slot;
+
+    // The strings are spread over a few shards (by their hash), each with
+    // its own lock. So, threads interning different strings seldom wait.
+    static const uint32_t ShardsNumber = 16;
+
+    // The symbols are looked up, without any lock, in chunks that double in
+    // size: the chunk `k` holds the symbols `[FirstChunkSize * (2^k - 1),
+    // FirstChunkSize * (2^(k + 1) - 1))`. Chunks are never moved nor freed
+    // while the table is alive.
+    static const uint32_t FirstChunkBits = 6;
+    static const uint32_t FirstChunkSize = 1 << FirstChunkBits;
+    static const uint32_t ChunksNumber = 32;
+
+    struct InternShard {
+        std::mutex mMutex;
+        // A deque never moves its elements, so the references returned by
+        // \em Get stay valid while new strings are interned.
+        std::deque<std::string> mStrings;
+        std::unordered_map<std::string, StringInterner::Symbol> mSymbols;
+    };
+
+    struct InternTable {
+        InternShard mShards[ShardsNumber];
+        std::atomic<Slot*> mChunks[ChunksNumber];
+        std::atomic<uint32_t> mSize;
+
+        InternTable();
+        ~InternTable();
+
+        /// \brief Returns the slot of \p sym, allocating its chunk if needed.
+        Slot& getSlot(StringInterner::Symbol sym, bool allocate);
+    };
+}
+
+InternTable::InternTable() : mSize(0) {
+    for (auto& chunk : mChunks) chunk.store(nullptr);
+}
+
+InternTable::~InternTable() {
+    for (auto& chunk : mChunks) delete [] chunk.load();
+}
+
+Slot& InternTable::getSlot(StringInterner::Symbol sym, bool allocate) {
+    uint64_t pos = static_cast<uint64_t>(sym) + FirstChunkSize;
+    uint32_t k = (63 - __builtin_clzll(pos)) - FirstChunkBits;
+    uint64_t offset = pos - (static_cast<uint64_t>(FirstChunkSize) << k);
+
+    Slot* chunk = mChunks[k].load(std::memory_order_acquire);
+
+    if (chunk == nullptr && allocate) {
+        // Interning threads that hold different shard locks may race here.
+        Slot* newChunk = new Slot[static_cast<uint64_t>(FirstChunkSize) << k]();
+
+        if (mChunks[k].compare_exchange_strong(chunk, newChunk, std::memory_order_acq_rel)) {
+            chunk = newChunk;
+        } else {
+            delete [] newChunk;
+        }
+    }
+
+    EfdAbortIf(chunk == nullptr, "Symbol was not interned: `" << sym << "`.");
+    return chunk[offset];
+}
+
+static InternTable& GetTable() {
+    static InternTable table;
+    return table;
+}
+
+StringInterner::Symbol StringInterner::Intern(const std::string& str) {
+    auto& table = GetTable();
+    auto& shard = table.mShards[std::hash<std::string>()(str) % ShardsNumber];
+    std::lock_guard<std::mutex> lock(shard.mMutex);
+
+    auto it = shard.mSymbols.find(str);
+    if (it != shard.mSymbols.end()) return it->second;
+
+    Symbol sym = table.mSize.fetch_add(1);
+    EfdAbortIf(sym == _undef, "Too many interned strings: `" << sym << "`.");
+
+    shard.mStrings.push_back(str);
+    shard.mSymbols.insert(std::make_pair(str, sym));
+    table.getSlot(sym, true).store(&shard.mStrings.back(), std::memory_order_release);
+    return sym;
+}
+
+const std::string& StringInterner::Get(Symbol sym) {
+    auto& table = GetTable();
+    uint32_t size = table.mSize.load(std::memory_order_relaxed);
+
+    EfdAbortIf(sym >= size, "Symbol out of bounds (of `" << size << "`): `" << sym << "`.");
+
+    auto str = table.getSlot(sym, false).load(std::memory_order_acquire);
+    EfdAbortIf(str == nullptr, "Symbol was not interned: `" << sym << "`.");
+    return *str;
+}
+
+uint32_t StringInterner::Size() {
+    return GetTable().mSize.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,97 @@
+#include "enfield/Support/ThreadPool.h"
+#include "enfield/Support/Defs.h"
+
+#include <algorithm>
+
+using namespace efd;
+
+Opt<uint32_t> efd::Threads
+("threads", "Number of threads used by parallel algorithms (0 uses all hardware threads).",
+ 1, false);
+
+ThreadPool::ThreadPool(uint32_t nThreads)
+    : mTask(nullptr), mN(0), mActive(0), mGeneration(0), mStop(false), mNext(0) {
+    EfdAbortIf(nThreads == 0, "`ThreadPool` must have at least one thread.");
+
+    for (uint32_t tid = 1; tid < nThreads; ++tid) {
+        mWorkers.push_back(std::thread(&ThreadPool::workerLoop, this, tid));
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStop = true;
+    }
+
+    mStartCV.notify_all();
+
+    for (auto& worker : mWorkers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::workOn(uint32_t tid) {
+    uint32_t i;
+    while ((i = mNext.fetch_add(1)) < mN) {
+        (*mTask)(tid, i);
+    }
+}
+
+void ThreadPool::workerLoop(uint32_t tid) {
+    uint64_t seen = 0;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mStartCV.wait(lock, [&] { return mStop || mGeneration != seen; });
+            if (mStop) return;
+            seen = mGeneration;
+        }
+
+        workOn(tid);
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (--mActive == 0) mDoneCV.notify_one();
+        }
+    }
+}
+
+uint32_t ThreadPool::size() const {
+    return mWorkers.size() + 1;
+}
+
+void ThreadPool::run(uint32_t n, const Task& task) {
+    if (mWorkers.empty()) {
+        for (uint32_t i = 0; i < n; ++i) {
+            task(0, i);
+        }
+
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mTask = &task;
+        mN = n;
+        mNext = 0;
+        mActive = mWorkers.size();
+        ++mGeneration;
+    }
+
+    mStartCV.notify_all();
+    workOn(0);
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    mDoneCV.wait(lock, [&] { return mActive == 0; });
+    mTask = nullptr;
+}
+
+ThreadPool::uRef ThreadPool::Create(uint32_t nThreads) {
+    if (nThreads == 0) {
+        nThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    return uRef(new ThreadPool(nThreads));
+}
@@ -1,11 +1,11 @@
 #include "enfield/Support/WrapperVal.h"
 
 template <>
-efd::WrapperVal<long long>::WrapperVal(std::string str) : mStr(str) {
-    mV = std::stoll(str);
+efd::WrapperVal<long long>::WrapperVal(std::string str) : mStr(std::move(str)) {
+    mV = std::stoll(mStr);
 }
 
 template <>
-efd::WrapperVal<double>::WrapperVal(std::string str) : mStr(str) {
-    mV = std::stod(str);
+efd::WrapperVal<double>::WrapperVal(std::string str) : mStr(std::move(str)) {
+    mV = std::stod(mStr);
 }
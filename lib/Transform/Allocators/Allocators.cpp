@@ -34,7 +34,7 @@ template <> std::vector<std::string> efd::EnumAllocator::mStrVal {
     "Q_"#_Name_,
 #define EFD_ALLOCATOR_SIMPLE(_Name_, _Finder_, _Builder_) \
     "Q_"#_Name_,
-#define EFD_ALLOCATOR_BMT(_Name_, _NCG_, _CS_, _PSS_, _SCE_, _LQPP_, _MSS_, _TSF_) \
+#define EFD_ALLOCATOR_BMT(_Name_, _NCG_, _CS_, _PSS_, _SCE_, _LQPP_, _MSS_, _TSF_, _DD_) \
     "Q_"#_Name_,
 #include "enfield/Transform/Allocators/Allocators.def"
 #undef EFD_ALLOCATOR
@@ -58,9 +58,9 @@ void efd::InitializeAllQbitAllocators() {
     RegisterQbitAllocator(Allocator::Q_##_Name_, Create##_Class_);
 #define EFD_ALLOCATOR_SIMPLE(_Name_, _Finder_, _Builder_) \
     RegisterQbitAllocator(Allocator::Q_##_Name_, Create##_Finder_##With##_Builder_);
-#define EFD_ALLOCATOR_BMT(_Name_, _NCG_, _CS_, _PSS_, _SCE_, _LQPP_, _MSS_, _TSF_) \
+#define EFD_ALLOCATOR_BMT(_Name_, _NCG_, _CS_, _PSS_, _SCE_, _LQPP_, _MSS_, _TSF_, _DD_) \
     RegisterQbitAllocator(Allocator::Q_##_Name_,\
-                          CreateBMT##_NCG_##_CS_##_PSS_##_SCE_##_LQPP_##_MSS_##_TSF_);
+                          CreateBMT##_NCG_##_CS_##_PSS_##_SCE_##_LQPP_##_MSS_##_TSF_##_##_DD_);
 #include "enfield/Transform/Allocators/Allocators.def"
 #undef EFD_ALLOCATOR
 #undef EFD_ALLOCATOR_SIMPLE
@@ -93,9 +93,9 @@ efd::CreateQbitAllocator(EnumAllocator key, AllocatorRegistry::ArgTy arg) {
         allocator->setSolBuilder(_Builder_::Create());\
         return std::move(allocator);\
     }
-#define EFD_ALLOCATOR_BMT(_Name_, _NCG_, _CS_, _PSS_, _SCE_, _LQPP_, _MSS_, _TSF_) \
+#define EFD_ALLOCATOR_BMT(_Name_, _NCG_, _CS_, _PSS_, _SCE_, _LQPP_, _MSS_, _TSF_, _DD_) \
     efd::AllocatorRegistry::RetTy\
-    efd::CreateBMT##_NCG_##_CS_##_PSS_##_SCE_##_LQPP_##_MSS_##_TSF_(AllocatorRegistry::ArgTy arg) {\
+    efd::CreateBMT##_NCG_##_CS_##_PSS_##_SCE_##_LQPP_##_MSS_##_TSF_##_##_DD_(AllocatorRegistry::ArgTy arg) {\
         auto allocator = BoundedMappingTreeQAllocator::Create(arg);\
         allocator->setNodeCandidatesGenerator(_NCG_::Create());\
         allocator->setChildrenSelector(_CS_::Create());\
@@ -104,6 +104,7 @@ efd::CreateQbitAllocator(EnumAllocator key, AllocatorRegistry::ArgTy arg) {
         allocator->setLiveQubitsPreProcessor(_LQPP_::Create());\
         allocator->setMapSeqSelector(_MSS_::Create());\
         allocator->setTokenSwapFinder(_TSF_::Create());\
+        allocator->setDedupeCandidates(_DD_);\
         return std::move(allocator);\
     }
 #include "enfield/Transform/Allocators/Allocators.def"
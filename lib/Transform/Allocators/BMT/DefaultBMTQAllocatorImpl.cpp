@@ -1,32 +1,37 @@
 #include "enfield/Transform/Allocators/BMT/DefaultBMTQAllocatorImpl.h"
-#include "enfield/Support/BFSCachedDistance.h"
 
 using namespace efd;
 using namespace bmt;
 
+#include <cmath>
 #include <queue>
 
 static Opt<uint32_t> MaxMapSeqCandidates
 ("-bmt-max-mapseq", "Select the best N mapping sequences from phase 2.", 1, false);
+static Opt<double> ErrorWeight
+("-bmt-error-weight", "How much the error of an edge adds to the cost of going \
+through it, for the error-aware swap cost estimator.", 10, false);
 
 // --------------------- SeqNCandidatesGenerator ------------------------
 void SeqNCandidatesGenerator::initImpl() {
     mIt = mMod->stmt_begin();
+    mIndex = 0;
 }
 
 bool SeqNCandidatesGenerator::finishedImpl() {
     return mIt == mMod->stmt_end();
 }
 
-std::vector<Node::Ref> SeqNCandidatesGenerator::generateImpl() {
-    return { mIt->get() };
+void SeqNCandidatesGenerator::generateImpl(std::vector<uint32_t>& candidates) {
+    candidates.push_back(mIndex);
 }
 
-void SeqNCandidatesGenerator::signalProcessed(Node::Ref node) {
-    EfdAbortIf(node != mIt->get(),
-               "Node `" << node->toString(false) << "` not the one processed. Actual: `"
-               << (*mIt)->toString(false) << "`.");
+void SeqNCandidatesGenerator::signalProcessed(uint32_t i) {
+    EfdAbortIf(i != mIndex,
+               "Node `" << mMod->getStatement(i)->toString(false) << "` not the one processed. "
+               << "Actual: `" << (*mIt)->toString(false) << "`.");
     ++mIt;
+    ++mIndex;
 }
 
 SeqNCandidatesGenerator::uRef SeqNCandidatesGenerator::Create() {
@@ -34,11 +39,15 @@ SeqNCandidatesGenerator::uRef SeqNCandidatesGenerator::Create() {
 }
 
 // --------------------- FirstCandidateSelector ------------------------
-MCandidateVector FirstCandidateSelector::select(uint32_t maxCandidates,
-                                                const MCandidateVector& candidates) {
+void FirstCandidateSelector::select(uint32_t maxCandidates,
+                                    const ACandidateVector& candidates,
+                                    Vector& selected) {
     uint32_t selectedSize = std::min((uint32_t) candidates.size(), maxCandidates);
-    MCandidateVector selected(candidates.begin(), candidates.begin() + selectedSize);
-    return selected;
+    selected.clear();
+
+    for (uint32_t i = 0; i < selectedSize; ++i) {
+        selected.push_back(i);
+    }
 }
 
 FirstCandidateSelector::uRef FirstCandidateSelector::Create() {
@@ -47,20 +56,7 @@ FirstCandidateSelector::uRef FirstCandidateSelector::Create() {
 
 // --------------------- GeoDistanceSwapCEstimator ------------------------
 void GeoDistanceSwapCEstimator::initImpl() {
-    BFSCachedDistance bfs;
-    bfs.init(mG);
-
-    uint32_t mPQubits = mG->size();
-    mDist.assign(mPQubits, Vector());
-
-    mDist.assign(mPQubits, Vector(mPQubits, 0));
-
-    for (uint32_t i = 0; i < mPQubits; ++i) {
-        for (uint32_t j = i + 1; j < mPQubits; ++j) {
-            mDist[i][j] = bfs.get(i, j);
-            mDist[j][i] = mDist[i][j];
-        }
-    }
+    mDist = mG->getDistanceTable();
 }
 
 uint32_t GeoDistanceSwapCEstimator::estimateImpl(const Mapping& fromM,
@@ -69,40 +65,75 @@ uint32_t GeoDistanceSwapCEstimator::estimateImpl(const Mapping& fromM,
 
     for (uint32_t i = 0, e = fromM.size(); i < e; ++i) {
         if (fromM[i] != _undef) {
-            totalDistance += mDist[fromM[i]][toM[i]];
+            totalDistance += mDist->get(fromM[i], toM[i]);
         }
     }
 
     return totalDistance;
 }
 
+SwapCostEstimator::uRef GeoDistanceSwapCEstimator::clone() const {
+    return SwapCostEstimator::uRef(new GeoDistanceSwapCEstimator(*this));
+}
+
 GeoDistanceSwapCEstimator::uRef GeoDistanceSwapCEstimator::Create() {
     return uRef(new GeoDistanceSwapCEstimator());
 }
 
-// --------------------- GeoNearestLQPProcessor ------------------------
-void GeoNearestLQPProcessor::initImpl() {
-    BFSCachedDistance bfs;
-    bfs.init(mG);
+// --------------------- ErrorGeoDistanceSwapCEstimator ------------------------
+void ErrorGeoDistanceSwapCEstimator::initImpl() {
+    double weight = ErrorWeight.getVal();
 
-    mPQubits = mG->size();
-    mDist.assign(mPQubits, Vector(mPQubits, 0));
+    // The weights of an architecture are the probabilities of success.
+    mDist = WeightedDistance<double>::Create(WeightedDistance<double>::M_Auto,
+                                             [weight](uint32_t u, uint32_t v, double p) {
+        return 1 - weight * std::log(std::max(p, 1e-9));
+    });
+    mDist->init(mG);
+}
+
+uint32_t ErrorGeoDistanceSwapCEstimator::estimateImpl(const Mapping& fromM,
+                                                      const Mapping& toM) {
+    double totalDistance = 0;
 
-    for (uint32_t i = 0; i < mPQubits; ++i) {
-        for (uint32_t j = i + 1; j < mPQubits; ++j) {
-            mDist[i][j] = bfs.get(i, j);
-            mDist[j][i] = mDist[i][j];
+    for (uint32_t i = 0, e = fromM.size(); i < e; ++i) {
+        if (fromM[i] != _undef) {
+            double d = mDist->get(fromM[i], toM[i]);
+            EfdAbortIf(d == WeightedDistance<double>::Inf(),
+                       "There is no path between the physical qubits `" << fromM[i]
+                       << "` and `" << toM[i] << "`.");
+            totalDistance += d;
         }
     }
+
+    // Heavy enough errors may still add up past what fits in the estimate.
+    double max = std::numeric_limits<uint32_t>::max();
+    return (uint32_t) std::min(std::round(totalDistance), max);
+}
+
+SwapCostEstimator::uRef ErrorGeoDistanceSwapCEstimator::clone() const {
+    // The distances are read-only, so the clones share them.
+    return SwapCostEstimator::uRef(new ErrorGeoDistanceSwapCEstimator(*this));
+}
+
+ErrorGeoDistanceSwapCEstimator::uRef ErrorGeoDistanceSwapCEstimator::Create() {
+    return uRef(new ErrorGeoDistanceSwapCEstimator());
+}
+
+// --------------------- GeoNearestLQPProcessor ------------------------
+void GeoNearestLQPProcessor::initImpl() {
+    mPQubits = mG->size();
+    mDist = mG->getDistanceTable();
 }
 
 uint32_t GeoNearestLQPProcessor::getNearest(uint32_t u, const InverseMap& inv) {
     uint32_t minV = 0;
     uint32_t minDist = _undef;
+    const uint32_t* dist = mDist->row(u);
 
     for (uint32_t v = 0; v < mPQubits; ++v) {
-        if (inv[v] == _undef && mDist[u][v] < minDist) {
-            minDist = mDist[u][v];
+        if (inv[v] == _undef && dist[v] < minDist) {
+            minDist = dist[v];
             minV = v;
         }
     }
@@ -129,6 +160,10 @@ void GeoNearestLQPProcessor::processImpl(Mapping& fromM, Mapping& toM) {
     }
 }
 
+LiveQubitsPreProcessor::uRef GeoNearestLQPProcessor::clone() const {
+    return LiveQubitsPreProcessor::uRef(new GeoNearestLQPProcessor(*this));
+}
+
 GeoNearestLQPProcessor::uRef GeoNearestLQPProcessor::Create() {
     return uRef(new GeoNearestLQPProcessor());
 }
@@ -2,16 +2,23 @@
 #include "enfield/Transform/CircuitGraphBuilderPass.h"
 #include "enfield/Transform/PassCache.h"
 
+#include <algorithm>
+#include <limits>
 #include <queue>
 #include <random>
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define EFD_AVX2_KERNEL 1
+#include <immintrin.h>
+#endif
+
 using namespace efd;
 using namespace bmt;
 
 // --------------------- CircuitCandidatesGenerator ------------------------
 void CircuitCandidatesGenerator::advanceXbitId(uint32_t i) {
     mIt.next(i);
-    ++mReached[mIt.get(i)];
+    ++mReached[mIt[i]->index()];
 }
 
 void CircuitCandidatesGenerator::advanceCNode(CircuitGraph::CircuitNode::Ref cnode) {
@@ -21,9 +28,9 @@ void CircuitCandidatesGenerator::advanceCNode(CircuitGraph::CircuitNode::Ref cno
 }
 
 void CircuitCandidatesGenerator::initImpl() {
-    mCGraph = PassCache::Get<CircuitGraphBuilderPass>(mMod)->getData();
-    mIt = mCGraph.build_iterator();
-    mXbitSize = mCGraph.size();
+    mCGraph = PassCache::GetData<CircuitGraphBuilderPass>(mMod);
+    mIt = mCGraph->build_iterator();
+    mXbitSize = mCGraph->size();
 
     for (uint32_t i = 0; i < mXbitSize; ++i) {
         advanceXbitId(i);
@@ -37,26 +44,26 @@ bool CircuitCandidatesGenerator::finishedImpl() {
     return true;
 }
 
-std::vector<Node::Ref> CircuitCandidatesGenerator::generateImpl() {
-    std::set<Node::Ref> nodeCandidateSet;
-
+void CircuitCandidatesGenerator::generateImpl(std::vector<uint32_t>& candidates) {
     for (uint32_t i = 0; i < mXbitSize; ++i) {
         auto cnode = mIt[i];
-        auto node = cnode->node();
+        auto index = cnode->index();
 
-        if (mReached[node] == cnode->numberOfXbits()) {
-            nodeCandidateSet.insert(node);
-            mNCNMap[node] = cnode.get();
+        if (mReached[index] == cnode->numberOfXbits()) {
+            candidates.push_back(index);
+            mNCNMap[index] = cnode.get();
         }
     }
 
-    return std::vector<Node::Ref>(nodeCandidateSet.begin(), nodeCandidateSet.end());
+    // A node is reached through each of its xbits.
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
 }
 
-void CircuitCandidatesGenerator::signalProcessed(Node::Ref node) {
-    auto cnode = mNCNMap[node];
-    mNCNMap.erase(node);
-    mReached.erase(node);
+void CircuitCandidatesGenerator::signalProcessed(uint32_t i) {
+    auto cnode = mNCNMap[i];
+    mNCNMap.erase(i);
+    mReached.erase(i);
     advanceCNode(cnode);
 }
 
@@ -68,33 +75,40 @@ CircuitCandidatesGenerator::uRef CircuitCandidatesGenerator::Create() {
 WeightedRouletteCandidateSelector::WeightedRouletteCandidateSelector()
     : mGen((std::random_device())()), mDist(0.0) {}
 
-MCandidateVector WeightedRouletteCandidateSelector::select(uint32_t maxCandidates,
-                                                           const MCandidateVector& candidates) {
+void WeightedRouletteCandidateSelector::select(uint32_t maxCandidates,
+                                               const ACandidateVector& candidates,
+                                               Vector& selected) {
     uint32_t selectionNumber = std::min(maxCandidates, (uint32_t) candidates.size());
     uint32_t deletedW = 0;
     uint32_t sqSum = 0;
     uint32_t wSum = 0;
 
-    MCandidateVector selected;
-    std::vector<uint32_t> weight;
-    std::vector<bool> wasSelected(candidates.size(), false);
+    selected.clear();
 
-    if (selectionNumber == (uint32_t) candidates.size())
-        return candidates;
+    if (selectionNumber == (uint32_t) candidates.size()) {
+        for (uint32_t i = 0; i < selectionNumber; ++i) {
+            selected.push_back(i);
+        }
+
+        return;
+    }
+
+    mWeight.clear();
+    mWasSelected.assign(candidates.size(), false);
 
     for (const auto& cand : candidates) {
         sqSum += (cand.cost * cand.cost);
     }
 
     if (sqSum == 0) {
-        weight.assign(candidates.size(), 1);
+        mWeight.assign(candidates.size(), 1);
     } else {
         for (const auto& cand : candidates) {
-            weight.push_back(sqSum - (cand.cost * cand.cost));
+            mWeight.push_back(sqSum - (cand.cost * cand.cost));
         }
     }
 
-    for (auto w : weight) {
+    for (auto w : mWeight) {
         wSum += w;
     }
 
@@ -103,9 +117,9 @@ MCandidateVector WeightedRouletteCandidateSelector::select(uint32_t maxCandidate
         double cummulativeProbability = 0;
         uint32_t j = 0;
 
-        while (cummulativeProbability < r && j < weight.size()) {
-            if (!wasSelected[j]) {
-                cummulativeProbability += (double) weight[j] / ((double) wSum - deletedW);
+        while (cummulativeProbability < r && j < mWeight.size()) {
+            if (!mWasSelected[j]) {
+                cummulativeProbability += (double) mWeight[j] / ((double) wSum - deletedW);
             }
 
             ++j;
@@ -113,15 +127,158 @@ MCandidateVector WeightedRouletteCandidateSelector::select(uint32_t maxCandidate
 
         --j;
         wSum -= deletedW;
-        deletedW = weight[j];
+        deletedW = mWeight[j];
 
-        wasSelected[j] = true;
-        selected.push_back(candidates[j]);
+        mWasSelected[j] = true;
+        selected.push_back(j);
     }
-
-    return selected;
 }
 
 WeightedRouletteCandidateSelector::uRef WeightedRouletteCandidateSelector::Create() {
     return uRef(new WeightedRouletteCandidateSelector());
 }
+
+// --------------------- FlatGeoDistanceSwapCEstimator ------------------------
+static uint32_t FlatEstimateScalar(const uint16_t* dist, uint32_t stride,
+                                   const uint32_t* fromM, const uint32_t* toM,
+                                   uint32_t i, uint32_t n) {
+    uint32_t totalDistance = 0;
+
+    for (; i < n; ++i) {
+        if (fromM[i] != _undef) {
+            totalDistance += dist[fromM[i] * stride + toM[i]];
+        }
+    }
+
+    return totalDistance;
+}
+
+#ifdef EFD_AVX2_KERNEL
+// Gathers 32-bit words at the (2-byte scaled) offsets of the distances, and
+// keeps only their lower half. The table has some padding at the end, so
+// that reading past the last distance is fine. The last (partial) group of
+// qubits is read with a masked load, so no scalar loop is needed.
+__attribute__((target("avx2")))
+static uint32_t FlatEstimateAVX2(const uint16_t* dist, uint32_t stride,
+                                 const uint32_t* fromM, const uint32_t* toM,
+                                 uint32_t n) {
+    const __m256i undef = _mm256_set1_epi32(-1);
+    const __m256i lowHalf = _mm256_set1_epi32(0xFFFF);
+    const __m256i vStride = _mm256_set1_epi32(stride);
+    __m256i acc = _mm256_setzero_si256();
+    uint32_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        __m256i from = _mm256_loadu_si256((const __m256i*) (fromM + i));
+        __m256i to = _mm256_loadu_si256((const __m256i*) (toM + i));
+        __m256i live = _mm256_xor_si256(_mm256_cmpeq_epi32(from, undef), undef);
+        __m256i idx = _mm256_add_epi32(_mm256_mullo_epi32(from, vStride), to);
+        __m256i d = _mm256_mask_i32gather_epi32(_mm256_setzero_si256(),
+                                                (const int*) dist, idx, live, 2);
+        acc = _mm256_add_epi32(acc, _mm256_and_si256(d, lowHalf));
+    }
+
+    if (i < n) {
+        const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        __m256i tail = _mm256_cmpgt_epi32(_mm256_set1_epi32(n - i), lanes);
+        __m256i from = _mm256_maskload_epi32((const int*) (fromM + i), tail);
+        __m256i to = _mm256_maskload_epi32((const int*) (toM + i), tail);
+        __m256i live = _mm256_andnot_si256(_mm256_cmpeq_epi32(from, undef), tail);
+        __m256i idx = _mm256_add_epi32(_mm256_mullo_epi32(from, vStride), to);
+        __m256i d = _mm256_mask_i32gather_epi32(_mm256_setzero_si256(),
+                                                (const int*) dist, idx, live, 2);
+        acc = _mm256_add_epi32(acc, _mm256_and_si256(d, lowHalf));
+    }
+
+    __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(acc),
+                                _mm256_extracti128_si256(acc, 1));
+    sum = _mm_hadd_epi32(sum, sum);
+    sum = _mm_hadd_epi32(sum, sum);
+
+    return (uint32_t) _mm_cvtsi128_si32(sum);
+}
+#endif
+
+FlatGeoDistanceSwapCEstimator::FlatGeoDistanceSwapCEstimator()
+    : mStride(0), mUseAVX2(false) {
+    setUseAVX2(true);
+}
+
+void FlatGeoDistanceSwapCEstimator::initImpl() {
+    auto table = mG->getDistanceTable();
+    uint32_t pQubits = mG->size();
+    uint32_t maxDist = std::numeric_limits<uint16_t>::max();
+
+    mTable.reset();
+    mDist.clear();
+
+    // If some distance doesn't fit in 16 bits (e.g.: unconnected qubits), the
+    // distances are read from the table itself, as `GeoDistanceSwapCEstimator`.
+    for (uint32_t i = 0; i < pQubits; ++i) {
+        for (uint32_t j = i + 1; j < pQubits; ++j) {
+            if (table->get(i, j) > maxDist) {
+                WAR << "Distance between `" << i << "` and `" << j << "` does not fit in "
+                    << "the flat table. Using the distance table instead." << std::endl;
+                mTable = table;
+                return;
+            }
+        }
+    }
+
+    mStride = (pQubits + 15) & ~15u;
+    // One extra row of padding for the 32-bit gathers.
+    mDist.assign((pQubits + 1) * mStride, 0);
+
+    for (uint32_t i = 0; i < pQubits; ++i) {
+        for (uint32_t j = i + 1; j < pQubits; ++j) {
+            uint16_t d = table->get(i, j);
+            mDist[i * mStride + j] = d;
+            mDist[j * mStride + i] = d;
+        }
+    }
+}
+
+uint32_t FlatGeoDistanceSwapCEstimator::estimateImpl(const Mapping& fromM,
+                                                     const Mapping& toM) {
+    if (mTable.get() != nullptr) {
+        uint32_t totalDistance = 0;
+
+        for (uint32_t i = 0, e = fromM.size(); i < e; ++i) {
+            if (fromM[i] != _undef) {
+                totalDistance += mTable->get(fromM[i], toM[i]);
+            }
+        }
+
+        return totalDistance;
+    }
+
+#ifdef EFD_AVX2_KERNEL
+    if (mUseAVX2) {
+        return FlatEstimateAVX2(mDist.data(), mStride, fromM.data(), toM.data(),
+                                fromM.size());
+    }
+#endif
+
+    return FlatEstimateScalar(mDist.data(), mStride, fromM.data(), toM.data(),
+                              0, fromM.size());
+}
+
+void FlatGeoDistanceSwapCEstimator::setUseAVX2(bool use) {
+#ifdef EFD_AVX2_KERNEL
+    mUseAVX2 = use && __builtin_cpu_supports("avx2");
+#else
+    mUseAVX2 = false;
+#endif
+}
+
+bool FlatGeoDistanceSwapCEstimator::usesAVX2() const {
+    return mUseAVX2;
+}
+
+SwapCostEstimator::uRef FlatGeoDistanceSwapCEstimator::clone() const {
+    return SwapCostEstimator::uRef(new FlatGeoDistanceSwapCEstimator(*this));
+}
+
+FlatGeoDistanceSwapCEstimator::uRef FlatGeoDistanceSwapCEstimator::Create() {
+    return uRef(new FlatGeoDistanceSwapCEstimator());
+}
@@ -1,14 +1,14 @@
 #include "enfield/Transform/Allocators/BoundedMappingTreeQAllocator.h"
 #include "enfield/Transform/Allocators/BMT/DefaultBMTQAllocatorImpl.h"
-#include "enfield/Transform/QubitRemapPass.h"
+#include "enfield/Transform/InstructionStream.h"
 #include "enfield/Transform/PassCache.h"
-#include "enfield/Transform/Utils.h"
 #include "enfield/Analysis/NodeVisitor.h"
 #include "enfield/Support/ApproxTSFinder.h"
 #include "enfield/Support/CommandLine.h"
 #include "enfield/Support/Stats.h"
 #include "enfield/Support/Defs.h"
 #include "enfield/Support/Timer.h"
+#include "enfield/Support/ThreadPool.h"
 
 #include <algorithm>
 
@@ -35,18 +35,28 @@ Stat<double> Phase3Time
 Stat<uint32_t> Partitions
 ("BMTPartitions", "Number of partitions split by *BMT allocators.");
 
+Stat<uint32_t> PrunedTransitions
+("BMTPrunedTransitions", "Number of transitions pruned in the 2nd phase of BMT allocators.");
+
+Stat<double> DedupeRatio
+("BMTDedupeRatio", "Ratio of duplicate candidates removed in the 1st phase of BMT allocators.");
+
+Stat<uint32_t> Phase1Growths
+("BMTPhase1Growths", "Number of times the reused buffers grew in the 1st phase of BMT allocators "
+ "(the partitions copied out as its result are not counted).");
+
 bool efd::bmt::operator>(const NodeCandidate& lhs, const NodeCandidate& rhs) {
     if (lhs.mWeight != rhs.mWeight) return lhs.mWeight > rhs.mWeight;
-    return lhs.mNode > rhs.mNode;
+    return lhs.mIndex > rhs.mIndex;
 }
 
 // --------------------- NodeCandidatesGenerator ------------------------
 NodeCandidatesGenerator::NodeCandidatesGenerator() : mInitialized(false), mMod(nullptr) {}
 
-std::vector<Node::Ref> NodeCandidatesGenerator::generate() {
+void NodeCandidatesGenerator::generate(std::vector<uint32_t>& candidates) {
     checkInitialized();
-    if (finished()) return {};
-    return generateImpl();
+    candidates.clear();
+    if (!finished()) generateImpl(candidates);
 }
 
 bool NodeCandidatesGenerator::finished() {
@@ -66,7 +76,7 @@ void NodeCandidatesGenerator::init(QModule::Ref qmod) {
 }
 
 void NodeCandidatesGenerator::initImpl() {}
-void NodeCandidatesGenerator::signalProcessed(Node::Ref node) {}
+void NodeCandidatesGenerator::signalProcessed(uint32_t i) {}
 
 // --------------------- SwapCostEstimator ------------------------
 SwapCostEstimator::SwapCostEstimator() : mG(nullptr) {}
@@ -102,9 +112,127 @@ void LiveQubitsPreProcessor::checkInitialized() {
     EfdAbortIf(mG == nullptr, "Set the `Graph` for LiveQubitsPreProcessor.");
 }
 
+// Counts one allocation whenever \p v grows past its capacity.
+template <typename T>
+static void PushBackCounting(std::vector<T>& v, const T& x, uint32_t& allocs) {
+    if (v.size() == v.capacity()) ++allocs;
+    v.push_back(x);
+}
+
+// --------------------- MappingArena ------------------------
+MappingArena::MappingArena(uint32_t stride) : mStride(stride), mRows(0), mGrowths(0) {}
+
+void MappingArena::clear() {
+    mRows = 0;
+}
+
+uint32_t MappingArena::push() {
+    uint32_t end = (mRows + 1) * mStride;
+
+    if (end > mData.size()) {
+        if (end > mData.capacity()) ++mGrowths;
+        mData.resize(end);
+    }
+
+    return mRows++;
+}
+
+uint32_t MappingArena::push(const MappingArena& other, uint32_t i) {
+    EfdAbortIf(&other == this, "Can't copy a row from the same `MappingArena`.");
+    EfdAbortIf(other.mStride != mStride,
+               "Different strides (" << other.mStride << " != " << mStride << ").");
+
+    uint32_t r = push();
+    std::copy(other.row(i), other.row(i) + mStride, row(r));
+    return r;
+}
+
+uint32_t* MappingArena::row(uint32_t i) {
+    return &mData[i * mStride];
+}
+
+const uint32_t* MappingArena::row(uint32_t i) const {
+    return &mData[i * mStride];
+}
+
+uint32_t MappingArena::size() const {
+    return mRows;
+}
+
+uint32_t MappingArena::getStride() const {
+    return mStride;
+}
+
+uint32_t MappingArena::getGrowths() const {
+    return mGrowths;
+}
+
+// --------------------- CandidateDeduplicator ------------------------
+CandidateDeduplicator::CandidateDeduplicator() : mGrowths(0) {}
+
+uint32_t CandidateDeduplicator::dedupe(const MappingArena& arena, uint32_t n,
+                                      ACandidateVector& candidates) {
+    uint32_t size = candidates.size();
+    uint32_t slots = 1;
+
+    while (slots < 2 * size) slots <<= 1;
+
+    auto slotsCapacity = mSlots.capacity();
+    auto hashesCapacity = mHashes.capacity();
+    mSlots.assign(slots, _undef);
+    mHashes.resize(slots);
+    if (mSlots.capacity() != slotsCapacity) ++mGrowths;
+    if (mHashes.capacity() != hashesCapacity) ++mGrowths;
+
+    // Open addressing: each slot holds the index of a kept candidate.
+    uint32_t kept = 0;
+
+    for (uint32_t i = 0; i < size; ++i) {
+        const uint32_t* m = arena.row(candidates[i].row);
+        uint64_t h = HashMapping(m, n);
+        uint32_t s = h & (slots - 1);
+
+        while (true) {
+            uint32_t k = mSlots[s];
+
+            if (k == _undef) {
+                mSlots[s] = kept;
+                mHashes[s] = h;
+                candidates[kept++] = candidates[i];
+                break;
+            }
+
+            if (mHashes[s] == h &&
+                std::equal(m, m + n, arena.row(candidates[k].row))) {
+                if (candidates[i].cost < candidates[k].cost) {
+                    candidates[k].row = candidates[i].row;
+                    candidates[k].cost = candidates[i].cost;
+                }
+
+                break;
+            }
+
+            s = (s + 1) & (slots - 1);
+        }
+    }
+
+    candidates.resize(kept);
+    return size - kept;
+}
+
+uint32_t CandidateDeduplicator::getGrowths() const {
+    return mGrowths;
+}
+
 // --------------------- BoundedMappingTreeQAllocator ------------------------
 BoundedMappingTreeQAllocator::BoundedMappingTreeQAllocator(ArchGraph::sRef ag)
     : QbitAllocator(ag),
+      mPhase1Growths(0),
+      mDedupeTotal(0),
+      mDedupeRemoved(0),
+      mPrunedTransitions(0),
+      mDedupe(false),
+      mPrune(true),
       mNCGenerator(nullptr),
       mChildrenCSelector(nullptr),
       mPartialSolutionCSelector(nullptr),
@@ -113,33 +241,53 @@ BoundedMappingTreeQAllocator::BoundedMappingTreeQAllocator(ArchGraph::sRef ag)
       mMSSelector(nullptr),
       mTSFinder(nullptr) {}
 
-MCandidateVector
-BoundedMappingTreeQAllocator::extendCandidates(Dep& dep,
-                                               const std::vector<bool>& mapped,
-                                               const MCandidateVector& candidates,
-                                               bool ignoreChildrenLimit) {
-    typedef std::pair<uint32_t, uint32_t> Pair;
-    typedef std::vector<Pair> PairVector;
-
+void BoundedMappingTreeQAllocator::extendCandidates(const Dep& dep,
+                                                    const std::vector<bool>& mapped,
+                                                    const MappingArena& arena,
+                                                    const ACandidateVector& candidates,
+                                                    bool ignoreChildrenLimit,
+                                                    MappingArena& newArena,
+                                                    ACandidateVector& newCandidates) {
     uint32_t a = dep.mFrom, b = dep.mTo;
     uint32_t childrenBound = (ignoreChildrenLimit) ? _undef : mMaxChildren;
-    MCandidateVector newCandidates;
 
-    for (auto cand : candidates) {
-        PairVector pairV;
-        MCandidateVector localCandidates;
-        auto inv = InvertMapping(mPQubits, cand.m, false);
+    newArena.clear();
+    newCandidates.clear();
+    mExtended.clear();
+
+    for (const auto& cand : candidates) {
+        const uint32_t* m = arena.row(cand.row);
+        const uint32_t* inv = m + mVQubits;
+
+        mChildren.clear();
+
+        // Copies the parent, and updates both the mapping and its inverse
+        // so that `a -> u` and `b -> v`.
+        auto addChild = [&](uint32_t u, uint32_t v) {
+            uint32_t r = newArena.push(arena, cand.row);
+            uint32_t* cm = newArena.row(r);
+            uint32_t* cinv = cm + mVQubits;
+
+            if (cm[a] != _undef) cinv[cm[a]] = _undef;
+            if (cm[b] != _undef) cinv[cm[b]] = _undef;
+
+            cm[a] = u;
+            cm[b] = v;
+            cinv[u] = a;
+            cinv[v] = b;
+
+            PushBackCounting(mChildren, { r, cand.cost + getCXCost(u, v) }, mPhase1Growths);
+        };
 
         if (mapped[a] && mapped[b]) {
-            uint32_t u = cand.m[a], v = cand.m[b];
+            uint32_t u = m[a], v = m[b];
             if (mArchGraph->hasEdge(u, v) || mArchGraph->hasEdge(v, u))
-                pairV.push_back(Pair(u, v));
+                addChild(u, v);
         } else if (!mapped[a] && !mapped[b]) {
             for (uint32_t u = 0; u < mPQubits; ++u) {
                 if (inv[u] != _undef) continue;
                 for (uint32_t v : mArchGraph->adj(u)) {
-                    if (inv[v] != _undef) continue;
-                    pairV.push_back(Pair(u, v));
+                    if (inv[v] == _undef) addChild(u, v);
                 }
             }
         } else {
@@ -151,44 +299,77 @@ BoundedMappingTreeQAllocator::extendCandidates(Dep& dep,
                 mappedV = a;
             }
 
-            uint32_t u = cand.m[mappedV];
+            uint32_t u = m[mappedV];
             for (uint32_t v : mArchGraph->adj(u)) {
                 if (inv[v] == _undef) {
                     if (mappedV == a) {
-                        pairV.push_back(Pair(u, v));
+                        addChild(u, v);
                     } else {
-                        pairV.push_back(Pair(v, u));
+                        addChild(v, u);
                     }
                 }
             }
         }
 
-        for (auto& pair : pairV) {
-            auto cpy = cand;
-            cpy.m[a] = pair.first;
-            cpy.m[b] = pair.second;
-            cpy.cost += getCXCost(pair.first, pair.second);
-            localCandidates.push_back(cpy);
+        auto capacity = mSelected.capacity();
+        mChildrenCSelector->select(childrenBound, mChildren, mSelected);
+        if (mSelected.capacity() != capacity) ++mPhase1Growths;
+
+        for (uint32_t i : mSelected) {
+            PushBackCounting(mExtended, mChildren[i], mPhase1Growths);
         }
+    }
+
+    if (mDedupe) {
+        uint32_t growths = mDeduplicator.getGrowths();
+        mDedupeTotal += mExtended.size();
+        mDedupeRemoved += mDeduplicator.dedupe(newArena, mVQubits, mExtended);
+        mPhase1Growths += mDeduplicator.getGrowths() - growths;
+    }
+
+    auto capacity = mSelected.capacity();
+    mPartialSolutionCSelector->select(mMaxPartial, mExtended, mSelected);
+    if (mSelected.capacity() != capacity) ++mPhase1Growths;
 
-        MCandidateVector selected = mChildrenCSelector->select(childrenBound, localCandidates);
-        newCandidates.insert(newCandidates.end(), selected.begin(), selected.end());
+    for (uint32_t i : mSelected) {
+        PushBackCounting(newCandidates, mExtended[i], mPhase1Growths);
     }
+}
+
+void BoundedMappingTreeQAllocator::resetCandidates(MappingArena& arena,
+                                                   ACandidateVector& candidates) {
+    arena.clear();
+    candidates.clear();
 
-    return mPartialSolutionCSelector->select(mMaxPartial, newCandidates);
+    uint32_t r = arena.push();
+    std::fill(arena.row(r), arena.row(r) + arena.getStride(), _undef);
+    PushBackCounting(candidates, { r, 0 }, mPhase1Growths);
 }
 
-NCPQueue
-BoundedMappingTreeQAllocator::rankCandidates(const std::vector<Node::Ref>& nodeCandidates,
-                                             const std::vector<bool>& mapped,
-                                             const std::vector<std::set<uint32_t>>& neighbors) {
-    NCPQueue queue;
+MCandidateVector
+BoundedMappingTreeQAllocator::toMCandidateVector(const MappingArena& arena,
+                                                 const ACandidateVector& candidates) {
+    MCandidateVector mCandidates;
+
+    for (const auto& cand : candidates) {
+        const uint32_t* m = arena.row(cand.row);
+        mCandidates.push_back({ Mapping(m, m + mVQubits), cand.cost });
+    }
+
+    return mCandidates;
+}
 
-    for (auto node : nodeCandidates) {
+void BoundedMappingTreeQAllocator::rankCandidates(const std::vector<uint32_t>& nodeCandidates,
+                                                  const std::vector<bool>& mapped,
+                                                  const std::vector<uint8_t>& neighbors) {
+    auto capacity = mRanked.capacity();
+    mRanked.clear();
+
+    for (uint32_t i : nodeCandidates) {
         NodeCandidate nCand;
 
-        nCand.mNode = node;
-        nCand.mDeps = mDBuilder.getDeps(node);
+        nCand.mIndex = i;
+        nCand.mDeps = mDBuilder->getDepsAt(i);
 
         auto depsSize = nCand.mDeps.size();
         if (depsSize == 0) {
@@ -197,7 +378,7 @@ BoundedMappingTreeQAllocator::rankCandidates(const std::vector<Node::Ref>& nodeC
             uint32_t a = nCand.mDeps[0].mFrom;
             uint32_t b = nCand.mDeps[0].mTo;
 
-            if (mapped[a] && mapped[b] && neighbors[a].find(b) != neighbors[a].end()) {
+            if (mapped[a] && mapped[b] && neighbors[a * mVQubits + b]) {
                 nCand.mWeight = 1;
             } else if (!mapped[a] && !mapped[b]) {
                 nCand.mWeight = 3;
@@ -209,14 +390,17 @@ BoundedMappingTreeQAllocator::rankCandidates(const std::vector<Node::Ref>& nodeC
         } else {
             EfdAbortIf(true,
                        "Instructions with more than one dependency not supported ("
-                       << node->toString(false) << ")");
+                       << nCand.mDeps.mCallPoint->toString(false) << ")");
         }
 
-        queue.push(nCand);
+        mRanked.push_back(nCand);
     }
 
-    EfdAbortIf(queue.empty(), "`pQueue` empty.");
-    return queue;
+    if (mRanked.capacity() != capacity) ++mPhase1Growths;
+    EfdAbortIf(mRanked.empty(), "`mRanked` empty.");
+
+    std::sort(mRanked.begin(), mRanked.end(),
+              [](const NodeCandidate& lhs, const NodeCandidate& rhs) { return rhs > lhs; });
 }
 
 MCandidateVCollection BoundedMappingTreeQAllocator::phase1() {
@@ -224,49 +408,63 @@ MCandidateVCollection BoundedMappingTreeQAllocator::phase1() {
     //     in this phase, we divide the program in layers, such that each layer is satisfied
     //     by any of the mappings inside 'candidates'.
     //
+    //     The mappings being extended live in two arenas: one for the current candidates,
+    //     and one for their children. They are swapped at each step, and only copied out
+    //     (into 'collection') when a partition is finished.
+    //
     mPP.push_back(PPartition());
-    MCandidateVector candidates { { Mapping(mVQubits, _undef), 0 } };
     MCandidateVCollection collection;
 
+    uint32_t stride = mVQubits + mPQubits;
+    MappingArena arena(stride), newArena(stride);
+    ACandidateVector candidates, newCandidates;
+    resetCandidates(arena, candidates);
+
     std::vector<bool> mapped(mVQubits, false);
-    std::vector<std::set<uint32_t>> neighbors(mVQubits);
+    std::vector<uint8_t> neighbors(mVQubits * mVQubits, 0);
 
     INF << "PHASE 1 >>>> Solving SIP Instances" << std::endl;
 
     bool first = true;
 
     while (!mNCGenerator->finished()) {
-        auto nodeCandidates = mNCGenerator->generate();
-        auto pQueue = rankCandidates(nodeCandidates, mapped, neighbors);
+        auto capacity = mNodeCandidates.capacity();
+        mNCGenerator->generate(mNodeCandidates);
+        if (mNodeCandidates.capacity() != capacity) ++mPhase1Growths;
+
+        rankCandidates(mNodeCandidates, mapped, neighbors);
 
         NodeCandidate nCand;
-        MCandidateVector newCandidates;
+        bool extended = false;
 
-        while (!pQueue.empty()) {
-            nCand = pQueue.top();
-            pQueue.pop();
+        for (const auto& ranked : mRanked) {
+            nCand = ranked;
 
             auto depsSize = nCand.mDeps.size();
 
             if (depsSize == 0) {
-                newCandidates = candidates;
+                extended = true;
                 break;
             } else if (depsSize == 1) {
-                newCandidates = extendCandidates(nCand.mDeps[0],
-                                                 mapped,
-                                                 candidates,
-                                                 first);
+                extendCandidates(nCand.mDeps[0],
+                                 mapped,
+                                 arena,
+                                 candidates,
+                                 first,
+                                 newArena,
+                                 newCandidates);
                 first = false;
                 if (!newCandidates.empty()) {
+                    extended = true;
                     break;
                 }
             }
         }
 
-        if (newCandidates.empty()) {
-            collection.push_back(candidates);
+        if (!extended) {
+            collection.push_back(toMCandidateVector(arena, candidates));
             // Reseting all data from the last partition.
-            candidates = { { Mapping(mVQubits, _undef), 0 } };
+            resetCandidates(arena, candidates);
             mapped.assign(mVQubits, false);
             mPP.push_back(PPartition());
             first = true;
@@ -278,35 +476,48 @@ MCandidateVCollection BoundedMappingTreeQAllocator::phase1() {
 
                 mapped[a] = true;
                 mapped[b] = true;
-                neighbors[a].insert(b);
-                neighbors[b].insert(a);
+                neighbors[a * mVQubits + b] = 1;
+                neighbors[b * mVQubits + a] = 1;
 
-                candidates = newCandidates;
+                std::swap(arena, newArena);
+                std::swap(candidates, newCandidates);
             }
 
-            mPP.back().push_back(nCand.mNode);
-            mNCGenerator->signalProcessed(nCand.mNode);
+            mPP.back().push_back(nCand.mIndex);
+            mNCGenerator->signalProcessed(nCand.mIndex);
         }
     }
 
-    collection.push_back(candidates);
+    collection.push_back(toMCandidateVector(arena, candidates));
+    mPhase1Growths += arena.getGrowths() + newArena.getGrowths();
 
     return collection;
 }
 
-MappingSeq BoundedMappingTreeQAllocator::tracebackPath(const TIMatrix& mem, uint32_t idx) {
+MappingSeq BoundedMappingTreeQAllocator::tracebackPath(const MCandidateVCollection& collection,
+                                                       const TIMatrix& mem, uint32_t idx) {
     MappingSeq mapSeq;
     uint32_t nofLayers = mem.size();
+    Vector path(nofLayers);
 
     mapSeq.mappingCost = mem[nofLayers - 1][idx].mappingCost;
     
     for (int32_t i = nofLayers - 1; i >= 0; --i) {
-        auto info = mem[i][idx];
-        mapSeq.mappingV.push_back(info.m);
-        idx = info.parent;
+        path[i] = idx;
+        idx = mem[i][idx].parent;
     }
-    
-    std::reverse(mapSeq.mappingV.begin(), mapSeq.mappingV.end());
+
+    // Replays the live qubits pre-processing along the path, which gives
+    // us the same mappings we had in phase 2.
+    mapSeq.mappingV.push_back(collection[0][path[0]].m);
+
+    for (uint32_t i = 1; i < nofLayers; ++i) {
+        auto mapping = collection[i][path[i]].m;
+        auto lastMapping = mapSeq.mappingV.back();
+        mLQPProcessor->process(lastMapping, mapping);
+        mapSeq.mappingV.push_back(mapping);
+    }
+
     return mapSeq;
 }
 
@@ -364,62 +575,138 @@ BoundedMappingTreeQAllocator::phase2(const MCandidateVCollection& collection) {
 
     for (uint32_t i = 0; i < nofLayers; ++i)
         layerMaxSize = std::max(layerMaxSize, (uint32_t) collection[i].size());
+
+    auto pool = ThreadPool::Create(mThreads);
+    uint32_t nofThreads = pool->size();
     
     INF << "PHASE 2 >>>> Dynamic Programming" << std::endl;
     INF << "Layers: " << nofLayers << std::endl;
     INF << "MaxSize: " << layerMaxSize << std::endl;
+    INF << "Threads: " << nofThreads << std::endl;
+
+    // Each thread gets its own estimator and pre-processor, since they may
+    // keep internal state. The thread 0 is the caller itself.
+    std::vector<SwapCostEstimator::uRef> estimatorClones;
+    std::vector<LiveQubitsPreProcessor::uRef> processorClones;
+    std::vector<SwapCostEstimator::Ref> estimators { mCostEstimator.get() };
+    std::vector<LiveQubitsPreProcessor::Ref> processors { mLQPProcessor.get() };
+
+    for (uint32_t t = 1; t < nofThreads; ++t) {
+        estimatorClones.push_back(mCostEstimator->clone());
+        processorClones.push_back(mLQPProcessor->clone());
+        estimators.push_back(estimatorClones.back().get());
+        processors.push_back(processorClones.back().get());
+    }
 
+    Timer layerTimer;
     TIMatrix mem(nofLayers, TIVector());
+    Vector order(layerMaxSize);
+    std::vector<uint64_t> pruned(nofThreads, 0);
+    // Only the processed mappings of the last two layers are kept.
+    MappingVector lastLayer, curLayer;
 
     for (uint32_t i = 0, e = collection[0].size(); i < e; ++i) {
-        mem[0].push_back({ collection[0][i].m, _undef, collection[0][i].cost, 0 });
+        mem[0].push_back({ _undef, collection[0][i].cost, 0 });
+        lastLayer.push_back(collection[0][i].m);
     }
 
     for (uint32_t i = 1; i < nofLayers; ++i) {
-        // INF << "Beginning: " << i << " of " << nofLayers << " layers." << std::endl;
+        layerTimer.start();
 
         uint32_t jLayerSize = collection[i].size();
-        for (uint32_t j = 0; j < jLayerSize; ++j) {
-            // Timer jt;
-            // jt.start();
+        uint32_t kLayerSize = collection[i - 1].size();
 
-            TracebackInfo best = { {}, _undef, _undef, 0 };
-            uint32_t kLayerSize = collection[i - 1].size();
+        mem[i].assign(jLayerSize, TracebackInfo());
+        curLayer.assign(jLayerSize, Mapping());
+
+        // Predecessors sorted by their accumulated cost. Since the swap estimation
+        // is never negative, as soon as the accumulated cost of `k` alone can't
+        // beat the best, no other `k` after it can.
+        for (uint32_t k = 0; k < kLayerSize; ++k) {
+            order[k] = k;
+        }
+
+        std::sort(order.begin(), order.begin() + kLayerSize, [&](uint32_t l, uint32_t r) {
+            uint64_t lCost = (uint64_t) mem[i - 1][l].mappingCost + mem[i - 1][l].swapEstimatedCost;
+            uint64_t rCost = (uint64_t) mem[i - 1][r].mappingCost + mem[i - 1][r].swapEstimatedCost;
+            if (lCost != rCost) return lCost < rCost;
+            return l < r;
+        });
+
+        // Every `j` only reads the previous layer, and writes to its own
+        // position. So, the result is the same, no matter the order.
+        pool->run(jLayerSize, [&](uint32_t tid, uint32_t j) {
+            auto estimator = estimators[tid];
+            auto processor = processors[tid];
+
+            TracebackInfo best = { _undef, _undef, 0 };
+            Mapping bestMapping;
+
+            for (uint32_t o = 0; o < kLayerSize; ++o) {
+                uint32_t k = order[o];
+
+                // Ties are broken by the smallest `k`, as if we had gone through
+                // them in order. The sums are computed in 64 bits, as in the
+                // sort above, so that they don't wrap around.
+                uint64_t bound = (uint64_t) mem[i - 1][k].mappingCost + collection[i][j].cost +
+                    mem[i - 1][k].swapEstimatedCost;
+                uint64_t bestCost = (best.parent == _undef) ?
+                    std::numeric_limits<uint64_t>::max() :
+                    (uint64_t) best.mappingCost + best.swapEstimatedCost;
+
+                if (mPrune && (bound > bestCost || (bound == bestCost && k > best.parent))) {
+                    pruned[tid] += kLayerSize - o;
+                    break;
+                }
 
-            for (uint32_t k = 0; k < kLayerSize; ++k) {
                 auto mapping = collection[i][j].m;
-                auto lastMapping = mem[i - 1][k].m;
+                auto lastMapping = lastLayer[k];
 
-                mLQPProcessor->process(lastMapping, mapping);
+                processor->process(lastMapping, mapping);
 
                 // uint32_t mappingCost = mem[i - 1][k].mappingCost;
                 // Should be this one.
                 uint32_t mappingCost = mem[i - 1][k].mappingCost + collection[i][j].cost;
-                uint32_t swapEstimatedCost = mCostEstimator->estimate(lastMapping, mapping) * 30 +
+                uint32_t swapEstimatedCost = estimator->estimate(lastMapping, mapping) * 30 +
                     mem[i - 1][k].swapEstimatedCost;
 
-                if (mappingCost + swapEstimatedCost < best.mappingCost + best.swapEstimatedCost) {
-                    best = { mapping, k, mappingCost, swapEstimatedCost };
+                uint64_t cost = (uint64_t) mappingCost + swapEstimatedCost;
+
+                if (cost < bestCost || (cost == bestCost && k < best.parent)) {
+                    best = { k, mappingCost, swapEstimatedCost };
+                    bestMapping = std::move(mapping);
                 }
             }
 
-            mem[i].push_back(best);
+            mem[i][j] = best;
+            curLayer[j] = std::move(bestMapping);
+        });
 
-            // jt.stop();
-            // INF << "(i:" << i << ", j:" << j << "): "
-            //     << ((double) jt.getMilliseconds()) / 1000.0 << std::endl;
-        }
+        std::swap(lastLayer, curLayer);
+
+        layerTimer.stop();
+
+        double layerTime = (double) layerTimer.getMicroseconds() / 1000000.0;
+        Phase2Time += layerTime;
 
-        INF << "End: " << i << " of " << nofLayers << " layers." << std::endl;
+        INF << "End: " << i << " of " << nofLayers << " layers ("
+            << layerTime << "s)." << std::endl;
     }
 
+    mPrunedTransitions = 0;
+    for (auto p : pruned) mPrunedTransitions += p;
+    PrunedTransitions = mPrunedTransitions;
+
+    Timer tracebackTimer;
+    tracebackTimer.start();
+
     Vector mapSequenceIndexes = mMSSelector->select(mem);
     MappingSwapSequence best = { {}, {}, _undef };
 
     for (uint32_t idx : mapSequenceIndexes) {
         // mapSCollection.push_back(tracebackPath(mem, idx));
         SwapSeqVector swapSeqCollection;
-        auto seq = tracebackPath(mem, idx);
+        auto seq = tracebackPath(collection, mem, idx);
 
         uint32_t swapCost = 0;
         uint32_t mappingCost = seq.mappingCost;
@@ -441,6 +728,10 @@ BoundedMappingTreeQAllocator::phase2(const MCandidateVCollection& collection) {
     }
 
     normalize(best);
+
+    tracebackTimer.stop();
+    Phase2Time += (double) tracebackTimer.getMicroseconds() / 1000000.0;
+
     return best;
 }
 
@@ -453,20 +744,19 @@ Mapping BoundedMappingTreeQAllocator::phase3(QModule::Ref qmod, const MappingSwa
     auto initial = mss.mappingV[idx];
     auto mapping = initial;
 
-    QubitRemapVisitor visitor(mapping, mXtoN);
-    std::vector<Node::uRef> issuedInstructions;
+    // The instructions are issued into a flat stream, and turned into
+    // statements only once, at the end.
+    auto& stream = *mStream;
+    auto issued = InstructionStream::WithTablesOf(stream);
 
     for (auto& partition : mPP) {
-        for (auto& node : partition) {
-        // for (auto& iDependencies : deps) {
+        for (uint32_t i : partition) {
             // We are sure that there are no instruction dependency that has more than
             // one dependency.
-            auto iDependencies = mDBuilder.getDeps(node);
+            auto iDependencies = mDBuilder->getDepsAt(i);
 
             if (iDependencies.size() < 1) {
-                auto cloned = node->clone();
-                cloned->apply(&visitor);
-                issuedInstructions.push_back(std::move(cloned));
+                issued.appendMapped(stream, i, mapping);
                 continue;
             }
 
@@ -492,22 +782,17 @@ Mapping BoundedMappingTreeQAllocator::phase3(QModule::Ref qmod, const MappingSwa
                     if (!mArchGraph->hasEdge(u, v)) {
                         std::swap(u, v);
                     }
-                    issuedInstructions.push_back(CreateISwap(mArchGraph->getNode(u)->clone(),
-                                                             mArchGraph->getNode(v)->clone()));
+                    issued.append(InstructionStream::K_SWAP, { u, v });
                 }
 
                 u = mapping[a];
                 v = mapping[b];
             }
 
-            Node::uRef newNode;
-
             if (mArchGraph->hasEdge(u, v)) {
-                newNode = node->clone();
-                newNode->apply(&visitor);
+                issued.appendMapped(stream, i, mapping);
             } else if (mArchGraph->hasEdge(v, u)) {
-                newNode = CreateIRevCX(mArchGraph->getNode(u)->clone(),
-                                       mArchGraph->getNode(v)->clone());
+                issued.append(InstructionStream::K_REV_CX, { u, v }, stream.getCond(i));
             } else {
                 EfdAbortIf(true,
                            "Mapping " << MappingToString(mapping) <<
@@ -515,11 +800,10 @@ Mapping BoundedMappingTreeQAllocator::phase3(QModule::Ref qmod, const MappingSwa
                            << a << "{" << u << "}, "
                            << b << "{" << v << "})");
             }
-
-            issuedInstructions.push_back(std::move(newNode));
         }
     }
 
+    auto issuedInstructions = issued.materialize(*mXtoN);
     qmod->clearStatements();
     qmod->insertStatementLast(std::move(issuedInstructions));
 
@@ -558,23 +842,34 @@ Mapping BoundedMappingTreeQAllocator::allocate(QModule::Ref qmod) {
 
     mMaxChildren = MaxChildren.getVal();
     mMaxPartial = MaxPartialSolutions.getVal();
+    mThreads = Threads.getVal();
+
+    mDBuilder = PassCache::GetData<DependencyBuilderWrapperPass>(qmod);
+    mXtoN = PassCache::GetData<XbitToNumberWrapperPass>(qmod);
+    mStream = PassCache::GetData<InstructionStreamWrapperPass>(qmod);
 
-    mDBuilder = PassCache::Get<DependencyBuilderWrapperPass>(qmod)->getData();
-    mXtoN = PassCache::Get<XbitToNumberWrapperPass>(qmod)->getData();
+    EfdAbortIf(qmod->getNumberOfStmts() != mStream->size(),
+               "Instruction stream out of date (`" << mStream->size() << "` instructions for `"
+               << qmod->getNumberOfStmts() << "` statements).");
 
-    uint32_t nofDeps = mDBuilder.getDependencies().size();
+    uint32_t nofDeps = mDBuilder->getDependencies().size();
     auto initialMapping = IdentityMapping(mPQubits);
+    mPrunedTransitions = 0;
 
     if (nofDeps > 0) {
-        Timer tPhase1, tPhase2, tPhase3;
+        Timer tPhase1, tPhase3;
+
+        mPhase1Growths = 0;
+        mDedupeTotal = 0;
+        mDedupeRemoved = 0;
 
         tPhase1.start();
         auto phase1Output = phase1();
         tPhase1.stop();
 
-        tPhase2.start();
+        // Phase 2 accumulates the wall-clock time of each of its layers.
+        Phase2Time = 0;
         auto phase2Output = phase2(phase1Output);
-        tPhase2.stop();
 
         tPhase3.start();
         initialMapping = phase3(qmod, phase2Output);
@@ -582,9 +877,13 @@ Mapping BoundedMappingTreeQAllocator::allocate(QModule::Ref qmod) {
 
         // Stats collection.
         Phase1Time = (double) tPhase1.getMilliseconds() / 1000.0;
-        Phase2Time = (double) tPhase2.getMilliseconds() / 1000.0;
         Phase3Time = (double) tPhase3.getMilliseconds() / 1000.0;
         Partitions = mPP.size();
+        Phase1Growths = mPhase1Growths;
+
+        if (mDedupe) {
+            DedupeRatio = (mDedupeTotal == 0) ? 0.0 : (double) mDedupeRemoved / mDedupeTotal;
+        }
     }
 
     return initialMapping;
@@ -625,6 +924,20 @@ void BoundedMappingTreeQAllocator::setTokenSwapFinder
     mTSFinder = std::move(finder);
 }
 
+void BoundedMappingTreeQAllocator::setDedupeCandidates
+(bool dedupe) {
+    mDedupe = dedupe;
+}
+
+void BoundedMappingTreeQAllocator::setPhase2Pruning
+(bool prune) {
+    mPrune = prune;
+}
+
+uint64_t BoundedMappingTreeQAllocator::getPrunedTransitions() const {
+    return mPrunedTransitions;
+}
+
 BoundedMappingTreeQAllocator::uRef
 BoundedMappingTreeQAllocator::Create(ArchGraph::sRef ag) {
     return uRef(new BoundedMappingTreeQAllocator(ag));
@@ -1,7 +1,6 @@
 #include "enfield/Transform/Allocators/ChallengeWinnerQAllocator.h"
 #include "enfield/Transform/CircuitGraphBuilderPass.h"
-#include "enfield/Transform/QubitRemapPass.h"
-#include "enfield/Transform/Utils.h"
+#include "enfield/Transform/InstructionStream.h"
 #include "enfield/Transform/PassCache.h"
 #include "enfield/Support/Defs.h"
 
@@ -102,8 +101,8 @@ SwapSeq ChallengeWinnerQAllocator::astar(const std::vector<Dep>& dependencies,
                 child.qUsed[v] = true;
 
                 for (auto& dep : dependencies) {
-                    uint32_t dist = mDistance.get(child.mapping[dep.mFrom],
-                                                  child.mapping[dep.mTo]);
+                    uint32_t dist = mDistance->get(child.mapping[dep.mFrom],
+                                                   child.mapping[dep.mTo]);
 
                     if (dist == 1) child.finished = true;
                     child.cost += dist;
@@ -123,7 +122,7 @@ Mapping ChallengeWinnerQAllocator::allocate(QModule::Ref qmod) {
     auto& xbitToN = depBuilder.getXbitToNumber();
 
     auto cgbpass = PassCache::Get<CircuitGraphBuilderPass>(qmod);
-    auto cgraph = cgbpass->getData();
+    auto& cgraph = cgbpass->getData();
     auto it = cgraph.build_iterator();
 
     auto xbitNumber = cgraph.size();
@@ -131,12 +130,18 @@ Mapping ChallengeWinnerQAllocator::allocate(QModule::Ref qmod) {
     Mapping mapping(mVQubits, _undef);
     InverseMap inverse(mPQubits, _undef);
 
-    std::vector<Node::uRef> allocatedStatements;
     std::map<Node::Ref, uint32_t> reached;
 
-    QubitRemapVisitor visitor(mapping, xbitToN);
+    auto stream = PassCache::GetData<InstructionStreamWrapperPass>(qmod);
+    EfdAbortIf(qmod->getNumberOfStmts() != stream->size(),
+               "Instruction stream out of date (`" << stream->size() << "` instructions for `"
+               << qmod->getNumberOfStmts() << "` statements).");
 
-    mDistance.init(mArchGraph.get());
+    // The instructions are issued into a flat stream, and turned into
+    // statements only once, at the end.
+    auto issued = InstructionStream::WithTablesOf(*stream);
+
+    mDistance = mArchGraph->getDistanceTable();
 
     for (uint32_t i = 0; i < xbitNumber; ++i) {
         it.next(i);
@@ -157,10 +162,9 @@ Mapping ChallengeWinnerQAllocator::allocate(QModule::Ref qmod) {
 
             for (uint32_t i = 0; i < xbitNumber; ++i) {
                 auto cnode = it[i];
-                auto node = it.get(i);
 
                 if (cnode->isGateNode()) {
-                    auto dep = depBuilder.getDeps(node);
+                    auto dep = depBuilder.getDepsAt(cnode->index());
 
                     if (dep.size() == 0 && cnode->numberOfXbits() == reached[it.get(i)]) {
                         for (uint32_t i : cnode->getXbitsId()) {
@@ -173,9 +177,7 @@ Mapping ChallengeWinnerQAllocator::allocate(QModule::Ref qmod) {
                             ++reached[it.get(i)];
                         }
 
-                        auto clone = node->clone();
-                        clone->apply(&visitor);
-                        allocatedStatements.push_back(std::move(clone));
+                        issued.appendMapped(*stream, cnode->index(), mapping);
 
                         changed = true;
                     }
@@ -196,8 +198,7 @@ Mapping ChallengeWinnerQAllocator::allocate(QModule::Ref qmod) {
         if (allocatable.empty()) break;
 
         for (auto cnode : allocatable) {
-            auto node = cnode->node();
-            auto deps = depBuilder.getDeps(node);
+            auto deps = depBuilder.getDepsAt(cnode->index());
             EfdAbortIf(deps.size() != 1,
                        "Can only handle gates with one or less dependencies.");
             auto dep = deps[0];
@@ -229,7 +230,7 @@ Mapping ChallengeWinnerQAllocator::allocate(QModule::Ref qmod) {
                 for (auto bQ : bCandidates) {
                     if (aQ == bQ) continue;
 
-                    uint32_t dist = mDistance.get(aQ, bQ);
+                    uint32_t dist = mDistance->get(aQ, bQ);
 
                     if (dist < best.dist) {
                         best.dist = dist;
@@ -257,9 +258,7 @@ Mapping ChallengeWinnerQAllocator::allocate(QModule::Ref qmod) {
                     ++reached[it.get(i)];
                 }
 
-                auto clone = node->clone();
-                clone->apply(&visitor);
-                allocatedStatements.push_back(std::move(clone));
+                issued.appendMapped(*stream, cnode->index(), mapping);
                 redo = true;
             } else {
                 dependencies.push_back(dep);
@@ -282,9 +281,7 @@ Mapping ChallengeWinnerQAllocator::allocate(QModule::Ref qmod) {
         swapSequence.insert(swapSequence.end(), swaps.begin(), swaps.end());
 
         for (auto swap : swaps) {
-            allocatedStatements.push_back(
-                    CreateISwap(mArchGraph->getNode(swap.u)->clone(),
-                                mArchGraph->getNode(swap.v)->clone()));
+            issued.append(InstructionStream::K_SWAP, { swap.u, swap.v });
 
             uint32_t a = inverse[swap.u];
             uint32_t b = inverse[swap.v];
@@ -297,8 +294,9 @@ Mapping ChallengeWinnerQAllocator::allocate(QModule::Ref qmod) {
         freeSwaps.clear();
     }
 
+    auto issuedInstructions = issued.materialize(xbitToN);
     qmod->clearStatements();
-    qmod->insertStatementLast(std::move(allocatedStatements));
+    qmod->insertStatementLast(std::move(issuedInstructions));
 
     Fill(mVQubits, mapping);
     Fill(mPQubits, inverse);
@@ -33,11 +33,11 @@ GreedyCktQAllocator::GreedyCktQAllocator(ArchGraph::sRef ag) : StdSolutionQAlloc
 
 StdSolution GreedyCktQAllocator::buildStdSolution(QModule::Ref qmod) {
     auto depPass = PassCache::Get<DependencyBuilderWrapperPass>(qmod);
-    auto depBuilder = depPass->getData();
+    auto& depBuilder = depPass->getData();
     auto& depsVector = depBuilder.getDependencies();
 
     auto cgbpass = PassCache::Get<CircuitGraphBuilderPass>(qmod);
-    auto cgraph = cgbpass->getData();
+    auto& cgraph = cgbpass->getData();
     auto it = cgraph.build_iterator();
 
     auto xbitNumber = cgraph.size();
@@ -115,7 +115,7 @@ StdSolution GreedyCktQAllocator::buildStdSolution(QModule::Ref qmod) {
         // Removing instructions that don't use only one qubit, but do not have any dependencies
         for (auto cnode : allocatable) {
             auto node = cnode->node();
-            auto dep = depBuilder.getDeps(node);
+            auto dep = depBuilder.getDepsAt(cnode->index());
 
             if (dep.size() == 0) {
                 redo = true;
@@ -138,8 +138,7 @@ StdSolution GreedyCktQAllocator::buildStdSolution(QModule::Ref qmod) {
         for (auto cnode : allocatable) {
             // Calculate cost for allocating cnode->node;
 
-            auto node = cnode->node();
-            auto dep = depBuilder.getDeps(node);
+            auto dep = depBuilder.getDepsAt(cnode->index());
 
             EfdAbortIf(dep.size() > 1,
                        "Can only allocate gates with at most one depenency."
@@ -265,7 +264,7 @@ StdSolution GreedyCktQAllocator::buildStdSolution(QModule::Ref qmod) {
             std::swap(inv[u], inv[v]);
         }
 
-        auto dep = depBuilder.getDeps(node)[0];
+        auto dep = depBuilder.getDepsAt(best.cnode->index())[0];
         uint32_t a = dep.mFrom, b = dep.mTo;
 
         frozen[a] = true;
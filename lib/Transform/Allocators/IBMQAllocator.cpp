@@ -1,15 +1,10 @@
 #include "enfield/Transform/Allocators/IBMQAllocator.h"
 #include "enfield/Transform/PassCache.h"
-#include "enfield/Support/BFSPathFinder.h"
 
-#include <chrono>
 #include <random>
 
 using namespace efd;
 
-static Opt<uint32_t> Seed
-("seed", "Seed to be used in random algorithms.",
-std::chrono::system_clock::now().time_since_epoch().count(), false);
 static Opt<uint32_t> Trials
 ("trials", "Number of times that IBMQAllocator should try.", 20, false);
 
@@ -20,7 +15,8 @@ IBMQAllocator::uRef IBMQAllocator::Create(ArchGraph::sRef archGraph) {
 }
 
 IBMQAllocator::AllocationResult IBMQAllocator::tryAllocateLayer
-(Layer& layer, Mapping current, std::set<uint32_t> qubitsSet, DependencyBuilder& depData) {
+(const std::vector<uint32_t>& layer, Mapping current, std::set<uint32_t> qubitsSet,
+ const DependencyBuilder& depData) {
     AllocationResult result { current, true, {}, false };
     InverseMap inv = InvertMapping(mPQubits, current);
 
@@ -28,12 +24,12 @@ IBMQAllocator::AllocationResult IBMQAllocator::tryAllocateLayer
     std::normal_distribution<double> distribution(0.0, (double) (1 / (double) mPQubits));
 
     std::vector<Dep> deps;
-    for (auto node : layer) {
-        auto _deps = depData.getDeps(node);
+    for (uint32_t i : layer) {
+        auto _deps = depData.getDepsAt(i);
 
         EfdAbortIf(_deps.size() > 1,
                    "Not suporting gates with more than 1 dependency ("
-                   << node->toString(false) << ").");
+                   << _deps.mCallPoint->toString(false) << ").");
 
         if (_deps.size() == 1) {
             deps.push_back(_deps[0]);
@@ -43,7 +39,7 @@ IBMQAllocator::AllocationResult IBMQAllocator::tryAllocateLayer
     uint32_t dist = 0;
     for (auto dep : deps) {
         uint32_t u = current[dep.mFrom], v = current[dep.mTo];
-        dist += mDist[u][v];
+        dist += mDist->get(u, v);
     }
 
     if (dist == deps.size()) {
@@ -68,7 +64,7 @@ IBMQAllocator::AllocationResult IBMQAllocator::tryAllocateLayer
         for (uint32_t i = 0; i < mPQubits; ++i)
             for (uint32_t j = 0; j < mPQubits; ++j) {
                 double scale = 1 + distribution(generator);
-                rDist[i][j] = scale * mDist[i][j] * mDist[i][j];
+                rDist[i][j] = scale * mDist->get(i, j) * mDist->get(i, j);
                 rDist[j][i] = rDist[i][j];
             }
 
@@ -133,7 +129,7 @@ IBMQAllocator::AllocationResult IBMQAllocator::tryAllocateLayer
             uint32_t dist = 0;
             for (auto dep : deps) {
                 uint32_t u = trialMap[dep.mFrom], v = trialMap[dep.mTo];
-                dist += mDist[u][v];
+                dist += mDist->get(u, v);
             }
 
             if (dist == deps.size()) {
@@ -146,7 +142,7 @@ IBMQAllocator::AllocationResult IBMQAllocator::tryAllocateLayer
         uint32_t dist = 0;
         for (auto dep : deps) {
             uint32_t u = trialMap[dep.mFrom], v = trialMap[dep.mTo];
-            dist += mDist[u][v];
+            dist += mDist->get(u, v);
         }
 
         if (dist == deps.size() && d < bestD) {
@@ -174,22 +170,14 @@ StdSolution IBMQAllocator::buildStdSolution(QModule::Ref qmod) {
     StdSolution sol;
 
     auto dbwPass = PassCache::Get<DependencyBuilderWrapperPass>(qmod);
-    auto depData = dbwPass->getData();
+    auto& depData = dbwPass->getData();
 
     auto lbPass = PassCache::Get<LayersBuilderPass>(qmod);
-    auto layers = lbPass->getData();
-
-    BFSPathFinder bfs;
+    auto& layers = lbPass->getIndexes();
 
     mPQubits = mArchGraph->size();
-    mLQubits = depData.mXbitToNumber.getQSize();
-    mDist.assign(mPQubits, std::vector<uint32_t>(mPQubits, _undef));
-
-    for (uint32_t i = 0; i < mPQubits; ++i) {
-        for (uint32_t j = 0; j < mPQubits; ++j) {
-            mDist[i][j] = bfs.find(mArchGraph.get(), i, j).size() - 1;
-        }
-    }
+    mLQubits = depData.getXbitToNumber().getQSize();
+    mDist = mArchGraph->getDistanceTable();
 
     Mapping current(mPQubits, 0);
     std::vector<bool> allocated(mPQubits, false);
@@ -226,8 +214,8 @@ StdSolution IBMQAllocator::buildStdSolution(QModule::Ref qmod) {
             uint32_t opsSeqIdx = sol.mOpSeqs.size();
 
             for (auto it = layer.begin(), end = layer.end(); it != end; ++it) {
-                auto node = *it;
-                auto deps = depData.getDeps(node);
+                auto node = qmod->getStatement(*it);
+                auto deps = depData.getDepsAt(*it);
 
                 auto clone = node->clone();
 
@@ -263,8 +251,9 @@ StdSolution IBMQAllocator::buildStdSolution(QModule::Ref qmod) {
         } else {
             INF << "Serializing this layer!" << std::endl;
 
-            for (auto node : layer) {
-                Layer sublayer { node };
+            for (uint32_t s : layer) {
+                auto node = qmod->getStatement(s);
+                std::vector<uint32_t> sublayer { s };
 
                 auto result = tryAllocateLayer(sublayer, current, qubitsSet, depData);
 
@@ -280,7 +269,7 @@ StdSolution IBMQAllocator::buildStdSolution(QModule::Ref qmod) {
                     firstLayer = false;
                 }
 
-                auto deps = depData.getDeps(node);
+                auto deps = depData.getDepsAt(s);
                 auto clone = node->clone();
 
                 StdSolution::OpVector opVector;
@@ -1,14 +1,28 @@
 #include "enfield/Transform/Allocators/JKUQAllocator.h"
 #include "enfield/Transform/LayersBuilderPass.h"
-#include "enfield/Transform/QubitRemapPass.h"
 #include "enfield/Transform/PassCache.h"
+#include "enfield/Support/CommandLine.h"
 #include "enfield/Support/Defs.h"
-#include "enfield/Support/RTTI.h"
-#include "enfield/Support/uRefCast.h"
+
+#include <algorithm>
+#include <unordered_map>
 
 using namespace efd;
 using namespace jku;
 
+Opt<uint32_t> efd::JKUMaxNodes
+("-jku-max-nodes", "Limits the number of A* nodes kept in memory by `Q_jku`.",
+ 500000, false);
+
+Opt<uint32_t> efd::JKUBeamWidth
+("-jku-beam-width", "Number of open A* nodes kept when `-jku-max-nodes` is reached.",
+ 1000, false);
+
+Stat<uint32_t> efd::JKUDuplicates
+("JKUDuplicates", "Number of A* nodes dropped because their mapping was already expanded.");
+Stat<uint32_t> efd::JKUBeamFallbacks
+("JKUBeamFallbacks", "Number of times the A* search of `Q_jku` was cut down to a beam.");
+
 namespace efd {
 namespace jku {
 
@@ -17,14 +31,165 @@ namespace jku {
         uint32_t costTableHeur = 0;
         uint32_t costNextHeur = 0;
         uint32_t depth = 0;
-        Mapping m;
-        InverseMap inv;
-        std::vector<Swap> swaps;
+        /// \brief Last swap (in the `AStarPool`) of the history of this node.
+        uint32_t lastSwap = _undef;
         bool finished = true;
     };
 
+    /// \brief One swap of a history, linked to the swap before it.
+    ///
+    /// Children share the history of their parent, so that a new node
+    /// only stores the swaps it adds.
+    struct SwapLink {
+        Swap swap;
+        uint32_t prev;
+    };
+
+    /// \brief Storage for the nodes of one A* search.
+    ///
+    /// Nodes are referred to by their index. Their mapping and inverse
+    /// are stored contiguously, one row per node.
+    class AStarPool {
+        private:
+            uint32_t mVQubits;
+            uint32_t mStride;
+
+            std::vector<AStarNode> mNodes;
+            std::vector<uint32_t> mRows;
+            std::vector<SwapLink> mLinks;
+
+        public:
+            AStarPool(uint32_t vQubits, uint32_t pQubits)
+                : mVQubits(vQubits), mStride(vQubits + pQubits) {}
+
+            void clear() {
+                mNodes.clear();
+                mRows.clear();
+                mLinks.clear();
+            }
+
+            uint32_t size() const { return mNodes.size(); }
+
+            /// \brief Appends \p node with a copy of \p m and \p inv.
+            uint32_t push(const AStarNode& node, const uint32_t* m, const uint32_t* inv) {
+                mNodes.push_back(node);
+                mRows.insert(mRows.end(), m, m + mVQubits);
+                mRows.insert(mRows.end(), inv, inv + mStride - mVQubits);
+                return mNodes.size() - 1;
+            }
+
+            /// \brief Removes the last node pushed.
+            void pop() {
+                mNodes.pop_back();
+                mRows.resize(mRows.size() - mStride);
+            }
+
+            /// \brief Links \p swap after the swap \p prev, returning its index.
+            uint32_t pushSwap(uint32_t prev, Swap swap) {
+                mLinks.push_back(SwapLink { swap, prev });
+                return mLinks.size() - 1;
+            }
+
+            AStarNode& node(uint32_t i) { return mNodes[i]; }
+            const AStarNode& node(uint32_t i) const { return mNodes[i]; }
+            uint32_t* mapping(uint32_t i) { return &mRows[i * mStride]; }
+            uint32_t* inverse(uint32_t i) { return &mRows[i * mStride + mVQubits]; }
+
+            /// \brief Returns the swap history of node \p i, in order.
+            std::vector<Swap> swaps(uint32_t i) const {
+                std::vector<Swap> swaps;
+
+                for (auto l = mNodes[i].lastSwap; l != _undef; l = mLinks[l].prev) {
+                    swaps.push_back(mLinks[l].swap);
+                }
+
+                std::reverse(swaps.begin(), swaps.end());
+                return swaps;
+            }
+
+            /// \brief Drops every node, but the ones in \p ids (and their histories).
+            ///
+            /// \p ids is updated with the new indices.
+            void keepOnly(std::vector<uint32_t>& ids) {
+                AStarPool pool(mVQubits, mStride - mVQubits);
+
+                for (auto& id : ids) {
+                    auto swaps = this->swaps(id);
+                    auto node = mNodes[id];
+
+                    node.lastSwap = _undef;
+                    for (const auto& s : swaps) {
+                        node.lastSwap = pool.pushSwap(node.lastSwap, s);
+                    }
+
+                    id = pool.push(node, mapping(id), inverse(id));
+                }
+
+                std::swap(mNodes, pool.mNodes);
+                std::swap(mRows, pool.mRows);
+                std::swap(mLinks, pool.mLinks);
+            }
+    };
+
+    /// \brief Mappings already expanded by one A* search.
+    ///
+    /// The mappings are copied, so that they outlive the nodes of the pool
+    /// (see \em AStarPool::keepOnly). Mappings with the same hash are told
+    /// apart by comparing them. Each entry counts as a node towards
+    /// `-jku-max-nodes`.
+    class ClosedSet {
+        private:
+            uint32_t mVQubits;
+            std::vector<uint32_t> mRows;
+            std::unordered_multimap<uint64_t, uint32_t> mIndex;
+
+            bool find(const uint32_t* m, uint64_t h) const {
+                auto range = mIndex.equal_range(h);
+
+                for (auto it = range.first; it != range.second; ++it) {
+                    auto row = &mRows[it->second * mVQubits];
+                    if (std::equal(m, m + mVQubits, row)) return true;
+                }
+
+                return false;
+            }
+
+        public:
+            ClosedSet(uint32_t vQubits) : mVQubits(vQubits) {}
+
+            bool contains(const uint32_t* m) const {
+                return find(m, HashMapping(m, mVQubits));
+            }
+
+            /// \brief Returns the number of mappings in the set.
+            uint32_t size() const {
+                return mIndex.size();
+            }
+
+            /// \brief Removes every mapping, releasing their memory.
+            void clear() {
+                ClosedSet empty(mVQubits);
+                std::swap(mRows, empty.mRows);
+                std::swap(mIndex, empty.mIndex);
+            }
+
+            /// \brief Inserts a copy of \p m. Returns false if it was already there.
+            bool insert(const uint32_t* m) {
+                uint64_t h = HashMapping(m, mVQubits);
+                if (find(m, h)) return false;
+
+                mIndex.insert(std::make_pair(h, mRows.size() / mVQubits));
+                mRows.insert(mRows.end(), m, m + mVQubits);
+                return true;
+            }
+    };
+
     struct AStarNodeCompare {
-    	bool operator()(const AStarNode& lhs, const AStarNode& rhs) const {
+        const AStarPool* pool;
+
+    	bool operator()(uint32_t l, uint32_t r) const {
+            const auto& lhs = pool->node(l);
+            const auto& rhs = pool->node(r);
             uint32_t lhsTotal = lhs.costFixed + lhs.costTableHeur + lhs.costNextHeur;
             uint32_t rhsTotal = rhs.costFixed + rhs.costTableHeur + rhs.costNextHeur;
             if (lhsTotal != rhsTotal) return lhsTotal > rhsTotal;
@@ -34,36 +199,45 @@ namespace jku {
     	}
     };
 
-    using AStarPQueue = std::priority_queue<AStarNode, std::vector<AStarNode>, AStarNodeCompare>;
+    using AStarPQueue = std::priority_queue<uint32_t, std::vector<uint32_t>, AStarNodeCompare>;
 
     struct ExpandNodeState {
+        AStarPool& pool;
         AStarPQueue& queue;
+        const ClosedSet& closed;
         const std::vector<uint32_t>& qubitsInLayer;
         std::vector<bool>& processed;
         std::vector<Swap> swaps;
-        const Layers& layers;
-        const uint32_t currentLayer;
-        const uint32_t nextLayer;
+        const std::vector<Dep>& currentDeps;
+        const std::vector<Dep>& nextDeps;
+        const bool hasNextLayer;
+
+        // Copy of the node being expanded, since the pool may grow.
+        AStarNode parent;
+        Mapping m;
+        InverseMap inv;
     };
 }
 }
 
 JKUQAllocator::JKUQAllocator(ArchGraph::sRef archGraph)
-    : QbitAllocator(archGraph) {}
+    : QbitAllocator(archGraph), mMaxNodes(_undef), mBeamWidth(_undef) {}
 
 void JKUQAllocator::buildCostTable() {
+    auto table = mArchGraph->getDistanceTable();
     mTable.assign(mPQubits, std::vector<uint32_t>(mPQubits, 0));
 
     for (uint32_t u = 0; u < mPQubits; ++u) {
         for (uint32_t v = 0; v < mPQubits; ++v) {
             if (u == v) mTable[u][v] = 0;
             else {
-                auto path = mBFS.find(mArchGraph.get(), u, v);
-                mTable[u][v] = (path.size() - 2) * 7;
+                mTable[u][v] = (table->get(u, v) - 1) * 7;
 
+                // Walks the path backwards, from `v` to `u`.
                 bool onlyRevEdge = true;
-                for (uint32_t i = 0, e = path.size(); i < e - 1; ++i) {
-                    if (mArchGraph->hasEdge(path[i], path[i + 1])) {
+                for (uint32_t x = v, p = table->prev(u, v); p != _undef;
+                        x = p, p = table->prev(u, p)) {
+                    if (mArchGraph->hasEdge(p, x)) {
                         onlyRevEdge = false;
                         break;
                     }
@@ -77,47 +251,51 @@ void JKUQAllocator::buildCostTable() {
     }
 }
 
-void JKUQAllocator::expandNodeRecursively(const AStarNode& aNode,
-                                          uint32_t i,
-                                          ExpandNodeState& state) {
+void JKUQAllocator::expandNodeRecursively(uint32_t i, ExpandNodeState& state) {
     if (i == state.qubitsInLayer.size()) {
         if (state.swaps.empty()) return;
 
+        auto& pool = state.pool;
+
         AStarNode newNode;
-        newNode.m = aNode.m;
-        newNode.inv = aNode.inv;
-        newNode.swaps = aNode.swaps;
-        newNode.depth = aNode.depth + 5;
-        newNode.costFixed = aNode.costFixed + 7 * state.swaps.size();
+        newNode.depth = state.parent.depth + 5;
+        newNode.costFixed = state.parent.costFixed + 7 * state.swaps.size();
+        newNode.lastSwap = state.parent.lastSwap;
         newNode.finished = true;
 
+        auto id = pool.push(newNode, state.m.data(), state.inv.data());
+        auto m = pool.mapping(id);
+        auto inv = pool.inverse(id);
+
         for (auto& s : state.swaps) {
-            uint32_t a = newNode.inv[s.u], b = newNode.inv[s.v];
-            if (a != _undef) newNode.m[a] = s.v;
-            if (b != _undef) newNode.m[b] = s.u;
-            std::swap(newNode.inv[s.u], newNode.inv[s.v]);
+            uint32_t a = inv[s.u], b = inv[s.v];
+            if (a != _undef) m[a] = s.v;
+            if (b != _undef) m[b] = s.u;
+            std::swap(inv[s.u], inv[s.v]);
         }
 
-        newNode.swaps.insert(newNode.swaps.end(), state.swaps.begin(), state.swaps.end());
-
-        for (auto node : state.layers[state.currentLayer]) {
-            auto deps = mDBuilder.getDeps(node);
-            if (!deps.empty()) {
-                auto dep = deps[0];
-                auto cost = mTable[newNode.m[dep.mFrom]][newNode.m[dep.mTo]];
-                newNode.costTableHeur += cost;
-                newNode.finished = newNode.finished && cost <= 4;
-            }
+        if (state.closed.contains(m)) {
+            pool.pop();
+            JKUDuplicates += 1;
+            return;
         }
 
-        if (state.nextLayer != _undef) {
-            for (auto node : state.layers[state.nextLayer]) {
-                auto deps = mDBuilder.getDeps(node);
+        auto& node = pool.node(id);
+
+        for (auto& s : state.swaps) {
+            node.lastSwap = pool.pushSwap(node.lastSwap, s);
+        }
 
-                if (deps.empty()) continue;
+        for (const auto& dep : state.currentDeps) {
+            auto cost = mTable[m[dep.mFrom]][m[dep.mTo]];
+            node.costTableHeur += cost;
+            node.finished = node.finished && cost <= 4;
+        }
 
-                uint32_t a = deps[0].mFrom, b = deps[0].mTo;
-                uint32_t u = newNode.m[a], v = newNode.m[b];
+        if (state.hasNextLayer) {
+            for (const auto& dep : state.nextDeps) {
+                uint32_t a = dep.mFrom, b = dep.mTo;
+                uint32_t u = m[a], v = m[b];
                 uint32_t costHeur = 0;
 
                 if (u != v && (u == _undef || v == _undef)) {
@@ -129,11 +307,11 @@ void JKUQAllocator::expandNodeRecursively(const AStarNode& aNode,
                         mapped = a;
                     }
 
-                    uint32_t u = newNode.m[mapped];
+                    uint32_t u = m[mapped];
                     uint32_t minCost = _undef;
                     for (uint32_t v = 0; v < mPQubits; ++v) {
                         auto cost = mTable[u][v];
-                        if (newNode.inv[v] == _undef && cost < minCost) {
+                        if (inv[v] == _undef && cost < minCost) {
                             minCost = cost;
                         }
                     }
@@ -143,15 +321,15 @@ void JKUQAllocator::expandNodeRecursively(const AStarNode& aNode,
                     costHeur =  mTable[u][v];
                 }
 
-                newNode.costNextHeur += costHeur;
+                node.costNextHeur += costHeur;
             }
         }
 
-        state.queue.push(newNode);
+        state.queue.push(id);
     } else {
-        expandNodeRecursively(aNode, i + 1, state);
+        expandNodeRecursively(i + 1, state);
 
-        uint32_t _u = aNode.m[state.qubitsInLayer[i]];
+        uint32_t _u = state.m[state.qubitsInLayer[i]];
         if (!state.processed[_u]) {
             for (auto _v : mArchGraph->adj(_u)) {
                 if (!state.processed[_v]) {
@@ -161,7 +339,7 @@ void JKUQAllocator::expandNodeRecursively(const AStarNode& aNode,
                     state.processed[v] = true;
                     state.swaps.push_back(Swap { u, v });
 
-                    expandNodeRecursively(aNode, i + 1, state);
+                    expandNodeRecursively(i + 1, state);
 
                     state.swaps.pop_back();
                     state.processed[u] = false;
@@ -172,11 +350,11 @@ void JKUQAllocator::expandNodeRecursively(const AStarNode& aNode,
     }
 }
 
-AStarNode JKUQAllocator::astar(std::queue<uint32_t>& cnotLayersIdQ,
-                               const Layers& layers,
-                               uint32_t i,
-                               Mapping& mapping,
-                               InverseMap& inverse) {
+std::vector<Swap> JKUQAllocator::astar(std::queue<uint32_t>& cnotLayersIdQ,
+                                       const LayersIndexes& layers,
+                                       uint32_t i,
+                                       Mapping& mapping,
+                                       InverseMap& inverse) {
     uint32_t nextLayer;
 
     if (!cnotLayersIdQ.empty() && cnotLayersIdQ.front() == i) {
@@ -189,8 +367,8 @@ AStarNode JKUQAllocator::astar(std::queue<uint32_t>& cnotLayersIdQ,
     std::vector<uint32_t> qubitsInLayer;
     uint32_t maxCost = 0;
 
-    for (auto& node : layers[i]) {
-        auto deps = mDBuilder.getDeps(node);
+    for (uint32_t s : layers[i]) {
+        auto deps = mDBuilder->getDepsAt(s);
         if (deps.empty()) continue;
 
         uint32_t a = deps[0].mFrom, b = deps[0].mTo;
@@ -254,43 +432,107 @@ AStarNode JKUQAllocator::astar(std::queue<uint32_t>& cnotLayersIdQ,
         maxCost = std::max(maxCost, mTable[mapping[a]][mapping[b]]);
     }
 
+    // The dependencies of both layers are used by every node expanded.
+    std::vector<Dep> currentDeps, nextDeps;
+
+    for (uint32_t s : layers[i]) {
+        auto deps = mDBuilder->getDepsAt(s);
+        if (!deps.empty()) currentDeps.push_back(deps[0]);
+    }
+
+    if (nextLayer != _undef) {
+        for (uint32_t s : layers[nextLayer]) {
+            auto deps = mDBuilder->getDepsAt(s);
+            if (!deps.empty()) nextDeps.push_back(deps[0]);
+        }
+    }
+
+    AStarPool pool(mVQubits, mPQubits);
+    AStarPQueue astarQ(AStarNodeCompare { &pool });
+    ClosedSet closed(mVQubits);
+
     AStarNode aNode;
-    aNode.m = mapping;
-    aNode.inv = inverse;
     aNode.finished = (maxCost <= 4);
     aNode.costTableHeur = maxCost;
+    astarQ.push(pool.push(aNode, mapping.data(), inverse.data()));
+
+    std::vector<bool> processed(mVQubits, false);
+
+    ExpandNodeState state {
+        pool,
+        astarQ,
+        closed,
+        qubitsInLayer,
+        processed,
+        std::vector<Swap>(),
+        currentDeps,
+        nextDeps,
+        nextLayer != _undef,
+        AStarNode(),
+        Mapping(),
+        InverseMap()
+    };
 
-    AStarPQueue astarQ;
-    astarQ.push(aNode);
-
-    while (!astarQ.top().finished) {
-        auto aNode = astarQ.top();
+    while (!pool.node(astarQ.top()).finished) {
+        auto id = astarQ.top();
         astarQ.pop();
 
-        std::vector<bool> processed(mVQubits, false);
+        if (!closed.insert(pool.mapping(id))) {
+            JKUDuplicates += 1;
+            EfdAbortIf(astarQ.empty(), "No mapping satisfies layer `" << i << "`.");
+            continue;
+        }
+
+        state.parent = pool.node(id);
+        state.m.assign(pool.mapping(id), pool.mapping(id) + mVQubits);
+        state.inv.assign(pool.inverse(id), pool.inverse(id) + mPQubits);
+
+        expandNodeRecursively(0, state);
+
+        EfdAbortIf(astarQ.empty(), "No mapping satisfies layer `" << i << "`.");
+
+        if (pool.size() + closed.size() >= mMaxNodes) {
+            // Falls back to a beam: keeps only the best open nodes. If the
+            // closed set takes most of the cap, it is dropped too (a mapping
+            // may then be expanded again, at a higher cost).
+            std::vector<uint32_t> keep;
+
+            while (!astarQ.empty() && keep.size() < mBeamWidth) {
+                keep.push_back(astarQ.top());
+                astarQ.pop();
+            }
 
-        ExpandNodeState state {
-            astarQ,
-            qubitsInLayer,
-            processed,
-            std::vector<Swap>(),
-            layers,
-            i,
-            nextLayer
-        };
+            pool.keepOnly(keep);
+            if (closed.size() >= mMaxNodes / 2) closed.clear();
 
-        expandNodeRecursively(aNode, 0, state);
+            astarQ = AStarPQueue(AStarNodeCompare { &pool });
+            for (auto id : keep) astarQ.push(id);
+
+            JKUBeamFallbacks += 1;
+        }
     }
 
-    return astarQ.top();
+    auto id = astarQ.top();
+    mapping.assign(pool.mapping(id), pool.mapping(id) + mVQubits);
+    inverse.assign(pool.inverse(id), pool.inverse(id) + mPQubits);
+    return pool.swaps(id);
 }
 
 Mapping JKUQAllocator::allocate(QModule::Ref qmod) {
+    mMaxNodes = std::max(JKUMaxNodes.getVal(), 2u);
+    // The beam must be smaller than the pool, so that it does free some memory.
+    mBeamWidth = std::max(std::min(JKUBeamWidth.getVal(), mMaxNodes / 2), 1u);
+
     buildCostTable();
 
-    auto layers = PassCache::Get<LayersBuilderPass>(qmod)->getData();
-    mDBuilder = PassCache::Get<DependencyBuilderWrapperPass>(qmod)->getData();
-    auto& xbitToN = mDBuilder.getXbitToNumber();
+    auto& layers = PassCache::Get<LayersBuilderPass>(qmod)->getIndexes();
+    mDBuilder = PassCache::GetData<DependencyBuilderWrapperPass>(qmod);
+    mStream = PassCache::GetData<InstructionStreamWrapperPass>(qmod);
+    auto& xbitToN = mDBuilder->getXbitToNumber();
+
+    EfdAbortIf(qmod->getNumberOfStmts() != mStream->size(),
+               "Instruction stream out of date (`" << mStream->size() << "` instructions for `"
+               << qmod->getNumberOfStmts() << "` statements).");
 
     Mapping mapping(mVQubits, _undef);
     InverseMap inverse(mPQubits, _undef);
@@ -298,90 +540,74 @@ Mapping JKUQAllocator::allocate(QModule::Ref qmod) {
     // Storing all layers index that have at least a CNOT gate.
     std::queue<uint32_t> cnotLayersIdQ;
     for (uint32_t i = 0, e = layers.size(); i < e; ++i) {
-        const auto& layer = layers[i];
-        for (const auto& node : layer) {
-            if (!mDBuilder.getDeps(node).empty()) {
+        for (uint32_t s : layers[i]) {
+            if (!mDBuilder->getDepsAt(s).empty()) {
                 cnotLayersIdQ.push(i);
                 break;
             }
         }
     }
 
-    std::vector<Node::Ref> unmappedSingeQubitGate;
-    std::vector<Node::uRef> newStatements;
+    // The instructions are issued into a flat stream, and turned into
+    // statements only once, at the end.
+    auto& stream = *mStream;
+    auto issued = InstructionStream::WithTablesOf(stream);
 
-    QubitRemapVisitor visitor(mapping, xbitToN);
+    // Pairs of the issued index and the source index of the instructions whose
+    // qubits were not all mapped, yet.
+    std::vector<std::pair<uint32_t, uint32_t>> unmappedSingeQubitGate;
 
     for (uint32_t i = 0, e = layers.size(); i < e; ++i) {
-        auto aNode = astar(cnotLayersIdQ, layers, i, mapping, inverse);
-
-        mapping = aNode.m;
-        inverse = aNode.inv;
+        auto swaps = astar(cnotLayersIdQ, layers, i, mapping, inverse);
 
         if (i != 0) {
-            for (const auto& s : aNode.swaps) {
-                newStatements.push_back(CreateISwap(mArchGraph->getNode(s.u)->clone(),
-                                                    mArchGraph->getNode(s.v)->clone()));
+            for (const auto& s : swaps) {
+                issued.append(InstructionStream::K_SWAP, { s.u, s.v });
             }
         }
 
-        for (auto node : layers[i]) {
-            auto deps = mDBuilder.getDeps(node);
-            auto clone = node->clone();
+        for (uint32_t s : layers[i]) {
+            auto deps = mDBuilder->getDepsAt(s);
 
             if (deps.empty()) {
-                clone->apply(&visitor);
+                auto mapped = std::all_of(stream.qargs_begin(s), stream.qargs_end(s),
+                                          [&](uint32_t a) { return mapping[a] != _undef; });
+                auto j = issued.appendMapped(stream, s, mapping);
 
-                if (!visitor.wasReplaced()) {
-                    unmappedSingeQubitGate.push_back(clone.get());
+                if (!mapped) {
+                    unmappedSingeQubitGate.push_back(std::make_pair(j, s));
                 }
             } else {
                 auto dep = deps[0];
                 uint32_t u = mapping[dep.mFrom], v = mapping[dep.mTo];
 
                 if (mArchGraph->hasEdge(u, v)) {
-                    clone->apply(&visitor);
+                    issued.appendMapped(stream, s, mapping);
                 } else {
-                    auto sPair = GetStatementPair(clone.get());
-                    auto qop = CreateIRevCX(mArchGraph->getNode(u)->clone(),
-                                            mArchGraph->getNode(v)->clone());
-
-                    if (sPair.first != nullptr) {
-                        auto ifstmt = dynCast<NDIfStmt>(clone.get());
-                        ifstmt->setQOp(std::move(qop));
-                    } else {
-                        clone = std::move(qop);
-                    }
+                    issued.append(InstructionStream::K_REV_CX, { u, v }, stream.getCond(s));
                 }
             }
-
-            newStatements.push_back(std::move(clone));
         }
     }
 
     auto singleQubitGateIt = unmappedSingeQubitGate.rbegin();
     auto singleQubitGateEnd = unmappedSingeQubitGate.rend();
 
-    for (auto it = newStatements.rbegin(), end = newStatements.rend(); it != end; ++it) {
-        auto node = it->get();
-        auto sPair = GetStatementPair(node);
-        
-        if (IsIntrinsicGateCall(sPair.second) &&
-            GetIntrinsicKind(sPair.second) == NDQOpGen::IntrinsicKind::K_INTRINSIC_SWAP) {
-            auto qargs = sPair.second->getQArgs();
-            uint32_t u = mArchGraph->getUId(qargs->getChild(0)->toString(false));
-            uint32_t v = mArchGraph->getUId(qargs->getChild(1)->toString(false));
+    for (uint32_t j = issued.size(); j-- > 0;) {
+        if (issued.getOpcode(j) == InstructionStream::K_SWAP) {
+            uint32_t u = issued.qargs_begin(j)[0];
+            uint32_t v = issued.qargs_begin(j)[1];
 
             uint32_t a = inverse[u], b = inverse[v];
             if (a != _undef) mapping[a] = v;
             if (b != _undef) mapping[b] = u;
             std::swap(inverse[u], inverse[v]);
-        } else if (singleQubitGateIt != singleQubitGateEnd && node == *singleQubitGateIt) {
+        } else if (singleQubitGateIt != singleQubitGateEnd && j == singleQubitGateIt->first) {
+            uint32_t s = singleQubitGateIt->second;
             ++singleQubitGateIt;
-            auto qargs = sPair.second->getQArgs();
 
-            for (const auto& q : *qargs) {
-                uint32_t a = xbitToN.getQUId(q->toString(false));
+            for (auto it = stream.qargs_begin(s), end = stream.qargs_end(s); it != end; ++it) {
+                uint32_t a = *it;
 
                 if (mapping[a] == _undef) {
                     for (uint32_t u = 0; u < mPQubits; ++u) {
@@ -394,12 +620,16 @@ Mapping JKUQAllocator::allocate(QModule::Ref qmod) {
                 }
             }
 
-            node->apply(&visitor);
+            // Its qubits were left as they were, so they are mapped now.
+            for (uint32_t k = issued.mQArgsBegin[j]; k < issued.mQArgsBegin[j + 1]; ++k) {
+                issued.mQArgs[k] = mapping[issued.mQArgs[k]];
+            }
         }
     }
 
+    auto issuedInstructions = issued.materialize(xbitToN);
     qmod->clearStatements();
-    qmod->insertStatementLast(std::move(newStatements));
+    qmod->insertStatementLast(std::move(issuedInstructions));
 
     Fill(mPQubits, mapping);
     return mapping;
@@ -2,7 +2,6 @@
 #include "enfield/Transform/Allocators/BMT/DefaultBMTQAllocatorImpl.h"
 #include "enfield/Transform/PassCache.h"
 #include "enfield/Transform/CircuitGraphBuilderPass.h"
-#include "enfield/Transform/QubitRemapPass.h"
 #include "enfield/Transform/Utils.h"
 #include "enfield/Analysis/NodeVisitor.h"
 #include "enfield/Support/ApproxTSFinder.h"
@@ -135,7 +134,7 @@ void LayeredBMTQAllocator::setCandidatesWeight(std::vector<MappingCandidate>& ca
             if (candidates[0].m[b] == _undef) continue;
 
             for (auto& candidate : candidates) {
-                candidate.weight += mDistance[candidate.m[a]][candidate.m[b]];
+                candidate.weight += mDistance->get(candidate.m[a], candidate.m[b]);
             }
         }
     }
@@ -181,14 +180,14 @@ std::vector<std::vector<MappingCandidate>> LayeredBMTQAllocator::phase1(QModule:
 
     INF << "PHASE 1 >>>> Solving SIP Instances" << std::endl;
 
-    for (auto& l : mLayers) {
+    for (auto& l : *mLayers) {
         candidates = { { Mapping(mVQubits, _undef), 0 } };
         mapped.assign(mVQubits, false);
 
         bool hasAtLeastOneDep = false;
 
-        for (auto& node : l) {
-            auto dependencies = mDBuilder.getDeps(node);
+        for (uint32_t i : l) {
+            auto dependencies = mDBuilder->getDepsAt(i);
 
             if (dependencies.empty()) continue;
 
@@ -204,14 +203,12 @@ std::vector<std::vector<MappingCandidate>> LayeredBMTQAllocator::phase1(QModule:
             uint32_t a = dep.mFrom, b = dep.mTo;
 
             if (!mapped[b]) {
-                partitionGraph.succ(b).clear();
-                partitionGraph.pred(b).clear();
+                partitionGraph.clearSuccAndPred(b);
                 mapped[b] = true;
             }
 
             if (!mapped[a]) {
-                partitionGraph.succ(a).clear();
-                partitionGraph.pred(a).clear();
+                partitionGraph.clearSuccAndPred(a);
                 mapped[a] = true;
             }
 
@@ -238,8 +235,8 @@ uint32_t LayeredBMTQAllocator::getNearest(uint32_t u, const InverseMap& inv) {
     uint32_t minDist = _undef;
 
     for (uint32_t v = 0; v < mPQubits; ++v) {
-        if (inv[v] == _undef && mDistance[u][v] < minDist) {
-            minDist = mDistance[u][v];
+        if (inv[v] == _undef && mDistance->get(u, v) < minDist) {
+            minDist = mDistance->get(u, v);
             minV = v;
         }
     }
@@ -268,7 +265,7 @@ uint32_t LayeredBMTQAllocator::estimateSwapCost(const Mapping& fromM, const Mapp
 
     for (uint32_t i = 0, e = fromM.size(); i < e; ++i) {
         if (fromM[i] != _undef && toM[i] != _undef) {
-            totalDistance += mDistance[fromM[i]][toM[i]];
+            totalDistance += mDistance->get(fromM[i], toM[i]);
         }
     }
 
@@ -429,13 +426,15 @@ Mapping LayeredBMTQAllocator::phase3(QModule::Ref qmod, const MappingSwapSequenc
     auto initial = mss.mappings[idx];
     auto mapping = initial;
 
-    QubitRemapVisitor visitor(mapping, mXtoN);
-    std::vector<Node::uRef> issuedInstructions;
+    // The instructions are issued into a flat stream, and turned into
+    // statements only once, at the end.
+    auto& stream = *mStream;
+    auto issued = InstructionStream::WithTablesOf(stream);
 
-    INF << "Layers: " << mLayers.size() << std::endl;
+    INF << "Layers: " << mLayers->size() << std::endl;
     INF << "Mappings: " << mss.mappings.size() << std::endl;
 
-    for (auto& l : mLayers) {
+    for (auto& l : *mLayers) {
         if (idx > 0) {
             auto swaps = mss.swapSeqs[idx - 1];
 
@@ -446,23 +445,19 @@ Mapping LayeredBMTQAllocator::phase3(QModule::Ref qmod, const MappingSwapSequenc
                     std::swap(u, v);
                 }
 
-                issuedInstructions.push_back(
-                        CreateISwap(mArchGraph->getNode(u)->clone(),
-                                    mArchGraph->getNode(v)->clone()));
+                issued.append(InstructionStream::K_SWAP, { u, v });
             }
         }
 
         mapping = mss.mappings[idx++];
 
-        for (auto& node : l) {
+        for (uint32_t i : l) {
             // We are sure that there are no instruction dependency that has more than
             // one dependency.
-            auto iDependencies = mDBuilder.getDeps(node);
+            auto iDependencies = mDBuilder->getDepsAt(i);
 
             if (iDependencies.size() < 1) {
-                auto cloned = node->clone();
-                cloned->apply(&visitor);
-                issuedInstructions.push_back(std::move(cloned));
+                issued.appendMapped(stream, i, mapping);
                 continue;
             }
 
@@ -476,24 +471,21 @@ Mapping LayeredBMTQAllocator::phase3(QModule::Ref qmod, const MappingSwapSequenc
                        "Can't satisfy dependency (" << u << ", " << v << ") "
                        << "with " << idx << "-th mapping: " << MappingToString(mapping));
 
-            Node::uRef newNode;
             if (mArchGraph->hasEdge(u, v)) {
-                newNode = node->clone();
-                newNode->apply(&visitor);
+                issued.appendMapped(stream, i, mapping);
             } else if (mArchGraph->hasEdge(v, u)) {
-                newNode = CreateIRevCX(mArchGraph->getNode(u)->clone(),
-                                       mArchGraph->getNode(v)->clone());
+                // A conditional CX keeps its condition.
+                issued.append(InstructionStream::K_REV_CX, { u, v }, stream.getCond(i));
             } else {
                 EfdAbortIf(true,
                            "Mapping " << MappingToString(mapping)
                            << " not able to satisfy dependency "
                            << "(" << a << "{" << u << "}, " << b << "{" << v << "})");
             }
-
-            issuedInstructions.push_back(std::move(newNode));
         }
     }
 
+    auto issuedInstructions = issued.materialize(*mXtoN);
     qmod->clearStatements();
     qmod->insertStatementLast(std::move(issuedInstructions));
 
@@ -503,30 +495,29 @@ Mapping LayeredBMTQAllocator::phase3(QModule::Ref qmod, const MappingSwapSequenc
 void LayeredBMTQAllocator::init(QModule::Ref qmod) {
     mMaxPartial = MaxPartialSolutions.getVal();
 
-    mDBuilder = PassCache::Get<DependencyBuilderWrapperPass>(qmod)->getData();
-    mXtoN = PassCache::Get<XbitToNumberWrapperPass>(qmod)->getData();
+    mDBuilder = PassCache::GetData<DependencyBuilderWrapperPass>(qmod);
+    mXtoN = PassCache::GetData<XbitToNumberWrapperPass>(qmod);
+    mStream = PassCache::GetData<InstructionStreamWrapperPass>(qmod);
+
+    EfdAbortIf(qmod->getNumberOfStmts() != mStream->size(),
+               "Instruction stream out of date (`" << mStream->size() << "` instructions for `"
+               << qmod->getNumberOfStmts() << "` statements).");
 
     mTSFinder = SimplifiedApproxTSFinder::Create();
     mTSFinder->setGraph(mArchGraph.get());
 
-    mBFSDistance.init(mArchGraph.get());
-    mDistance.assign(mPQubits, std::vector<uint32_t>(mPQubits, 0));
-
-    mLayers = PassCache::Get<LayersBuilderPass>(qmod)->getData();
+    mDistance = mArchGraph->getDistanceTable();
 
-    for (uint32_t i = 0; i < mPQubits; ++i) {
-        for (uint32_t j = i + 1; j < mPQubits; ++j) {
-            auto dist = mBFSDistance.get(i, j);
-            mDistance[i][j] = dist;
-            mDistance[j][i] = dist;
-        }
-    }
+    auto layers = PassCache::GetData<LayersBuilderPass>(qmod);
+    auto& indexes = PassCache::Get<LayersBuilderPass>(qmod)->getIndexes();
+    // Shares the ownership of the pass, as the handle of its data does.
+    mLayers = std::shared_ptr<const LayersIndexes>(layers, &indexes);
 }
 
 Mapping LayeredBMTQAllocator::allocate(QModule::Ref qmod) {
     init(qmod);
 
-    uint32_t nofDeps = mDBuilder.getDependencies().size();
+    uint32_t nofDeps = mDBuilder->getDependencies().size();
     auto initialMapping = IdentityMapping(mPQubits);
 
     if (nofDeps > 0) {
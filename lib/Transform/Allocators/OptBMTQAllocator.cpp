@@ -2,7 +2,6 @@
 #include "enfield/Transform/Allocators/BMT/DefaultBMTQAllocatorImpl.h"
 #include "enfield/Transform/PassCache.h"
 #include "enfield/Transform/CircuitGraphBuilderPass.h"
-#include "enfield/Transform/QubitRemapPass.h"
 #include "enfield/Transform/Utils.h"
 #include "enfield/Analysis/NodeVisitor.h"
 #include "enfield/Support/ApproxTSFinder.h"
@@ -143,7 +142,7 @@ void OptBMTQAllocator::setCandidatesWeight(std::vector<MappingCandidate>& candid
             if (candidates[0].m[b] == _undef) continue;
 
             for (auto& candidate : candidates) {
-                candidate.weight += mDistance[candidate.m[a]][candidate.m[b]];
+                candidate.weight += mDistance->get(candidate.m[a], candidate.m[b]);
             }
         }
     }
@@ -180,7 +179,7 @@ std::vector<std::vector<MappingCandidate>> OptBMTQAllocator::phase1(QModule::Ref
     //     in this phase, we divide the program in layers, such that each layer is satisfied
     //     by any of the mappings inside 'candidates'.
     //
-    mPP.push_back(std::vector<Node::Ref>());
+    mPP.push_back(std::vector<uint32_t>());
 
     std::vector<std::vector<MappingCandidate>> collection;
     std::vector<MappingCandidate> candidates { { Mapping(mVQubits, _undef), 0 } };
@@ -192,7 +191,7 @@ std::vector<std::vector<MappingCandidate>> OptBMTQAllocator::phase1(QModule::Ref
     INF << "PHASE 1 >>>> Solving SIP Instances" << std::endl;
 
     // Building CircuitGraph and its iterator.
-    auto cGraph = PassCache::Get<CircuitGraphBuilderPass>(qmod)->getData();
+    auto& cGraph = PassCache::Get<CircuitGraphBuilderPass>(qmod)->getData();
     auto it = cGraph.build_iterator();
     auto mXbitSize = cGraph.size();
 
@@ -220,7 +219,7 @@ std::vector<std::vector<MappingCandidate>> OptBMTQAllocator::phase1(QModule::Ref
 
             for (uint32_t i = 0; i < mXbitSize; ++i) {
                 if (it[i]->isGateNode() && it[i]->numberOfXbits() == 1) {
-                    mPP.back().push_back(it.get(i));
+                    mPP.back().push_back(it[i]->index());
                     it.next(i);
                     ++reached[it.get(i)];
 
@@ -240,7 +239,7 @@ std::vector<std::vector<MappingCandidate>> OptBMTQAllocator::phase1(QModule::Ref
 
         for (uint32_t i = 0; i < mXbitSize; ++i) {
             if (it[i]->isGateNode() && reached[it.get(i)] == it[i]->numberOfXbits()) {
-                if (mDBuilder.getDeps(it.get(i)).empty()) {
+                if (mDBuilder->getDepsAt(it[i]->index()).empty()) {
                     toBeIssued.insert(it[i].get());
                 } else {
                     auto node = it[i].get();
@@ -253,7 +252,7 @@ std::vector<std::vector<MappingCandidate>> OptBMTQAllocator::phase1(QModule::Ref
         }
 
         for (auto& cnode : toBeIssued) {
-            mPP.back().push_back(cnode->node());
+            mPP.back().push_back(cnode->index());
 
             for (auto& i : cnode->getXbitsId()) {
                 it.next(i);
@@ -280,7 +279,7 @@ std::vector<std::vector<MappingCandidate>> OptBMTQAllocator::phase1(QModule::Ref
             CNodeCandidate cNCand;
 
             cNCand.cNode = cnode;
-            cNCand.dep = mDBuilder.getDeps(cnode->node())[0];
+            cNCand.dep = mDBuilder->getDepsAt(cnode->index())[0];
 
             uint32_t a = cNCand.dep.mFrom, b = cNCand.dep.mTo;
 
@@ -334,7 +333,7 @@ std::vector<std::vector<MappingCandidate>> OptBMTQAllocator::phase1(QModule::Ref
             // Reseting all data from the last partition.
             candidates = { { Mapping(mVQubits, _undef), 0 } };
             mapped.assign(mVQubits, false);
-            mPP.push_back(std::vector<Node::Ref>());
+            mPP.push_back(std::vector<uint32_t>());
 
             lastPartitionGraph = partitionGraph;
         } else {
@@ -342,14 +341,12 @@ std::vector<std::vector<MappingCandidate>> OptBMTQAllocator::phase1(QModule::Ref
             uint32_t a = dep.mFrom, b = dep.mTo;
 
             if (!mapped[b]) {
-                partitionGraph.succ(b).clear();
-                partitionGraph.pred(b).clear();
+                partitionGraph.clearSuccAndPred(b);
                 mapped[b] = true;
             }
 
             if (!mapped[a]) {
-                partitionGraph.succ(a).clear();
-                partitionGraph.pred(a).clear();
+                partitionGraph.clearSuccAndPred(a);
                 mapped[a] = true;
             }
 
@@ -358,7 +355,7 @@ std::vector<std::vector<MappingCandidate>> OptBMTQAllocator::phase1(QModule::Ref
             partitionGraph.putEdge(a, b);
 
             candidates = newCandidates;
-            mPP.back().push_back(cNCand.cNode->node());
+            mPP.back().push_back(cNCand.cNode->index());
 
             for (auto i : cNCand.cNode->getXbitsId()) {
                 it.next(i);
@@ -377,8 +374,8 @@ uint32_t OptBMTQAllocator::getNearest(uint32_t u, const InverseMap& inv) {
     uint32_t minDist = _undef;
 
     for (uint32_t v = 0; v < mPQubits; ++v) {
-        if (inv[v] == _undef && mDistance[u][v] < minDist) {
-            minDist = mDistance[u][v];
+        if (inv[v] == _undef && mDistance->get(u, v) < minDist) {
+            minDist = mDistance->get(u, v);
             minV = v;
         }
     }
@@ -407,7 +404,7 @@ uint32_t OptBMTQAllocator::estimateSwapCost(const Mapping& fromM, const Mapping&
 
     for (uint32_t i = 0, e = fromM.size(); i < e; ++i) {
         if (fromM[i] != _undef && toM[i] != _undef) {
-            totalDistance += mDistance[fromM[i]][toM[i]];
+            totalDistance += mDistance->get(fromM[i], toM[i]);
         }
     }
 
@@ -568,8 +565,10 @@ Mapping OptBMTQAllocator::phase3(QModule::Ref qmod, const MappingSwapSequence& m
     auto initial = mss.mappings[idx];
     auto mapping = initial;
 
-    QubitRemapVisitor visitor(mapping, mXtoN);
-    std::vector<Node::uRef> issuedInstructions;
+    // The instructions are issued into a flat stream, and turned into
+    // statements only once, at the end.
+    auto& stream = *mStream;
+    auto issued = InstructionStream::WithTablesOf(stream);
 
     for (auto& partition : mPP) {
         if (idx > 0) {
@@ -582,23 +581,19 @@ Mapping OptBMTQAllocator::phase3(QModule::Ref qmod, const MappingSwapSequence& m
                     std::swap(u, v);
                 }
 
-                issuedInstructions.push_back(
-                        CreateISwap(mArchGraph->getNode(u)->clone(),
-                                    mArchGraph->getNode(v)->clone()));
+                issued.append(InstructionStream::K_SWAP, { u, v });
             }
         }
 
         mapping = mss.mappings[idx++];
 
-        for (auto& node : partition) {
+        for (uint32_t i : partition) {
             // We are sure that there are no instruction dependency that has more than
             // one dependency.
-            auto iDependencies = mDBuilder.getDeps(node);
+            auto iDependencies = mDBuilder->getDepsAt(i);
 
             if (iDependencies.size() < 1) {
-                auto cloned = node->clone();
-                cloned->apply(&visitor);
-                issuedInstructions.push_back(std::move(cloned));
+                issued.appendMapped(stream, i, mapping);
                 continue;
             }
 
@@ -612,24 +607,21 @@ Mapping OptBMTQAllocator::phase3(QModule::Ref qmod, const MappingSwapSequence& m
                        "Can't satisfy dependency (" << u << ", " << v << ") "
                        << "with " << idx << "-th mapping: " << MappingToString(mapping));
 
-            Node::uRef newNode;
             if (mArchGraph->hasEdge(u, v)) {
-                newNode = node->clone();
-                newNode->apply(&visitor);
+                issued.appendMapped(stream, i, mapping);
             } else if (mArchGraph->hasEdge(v, u)) {
-                newNode = CreateIRevCX(mArchGraph->getNode(u)->clone(),
-                                       mArchGraph->getNode(v)->clone());
+                // A conditional CX keeps its condition.
+                issued.append(InstructionStream::K_REV_CX, { u, v }, stream.getCond(i));
             } else {
                 EfdAbortIf(true,
                            "Mapping " << MappingToString(mapping)
                            << " not able to satisfy dependency "
                            << "(" << a << "{" << u << "}, " << b << "{" << v << "})");
             }
-
-            issuedInstructions.push_back(std::move(newNode));
         }
     }
 
+    auto issuedInstructions = issued.materialize(*mXtoN);
     qmod->clearStatements();
     qmod->insertStatementLast(std::move(issuedInstructions));
 
@@ -639,28 +631,24 @@ Mapping OptBMTQAllocator::phase3(QModule::Ref qmod, const MappingSwapSequence& m
 void OptBMTQAllocator::init(QModule::Ref qmod) {
     mMaxPartial = MaxPartialSolutions.getVal();
 
-    mDBuilder = PassCache::Get<DependencyBuilderWrapperPass>(qmod)->getData();
-    mXtoN = PassCache::Get<XbitToNumberWrapperPass>(qmod)->getData();
+    mDBuilder = PassCache::GetData<DependencyBuilderWrapperPass>(qmod);
+    mXtoN = PassCache::GetData<XbitToNumberWrapperPass>(qmod);
+    mStream = PassCache::GetData<InstructionStreamWrapperPass>(qmod);
+
+    EfdAbortIf(qmod->getNumberOfStmts() != mStream->size(),
+               "Instruction stream out of date (`" << mStream->size() << "` instructions for `"
+               << qmod->getNumberOfStmts() << "` statements).");
 
     mTSFinder = SimplifiedApproxTSFinder::Create();
     mTSFinder->setGraph(mArchGraph.get());
 
-    mBFSDistance.init(mArchGraph.get());
-    mDistance.assign(mPQubits, std::vector<uint32_t>(mPQubits, 0));
-
-    for (uint32_t i = 0; i < mPQubits; ++i) {
-        for (uint32_t j = i + 1; j < mPQubits; ++j) {
-            auto dist = mBFSDistance.get(i, j);
-            mDistance[i][j] = dist;
-            mDistance[j][i] = dist;
-        }
-    }
+    mDistance = mArchGraph->getDistanceTable();
 }
 
 Mapping OptBMTQAllocator::allocate(QModule::Ref qmod) {
     init(qmod);
 
-    uint32_t nofDeps = mDBuilder.getDependencies().size();
+    uint32_t nofDeps = mDBuilder->getDependencies().size();
     auto initialMapping = IdentityMapping(mPQubits);
 
     if (nofDeps > 0) {
@@ -8,10 +8,17 @@
 #include "enfield/Support/uRefCast.h"
 #include "enfield/Support/Timer.h"
 
+#include <chrono>
 #include <iterator>
 
 using namespace efd;
 
+Opt<uint32_t> efd::Seed
+("seed", "Seed to be used in random algorithms.",
+std::chrono::system_clock::now().time_since_epoch().count(), false);
+Stat<uint32_t> efd::SeedStat
+("seed", "Seed used in the random allocator.");
+
 static Stat<uint32_t> DepStat
 ("Dependencies", "The number of dependencies of this program.");
 static Stat<double> AllocTime
@@ -88,6 +95,18 @@ std::string efd::MappingToString(Mapping m) {
     return s;
 }
 
+uint64_t efd::HashMapping(const uint32_t* m, uint32_t n) {
+    uint64_t h = 0x9E3779B97F4A7C15ULL ^ n;
+
+    for (uint32_t i = 0; i < n; ++i) {
+        h ^= m[i];
+        h *= 0xFF51AFD7ED558CCDULL;
+        h ^= h >> 32;
+    }
+
+    return h;
+}
+
 // ------------------ QbitAllocator ----------------------
 QbitAllocator::QbitAllocator(ArchGraph::sRef archGraph) : mArchGraph(archGraph) {
     mGateWeightMap = { {"U", 1}, {"CX", 10} };
@@ -130,7 +149,7 @@ void QbitAllocator::replaceWithArchSpecs(QModule::Ref qmod) {
     RenameQbitPass::ArchMap toArchMap;
 
     auto xtn = PassCache::Get<XbitToNumberWrapperPass>(qmod);
-    auto xbitToNumber = xtn->getData();
+    auto& xbitToNumber = xtn->getData();
 
     for (uint32_t i = 0, e = xbitToNumber.getQSize(); i < e; ++i) {
         toArchMap[xbitToNumber.getQStrId(i)] = mArchGraph->getNode(i);
@@ -167,6 +186,10 @@ uint32_t QbitAllocator::getBridgeCost(uint32_t u, uint32_t w, uint32_t v) {
 bool QbitAllocator::run(QModule::Ref qmod) {
     Timer timer;
 
+    // The nodes issued by the allocators are kept with the ones of the module,
+    // reusing the blocks of the statements they replace.
+    Arena::Scope scope(qmod->getArena());
+
     // Before running the allocator, we first calculate the costs for CX
     // and H with the gate weights set up.
     calculateHAndCXCost();
@@ -198,7 +221,7 @@ bool QbitAllocator::run(QModule::Ref qmod) {
     // Getting the new information, since it can be the case that the qmodule
     // was modified.
     auto depPass = PassCache::Get<DependencyBuilderWrapperPass>(qmod);
-    auto depBuilder = depPass->getData();
+    auto& depBuilder = depPass->getData();
     auto& deps = depBuilder.getDependencies();
 
     // Counting total dependencies.
@@ -207,7 +230,7 @@ bool QbitAllocator::run(QModule::Ref qmod) {
     DepStat = totalDeps;
 
     // Filling Qubit information.
-    mVQubits = depBuilder.mXbitToNumber.getQSize();
+    mVQubits = depBuilder.getXbitToNumber().getQSize();
     mPQubits = mArchGraph->size();
 
     // Setting up timer ----------------
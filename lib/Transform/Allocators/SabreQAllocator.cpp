@@ -1,25 +1,30 @@
 #include "enfield/Transform/Allocators/SabreQAllocator.h"
-#include "enfield/Transform/Allocators/Simple/RandomMappingFinder.h"
 #include "enfield/Transform/CircuitGraphBuilderPass.h"
-#include "enfield/Transform/QubitRemapPass.h"
 #include "enfield/Transform/PassCache.h"
 #include "enfield/Transform/Utils.h"
 #include "enfield/Support/CommandLine.h"
 #include "enfield/Support/Defs.h"
 #include "enfield/Support/Timer.h"
+#include "enfield/Support/DistanceTable.h"
+#include "enfield/Support/ThreadPool.h"
+#include "enfield/Support/WeightedDistance.h"
 
+#include <algorithm>
+#include <cmath>
 #include <numeric>
 #include <unordered_map>
 
 using namespace efd;
 
-using CircuitNode = CircuitGraph::CircuitNode;
 using WeightedSwap = std::pair<double, Swap>;
 
 static Opt<uint32_t> LookAhead
 ("-sabre-lookahead", "Sets the number of instructions to peek.", 20, false);
 static Opt<uint32_t> Iterations
 ("-sabre-iterations", "Sets the number of times to run SABRE.", 5, false);
+Opt<double> efd::SabreErrorWeight
+("-sabre-error-weight", "How much the error of an edge adds to the cost of going \
+through it, when scoring the swaps (0 only counts the edges).", 0, false);
 
 Stat<uint32_t> Swaps
 ("Swaps", "Number of swaps found.");
@@ -27,159 +32,269 @@ Stat<uint32_t> Swaps
 SabreQAllocator::SabreQAllocator(ArchGraph::sRef ag)
     : QbitAllocator(ag) {}
 
-SabreQAllocator::MappingAndNSwaps
-SabreQAllocator::allocateWithInitialMapping(const Mapping& initialMapping,
-                                            QModule::Ref qmod,
-                                            bool issueInstructions) {
-    auto mapping = initialMapping;
-    auto stmtNumber = qmod->getNumberOfStmts();
-
-    auto depBuilder = PassCache::Get<DependencyBuilderWrapperPass>(qmod)->getData();
-    auto cGraph = PassCache::Get<CircuitGraphBuilderPass>(qmod)->getData();
+SabreQAllocator::ModuleInfo SabreQAllocator::buildModuleInfo(QModule::Ref qmod) {
+    ModuleInfo info;
 
-    auto it = cGraph.build_iterator();
-    auto xbitNumber = cGraph.size();
+    auto& cGraph = PassCache::Get<CircuitGraphBuilderPass>(qmod)->getData();
 
     std::unordered_map<Node::Ref, uint32_t> indexMap;
+    uint32_t stmtNumber = qmod->getNumberOfStmts();
+
+    info.qmod = qmod;
+    info.xbitNumber = cGraph.size();
+    info.depBuilder = PassCache::GetData<DependencyBuilderWrapperPass>(qmod);
+
     for (auto it = qmod->stmt_begin(), end = qmod->stmt_end(); it != end; ++it) {
-        uint32_t indexMapSize = indexMap.size();
-        indexMap[it->get()] = indexMapSize;
+        indexMap[it->get()] = info.stmts.size();
+        info.stmts.push_back(it->get());
+    }
+
+    // Walks each xbit, from its input node to its output node.
+    auto it = cGraph.build_iterator();
+    info.wireBegin.push_back(0);
+
+    for (uint32_t x = 0; x < info.xbitNumber; ++x) {
+        for (it.next(x); it[x]->isGateNode(); it.next(x)) {
+            info.wire.push_back(indexMap.at(it.get(x)));
+        }
+
+        info.wireBegin.push_back(info.wire.size());
+    }
+
+    // Transposes the wires, so that we also have the xbits of each statement.
+    info.xbitsBegin.assign(stmtNumber + 1, 0);
+
+    for (auto s : info.wire) {
+        ++info.xbitsBegin[s + 1];
+    }
+
+    for (uint32_t s = 0; s < stmtNumber; ++s) {
+        info.xbitsBegin[s + 1] += info.xbitsBegin[s];
+    }
+
+    std::vector<uint32_t> fill(info.xbitsBegin.begin(), info.xbitsBegin.end() - 1);
+    info.xbits.resize(info.wire.size());
+
+    for (uint32_t x = 0; x < info.xbitNumber; ++x) {
+        for (uint32_t i = info.wireBegin[x]; i < info.wireBegin[x + 1]; ++i) {
+            info.xbits[fill[info.wire[i]]++] = x;
+        }
     }
 
-    std::map<Node::Ref, uint32_t> reached;
-    std::set<Node::Ref> pastLookAhead;
+    return info;
+}
 
-    std::vector<Node::uRef> newStatements;
-    QubitRemapVisitor visitor(mapping, mXbitToNumber);
+SabreQAllocator::MappingAndNSwaps
+SabreQAllocator::allocateWithInitialMapping(const Mapping& initialMapping,
+                                            const ModuleInfo& info,
+                                            bool issueInstructions) {
+    auto mapping = initialMapping;
+    auto qmod = info.qmod;
+    uint32_t stmtNumber = info.stmts.size();
+    uint32_t xbitNumber = info.xbitNumber;
+
+    const auto& xbitsBegin = info.xbitsBegin;
+    const auto& xbits = info.xbits;
+    const auto& wireBegin = info.wireBegin;
+    const auto& wire = info.wire;
+
+    // Position of each xbit inside its wire.
+    std::vector<uint32_t> pos(wireBegin.begin(), wireBegin.end() - 1);
+    // Number of xbits that reached each statement.
+    std::vector<uint32_t> reached(stmtNumber, 0);
+    std::vector<bool> pastLookAhead(stmtNumber, false);
+
+    // The front layer (statements reached by all their xbits) is kept as an
+    // intrusive doubly linked list, where `stmtNumber` is the sentinel.
+    std::vector<uint32_t> frontNext(stmtNumber + 1, stmtNumber);
+    std::vector<uint32_t> frontPrev(stmtNumber + 1, stmtNumber);
+    uint32_t frontSize = 0;
+
+    auto linkFront = [&](uint32_t s) {
+        frontPrev[s] = frontPrev[stmtNumber];
+        frontNext[s] = stmtNumber;
+        frontNext[frontPrev[stmtNumber]] = s;
+        frontPrev[stmtNumber] = s;
+        ++frontSize;
+    };
+
+    auto unlinkFront = [&](uint32_t s) {
+        frontNext[frontPrev[s]] = frontNext[s];
+        frontPrev[frontNext[s]] = frontPrev[s];
+        --frontSize;
+    };
+
+    auto reach = [&](uint32_t x) {
+        if (pos[x] < wireBegin[x + 1]) {
+            auto s = wire[pos[x]];
+            if (++reached[s] == xbitsBegin[s + 1] - xbitsBegin[s]) linkFront(s);
+        }
+    };
+
+    // Only the forward module is issued, so its statements are the
+    // instructions of `mStream`.
+    auto& stream = *mStream;
+    InstructionStream issued;
+    if (issueInstructions) issued = InstructionStream::WithTablesOf(stream);
 
     uint32_t swapNum = 0;
 
-    for (uint32_t i = 0; i < xbitNumber; ++i) {
-        it.next(i);
-        ++reached[it.get(i)];
+    Matrix currentByQubit(mPQubits), nextByQubit(mPQubits);
+    std::vector<Dep> currentDeps;
+    std::vector<uint32_t> issueStmts;
+    std::vector<bool> usedQubits(mPQubits);
+
+    auto cost = [&](uint32_t u, uint32_t v) { return mCost[(uint64_t) u * mPQubits + v]; };
+
+    for (uint32_t x = 0; x < xbitNumber; ++x) {
+        reach(x);
     }
 
     while (true) {
-        bool changed;
-
         do {
-            changed = false;
-            std::set<CircuitNode::Ref> issueNodes;
-
-            for (uint32_t i = 0; i < xbitNumber; ++i) {
-                auto cNode = it[i];
-                auto node = cNode->node();
-
-                if (cNode->isGateNode() && cNode->numberOfXbits() == reached[node]) {
-                    switch (node->getKind()) {
-                        case Node::Kind::K_IF_STMT:
-                        case Node::Kind::K_QOP_U:
-                        case Node::Kind::K_QOP_CX:
-                        case Node::Kind::K_QOP_GEN:
-                            if (cNode->numberOfXbits() > 1) {
-                                auto deps = depBuilder.getDeps(node);
-
-                                EfdAbortIf(deps.size() > 1,
-                                           "Unable to handle `" << deps.size()
-                                           << "` dependencies in: `" << node->toString(false)
-                                           << "`.");
-
-                                if (!deps.empty()) {
-                                    auto dep = deps[0];
-                                    uint32_t u = mapping[dep.mFrom], v = mapping[dep.mTo];
-
-                                    if (!mArchGraph->hasEdge(u, v) &&
-                                        !mArchGraph->hasEdge(v, u)) {
-                                        break;
-                                    }
+            issueStmts.clear();
+
+            for (auto s = frontNext[stmtNumber]; s != stmtNumber; s = frontNext[s]) {
+                auto node = info.stmts[s];
+                uint32_t nXbits = xbitsBegin[s + 1] - xbitsBegin[s];
+
+                switch (node->getKind()) {
+                    case Node::Kind::K_IF_STMT:
+                    case Node::Kind::K_QOP_U:
+                    case Node::Kind::K_QOP_CX:
+                    case Node::Kind::K_QOP_GEN:
+                        if (nXbits > 1) {
+                            auto deps = info.depBuilder->getDepsAt(s);
+
+                            EfdAbortIf(deps.size() > 1,
+                                       "Unable to handle `" << deps.size()
+                                       << "` dependencies in: `" << node->toString(false)
+                                       << "`.");
+
+                            if (!deps.empty()) {
+                                auto dep = deps[0];
+                                uint32_t u = mapping[dep.mFrom], v = mapping[dep.mTo];
+
+                                if (!mArchGraph->hasEdge(u, v) &&
+                                    !mArchGraph->hasEdge(v, u)) {
+                                    break;
                                 }
                             }
+                        }
+
+                    case Node::Kind::K_QOP_RESET:
+                    case Node::Kind::K_QOP_BARRIER:
+                    case Node::Kind::K_QOP_MEASURE:
+                        // INF << "Issue: " << node->toString(false) << std::endl;
+                        issueStmts.push_back(s);
+                        break;
 
-                        case Node::Kind::K_QOP_RESET:
-                        case Node::Kind::K_QOP_BARRIER:
-                        case Node::Kind::K_QOP_MEASURE:
-                            // INF << "Issue: " << node->toString(false) << std::endl;
-                            issueNodes.insert(cNode.get());
-                            changed = true;
-                            break;
-
-                        default:
-                            break;
-                    }
+                    default:
+                        break;
                 }
             }
 
-            for (auto cNode : issueNodes) {
-                for (auto i : cNode->getXbitsId()) {
-                    it.next(i);
-                    ++reached[it.get(i)];
+            // Issued by their position in the program, so that the instructions
+            // are always issued in the same order.
+            std::sort(issueStmts.begin(), issueStmts.end());
+
+            for (auto s : issueStmts) {
+                unlinkFront(s);
+
+                for (uint32_t i = xbitsBegin[s]; i < xbitsBegin[s + 1]; ++i) {
+                    ++pos[xbits[i]];
+                    reach(xbits[i]);
                 }
 
                 if (issueInstructions) {
-                    auto clone = cNode->node()->clone();
-                    clone->apply(&visitor);
-                    newStatements.push_back(std::move(clone));
+                    issued.appendMapped(stream, s, mapping);
                 }
             }
-        } while (changed);
+        } while (!issueStmts.empty());
 
-        std::unordered_map<Node::Ref, Dep> currentLayer;
-        std::vector<Dep> nextLayer;
+        // If there is no node in the current layer, it means that
+        // we have reached the end of the algorithm. i.e. we processed
+        // all nodes already.
+        if (frontSize == 0) break;
 
+        std::vector<Dep> nextLayer;
         uint32_t offset = std::numeric_limits<uint32_t>::max();
 
-        for (uint32_t i = 0; i < xbitNumber; ++i) {
-            if (it[i]->isGateNode() && it[i]->numberOfXbits() == reached[it.get(i)]) {
-                auto node = it.get(i);
-                auto dep = depBuilder.getDeps(node)[0];
-
-                pastLookAhead.insert(node);
-                currentLayer[node] = dep;
-
-                offset = std::min(offset, indexMap[node]);
-            }
+        // For each physical qubit, the dependencies of each layer that are
+        // currently mapped onto it. Swapping `u` and `v` only changes the
+        // distance of the dependencies in `u`'s and `v`'s lists.
+        for (auto& deps : currentByQubit) deps.clear();
+        for (auto& deps : nextByQubit) deps.clear();
+        currentDeps.clear();
+
+        for (auto s = frontNext[stmtNumber]; s != stmtNumber; s = frontNext[s]) {
+            currentDeps.push_back(info.depBuilder->getDepsAt(s)[0]);
+            pastLookAhead[s] = true;
+            offset = std::min(offset, s);
         }
 
-        // If there is no node in the current layer, it means that
-        // we have reached the end of the algorithm. i.e. we processed
-        // all nodes already.
-        if (currentLayer.empty()) break;
-
         while (nextLayer.size() < mLookAhead && offset < stmtNumber) {
-            auto node = qmod->getStatement(offset++);
-            if (pastLookAhead.find(node) == pastLookAhead.end()) {
-                auto deps = depBuilder.getDeps(node);
+            auto s = offset++;
+            if (!pastLookAhead[s]) {
+                auto deps = info.depBuilder->getDepsAt(s);
                 if (!deps.empty()) nextLayer.push_back(deps[0]);
             }
         }
 
-        std::set<uint32_t> usedQubits;
+        std::fill(usedQubits.begin(), usedQubits.end(), false);
+        double currentSum = 0, nextSum = 0;
 
-        for (auto pair : currentLayer) {
-            usedQubits.insert(mapping[pair.second.mFrom]);
-            usedQubits.insert(mapping[pair.second.mTo]);
+        for (uint32_t i = 0, e = currentDeps.size(); i < e; ++i) {
+            uint32_t a = mapping[currentDeps[i].mFrom], b = mapping[currentDeps[i].mTo];
+            currentByQubit[a].push_back(i);
+            currentByQubit[b].push_back(i);
+            currentSum += cost(a, b);
+
+            usedQubits[a] = true;
+            usedQubits[b] = true;
         }
 
-        auto invM = InvertMapping(mPQubits, mapping);
-        auto best = WeightedSwap(_undef, Swap { 0, 0 });
+        for (uint32_t i = 0, e = nextLayer.size(); i < e; ++i) {
+            uint32_t a = mapping[nextLayer[i].mFrom], b = mapping[nextLayer[i].mTo];
+            nextByQubit[a].push_back(i);
+            nextByQubit[b].push_back(i);
+            nextSum += cost(a, b);
+        }
 
-        for (auto u : usedQubits) {
-            for (auto v : mArchGraph->adj(u)) {
-                auto cpy = mapping;
-                std::swap(cpy[invM[u]], cpy[invM[v]]);
+        // Difference in the sum of the distances of `deps` if we swap `u` and `v`.
+        auto swapDelta = [&](const std::vector<Dep>& deps, const Matrix& byQubit,
+                             uint32_t u, uint32_t v) {
+            auto swapped = [&](uint32_t p) { return (p == u) ? v : ((p == v) ? u : p); };
+            double delta = 0;
 
-                double currentLCost = 0;
-                double nextLCost = 0;
+            for (uint32_t i : byQubit[u]) {
+                uint32_t a = mapping[deps[i].mFrom], b = mapping[deps[i].mTo];
+                delta += cost(swapped(a), swapped(b)) - cost(a, b);
+            }
 
-                for (auto pair : currentLayer) {
-                    currentLCost += mBFSDistance.get(cpy[pair.second.mFrom], cpy[pair.second.mTo]);
-                }
+            for (uint32_t i : byQubit[v]) {
+                uint32_t a = mapping[deps[i].mFrom], b = mapping[deps[i].mTo];
+                // Already counted in `u`'s list.
+                if (a == u || b == u) continue;
+                delta += cost(swapped(a), swapped(b)) - cost(a, b);
+            }
 
-                for (const auto& dep : nextLayer) {
-                    nextLCost += mBFSDistance.get(cpy[dep.mFrom], cpy[dep.mTo]);
-                }
+            return delta;
+        };
+
+        auto invM = InvertMapping(mPQubits, mapping);
+        auto best = WeightedSwap(_undef, Swap { 0, 0 });
+
+        for (uint32_t u = 0; u < mPQubits; ++u) {
+            if (!usedQubits[u]) continue;
+
+            for (auto v : mArchGraph->adj(u)) {
+                // Without error weights, the sums are integers (exact in a
+                // double), so they are the same as adding up every distance again.
+                double currentLCost = currentSum + swapDelta(currentDeps, currentByQubit, u, v);
+                double nextLCost = nextSum + swapDelta(nextLayer, nextByQubit, u, v);
 
-                currentLCost = currentLCost / currentLayer.size();
+                currentLCost = currentLCost / currentDeps.size();
                 if (!nextLayer.empty()) nextLCost = nextLCost / nextLayer.size();
                 double cost = currentLCost + 0.5 * nextLCost;
 
@@ -194,24 +309,55 @@ SabreQAllocator::allocateWithInitialMapping(const Mapping& initialMapping,
         std::swap(mapping[invM[swap.u]], mapping[invM[swap.v]]);
 
         if (issueInstructions) {
-            newStatements.push_back(
-                    CreateISwap(mArchGraph->getNode(swap.u)->clone(),
-                                mArchGraph->getNode(swap.v)->clone()));
+            issued.append(InstructionStream::K_SWAP, { swap.u, swap.v });
         }
 
         ++swapNum;
     }
 
     if (issueInstructions) {
+        auto issuedInstructions = issued.materialize(*mXbitToNumber);
         qmod->clearStatements();
-        for (auto& stmt : newStatements) {
-            qmod->insertStatementLast(std::move(stmt));
-        }
+        qmod->insertStatementLast(std::move(issuedInstructions));
     }
 
     return MappingAndNSwaps(mapping, swapNum);
 }
 
+void SabreQAllocator::buildCostTable() {
+    double weight = SabreErrorWeight.getVal();
+    mCost.resize((uint64_t) mPQubits * mPQubits);
+
+    if (weight <= 0) {
+        auto table = mArchGraph->getDistanceTable();
+
+        for (uint32_t u = 0; u < mPQubits; ++u) {
+            for (uint32_t v = 0; v < mPQubits; ++v) {
+                mCost[(uint64_t) u * mPQubits + v] = table->get(u, v);
+            }
+        }
+
+        return;
+    }
+
+    // The weights of an architecture are the probabilities of success.
+    auto dist = WeightedDistance<double>::Create(WeightedDistance<double>::M_Auto,
+                                                 [weight](uint32_t u, uint32_t v, double p) {
+        return 1 - weight * std::log(std::max(p, 1e-9));
+    });
+    dist->init(mArchGraph.get());
+
+    for (uint32_t u = 0; u < mPQubits; ++u) {
+        for (uint32_t v = 0; v < mPQubits; ++v) {
+            double d = dist->get(u, v);
+            EfdAbortIf(d == WeightedDistance<double>::Inf(),
+                       "There is no path between the physical qubits `" << u
+                       << "` and `" << v << "`.");
+            mCost[(uint64_t) u * mPQubits + v] = d;
+        }
+    }
+}
+
 Mapping SabreQAllocator::allocate(QModule::Ref qmod) {
     std::vector<uint32_t> order(qmod->getNumberOfStmts());
     std::iota(order.begin(), order.end(), 0);
@@ -220,47 +366,81 @@ Mapping SabreQAllocator::allocate(QModule::Ref qmod) {
     mLookAhead = LookAhead.getVal();
     mIterations = Iterations.getVal();
 
-    auto depBuilder = PassCache::Get<DependencyBuilderWrapperPass>(qmod)->getData();
-    mXbitToNumber = depBuilder.getXbitToNumber();
+    mXbitToNumber = PassCache::GetData<XbitToNumberWrapperPass>(qmod);
+    mStream = PassCache::GetData<InstructionStreamWrapperPass>(qmod);
+
+    EfdAbortIf(qmod->getNumberOfStmts() != mStream->size(),
+               "Instruction stream out of date (`" << mStream->size() << "` instructions for `"
+               << qmod->getNumberOfStmts() << "` statements).");
 
     auto qmodReverse = qmod->clone();
     qmodReverse->orderby(order);
 
-    mBFSDistance.init(mArchGraph.get());
+    // Everything the iterations read is computed beforehand, so that they
+    // don't touch the `PassCache`, and only read the cost table.
+    auto info = buildModuleInfo(qmod);
+    auto reverseInfo = buildModuleInfo(qmodReverse.get());
+    buildCostTable();
 
-    Mapping initialM, finalM;
+    struct IterationResult {
+        Mapping initial;
+        uint32_t swaps;
+        double time[3];
+    };
 
-    RandomMappingFinder mappingFinder;
-    auto dummyDependencies = depBuilder.getDependencies();
+    std::vector<IterationResult> results(mIterations);
+    auto pool = ThreadPool::Create(Threads.getVal());
+    uint32_t seed = Seed.getVal();
+    SeedStat = seed;
 
-    MappingAndNSwaps best(initialM, std::numeric_limits<uint32_t>::max());
+    INF << "Starting SABRE Algorithm (" << pool->size() << " threads)." << std::endl;
+
+    pool->run(mIterations, [&](uint32_t tid, uint32_t i) {
+        // Each iteration has its own generator, seeded by both `-seed` and
+        // its index.
+        std::seed_seq seq { seed, i };
+        std::mt19937 gen(seq);
 
-    INF << "Starting SABRE Algorithm." << std::endl;
-    for (uint32_t i = 0; i < mIterations; ++i) {
         Timer t;
-        initialM = mappingFinder.find(mArchGraph.get(), dummyDependencies);
+        auto& result = results[i];
+
+        auto initialM = IdentityMapping(mPQubits);
+        std::shuffle(initialM.begin(), initialM.end(), gen);
 
         t.start();
-        auto resultFinal = allocateWithInitialMapping(initialM, qmod, false);
+        auto resultFinal = allocateWithInitialMapping(initialM, info, false);
         t.stop();
-        INF << "[" << i << "] First round: " << t.getMilliseconds() / 1000.0 << std::endl;
+        result.time[0] = t.getMilliseconds() / 1000.0;
 
         t.start();
-        auto resultInit = allocateWithInitialMapping(resultFinal.first, qmodReverse.get(), false);
+        auto resultInit = allocateWithInitialMapping(resultFinal.first, reverseInfo, false);
         t.stop();
-        INF << "[" << i << "] Second round: " << t.getMilliseconds() / 1000.0 << std::endl;
+        result.time[1] = t.getMilliseconds() / 1000.0;
 
         t.start();
-        resultFinal = allocateWithInitialMapping(resultInit.first, qmod, false);
+        resultFinal = allocateWithInitialMapping(resultInit.first, info, false);
         t.stop();
-        INF << "[" << i << "] Third round: " << t.getMilliseconds() / 1000.0 << std::endl;
+        result.time[2] = t.getMilliseconds() / 1000.0;
+
+        result.initial = resultInit.first;
+        result.swaps = resultFinal.second;
+    });
+
+    // Chooses the best in the order of the iterations, so that ties are
+    // always broken the same way.
+    MappingAndNSwaps best(Mapping(), std::numeric_limits<uint32_t>::max());
+
+    for (uint32_t i = 0; i < mIterations; ++i) {
+        INF << "[" << i << "] First round: " << results[i].time[0] << std::endl;
+        INF << "[" << i << "] Second round: " << results[i].time[1] << std::endl;
+        INF << "[" << i << "] Third round: " << results[i].time[2] << std::endl;
 
-        if (resultFinal.second < best.second) {
-            best = MappingAndNSwaps(resultInit.first, resultFinal.second);
+        if (results[i].swaps < best.second) {
+            best = MappingAndNSwaps(results[i].initial, results[i].swaps);
         }
     }
 
-    auto r = allocateWithInitialMapping(best.first, qmod, true);
+    auto r = allocateWithInitialMapping(best.first, info, true);
     Swaps = r.second;
 
     return best.first;
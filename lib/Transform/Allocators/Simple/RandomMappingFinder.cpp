@@ -2,16 +2,10 @@
 
 #include <ctime>
 #include <algorithm>
-#include <chrono>
 #include <random>
 
-efd::Opt<uint32_t> Seed ("seed", "Seed to be used in random algorithms.",
-std::chrono::system_clock::now().time_since_epoch().count(), false);
-efd::Stat<uint32_t> SeedStat
-("seed", "Seed used in the random allocator.");
-
 int rnd(int i) {
-    static std::default_random_engine generator(Seed.getVal());
+    static std::default_random_engine generator(efd::Seed.getVal());
     static std::uniform_int_distribution<int> distribution(0, i - 1);
     return distribution(generator);
 }
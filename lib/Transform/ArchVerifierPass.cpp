@@ -41,10 +41,8 @@ bool ArchVerifierVisitor::visitNDQOp(NDQOp::Ref qop) {
 
     std::vector<uint32_t> qUIds;
     for (auto& qarg : *qop->getQArgs()) {
-        auto qargStr = qarg->toString(false);
-
-        if (mArch->hasSId(qargStr)) {
-            qUIds.push_back(mArch->getUId(qargStr));
+        if (mArch->hasNode(qarg.get())) {
+            qUIds.push_back(mArch->getUId(qarg.get()));
         } else {
             // If there is some quantum operation that uses an inexistent qubit, we already
             // may return false!
@@ -60,12 +60,16 @@ Xbit Xbit::C(uint32_t id) {
 // --------------------- CircuitNode Class ------------------------
 // ----------------------------------------------------------------
 
-CircuitGraph::CircuitNode::CircuitNode(Type type) : mType(type), mNode(nullptr) {}
+CircuitGraph::CircuitNode::CircuitNode(Type type) : mType(type), mNode(nullptr), mIndex(_undef) {}
 
 Node::Ref CircuitGraph::CircuitNode::node() {
     return mNode;
 }
 
+uint32_t CircuitGraph::CircuitNode::index() {
+    return mIndex;
+}
+
 uint32_t CircuitGraph::CircuitNode::numberOfXbits() {
     return mStepMap.size();
 }
@@ -167,6 +171,7 @@ void CircuitGraph::init(uint32_t qubits, uint32_t cbits) {
     mInit = true;
     mQubits = qubits;
     mCbits = cbits;
+    mGateNodes = 0;
 
     mGraphHead.assign(mQubits + mCbits,
                       CircuitNode::sRef(new CircuitNode(CircuitNode::Type::INPUT)));
@@ -180,7 +185,7 @@ void CircuitGraph::init(uint32_t qubits, uint32_t cbits) {
     }
 }
 
-void CircuitGraph::checkInitialized() {
+void CircuitGraph::checkInitialized() const {
     EfdAbortIf(!mInit, "Trying to append a node to an uninitialized CircuitGraph.");
 }
 
@@ -201,6 +206,7 @@ void CircuitGraph::append(std::vector<Xbit> xbits, Node::Ref node) {
 
     CircuitNode::sRef newNode(new CircuitNode(CircuitNode::Type::GATE));
     newNode->mNode = node;
+    newNode->mIndex = mGateNodes++;
 
     for (auto xbit : xbits) {
         uint32_t id = xbit.getRealId(mQubits, mCbits);
@@ -212,7 +218,7 @@ void CircuitGraph::append(std::vector<Xbit> xbits, Node::Ref node) {
     }
 }
 
-CircuitGraph::Iterator CircuitGraph::build_iterator() {
+CircuitGraph::Iterator CircuitGraph::build_iterator() const {
     checkInitialized();
 
     Iterator iterator(mQubits, mCbits, mGraphHead);
@@ -11,7 +11,7 @@ bool CircuitGraphBuilderPass::run(QModule* qmod) {
     auto& graph = mData;
 
     auto xtonpass = PassCache::Get<XbitToNumberWrapperPass>(qmod);
-    auto xton = xtonpass->getData();
+    auto& xton = xtonpass->getData();
 
     auto qubits = xton.getQSize();
     auto cbits = xton.getCSize();
@@ -33,15 +33,14 @@ bool CircuitGraphBuilderPass::run(QModule* qmod) {
             }
 
         } else if (auto measure = dynCast<NDQOpMeasure>(node)) {
-            auto cbitstr = measure->getCBit()->toString();
-            xbits.push_back(Xbit::C(xton.getCUId(cbitstr)));
+            xbits.push_back(Xbit::C(xton.getCUId(measure->getCBit())));
         }
 
         auto qargs = qop->getQArgs();
 
         for (uint32_t i = 0, e = qargs->getChildNumber(); i < e; ++i) {
             auto qarg = qargs->getChild(i);
-            xbits.push_back(Xbit::Q(xton.getQUId(qarg->toString())));
+            xbits.push_back(Xbit::Q(xton.getQUId(qarg)));
         }
 
         graph.append(xbits, node);
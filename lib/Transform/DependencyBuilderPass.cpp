@@ -39,13 +39,37 @@ efd::Dependencies::ConstIterator efd::Dependencies::end() const {
     return mDeps.end();
 }
 
+// --------------------- DepsSpan ------------------------
+const efd::Dep& efd::DepsSpan::operator[](uint32_t i) const {
+    return mBegin[i];
+}
+
+bool efd::DepsSpan::empty() const {
+    return mBegin == mEnd;
+}
+
+uint32_t efd::DepsSpan::size() const {
+    return mEnd - mBegin;
+}
+
+efd::DepsSpan::ConstIterator efd::DepsSpan::begin() const {
+    return mBegin;
+}
+
+efd::DepsSpan::ConstIterator efd::DepsSpan::end() const {
+    return mEnd;
+}
+
+efd::Dependencies efd::DepsSpan::toDependencies() const {
+    return Dependencies { std::vector<Dep>(mBegin, mEnd), mCallPoint };
+}
+
 // --------------------- DependencyBuilder ------------------------
 efd::DependencyBuilder::DependencyBuilder() {
 }
 
-uint32_t efd::DependencyBuilder::getUId(Node::Ref ref, NDGateDecl::Ref gate) {
-    std::string _id = ref->toString();
-    return mXbitToNumber.getQUId(_id, gate);
+uint32_t efd::DependencyBuilder::getUId(Node::Ref ref, NDGateDecl::Ref gate) const {
+    return getXbitToNumber().getQUId(ref, gate);
 }
 
 const efd::DependencyBuilder::DepsVector* efd::DependencyBuilder::getDepsVector
@@ -68,11 +92,12 @@ efd::DependencyBuilder::DepsVector* efd::DependencyBuilder::getDepsVector
             (this)->getDepsVector(gate));
 }
 
-efd::XbitToNumber& efd::DependencyBuilder::getXbitToNumber() {
-    return mXbitToNumber;
+const efd::XbitToNumber& efd::DependencyBuilder::getXbitToNumber() const {
+    EfdAbortIf(mXbitToNumber.get() == nullptr, "No `XbitToNumber` was set.");
+    return *mXbitToNumber;
 }
 
-void efd::DependencyBuilder::setXbitToNumber(efd::XbitToNumber& xtn) {
+void efd::DependencyBuilder::setXbitToNumber(std::shared_ptr<const XbitToNumber> xtn) {
     mXbitToNumber = xtn;
 }
 
@@ -87,19 +112,67 @@ efd::DependencyBuilder::DepsVector& efd::DependencyBuilder::getDependencies
     return *getDepsVector(ref);
 }
 
-const efd::Dependencies efd::DependencyBuilder::getDeps(Node* ref) const {
-    EfdAbortIf(mIDeps.find(ref) == mIDeps.end(),
-               "Instruction never seen before: `" <<
-               ((ref == nullptr) ? "nullptr" : ref->toString(false))
-               << "`.");
+void efd::DependencyBuilder::putDeps(Node::Ref ref, const std::vector<Dep>& deps) {
+    uint32_t i = getIndex(ref);
+
+    if (i == _undef) {
+        i = mCallPoint.size();
+        mIndex[ref] = i;
+        mDepsBegin.push_back(0);
+        mDepsEnd.push_back(0);
+        mCallPoint.push_back(ref);
+    }
+
+    mDepsBegin[i] = mDepList.size();
+    mDepList.insert(mDepList.end(), deps.begin(), deps.end());
+    mDepsEnd[i] = mDepList.size();
+}
 
-    return mIDeps.at(ref);
+uint32_t efd::DependencyBuilder::getIndex(Node::Ref ref) const {
+    auto it = mIndex.find(ref);
+    return it == mIndex.end() ? _undef : it->second;
 }
 
-efd::Dependencies efd::DependencyBuilder::getDeps(Node* ref) {
-    if (mIDeps.find(ref) == mIDeps.end())
-        mIDeps[ref] = { {}, ref };
-    return mIDeps.at(ref);
+uint32_t efd::DependencyBuilder::getNumberOfIndexes() const {
+    return mCallPoint.size();
+}
+
+efd::DepsSpan efd::DependencyBuilder::getDepsAt(uint32_t i) const {
+    EfdAbortIf(i >= mCallPoint.size(),
+               "Instruction index out of bounds (of `" << mCallPoint.size() << "`): `"
+               << i << "`.");
+
+    const Dep* list = mDepList.data();
+    return DepsSpan { list + mDepsBegin[i], list + mDepsEnd[i], mCallPoint[i] };
+}
+
+efd::DepsSpan efd::DependencyBuilder::getDeps(Node::Ref ref) const {
+    uint32_t i = getIndex(ref);
+    if (i == _undef) return DepsSpan { nullptr, nullptr, ref };
+    return getDepsAt(i);
+}
+
+// --------------------- DataSizeTrait ------------------------
+uint64_t efd::DataSizeTrait<efd::DependencyBuilder>::Get(const DependencyBuilder& data) {
+    auto depsVectorSize = [](const DependencyBuilder::DepsVector& v) {
+        uint64_t bytes = v.capacity() * sizeof(Dependencies);
+        for (const auto& deps : v) bytes += deps.mDeps.capacity() * sizeof(Dep);
+        return bytes;
+    };
+
+    // The `XbitToNumber` is shared, not copied.
+    uint64_t bytes = sizeof(DependencyBuilder) + depsVectorSize(data.mGDeps);
+
+    for (const auto& pair : data.mLDeps) {
+        bytes += sizeof(pair) + sizeof(void*) + depsVectorSize(pair.second);
+    }
+
+    bytes += data.mIndex.size() * (sizeof(std::pair<Node*, uint32_t>) + sizeof(void*)) +
+        data.mIndex.bucket_count() * sizeof(void*);
+    bytes += (data.mDepsBegin.capacity() + data.mDepsEnd.capacity()) * sizeof(uint32_t) +
+        data.mCallPoint.capacity() * sizeof(Node::Ref) +
+        data.mDepList.capacity() * sizeof(Dep);
+    return bytes;
 }
 
 // --------------------- DependencyBuilderWrapperPass ------------------------
@@ -161,7 +234,7 @@ void efd::DependencyBuilderVisitor::visit(NDQOpCX::Ref ref) {
     Dependencies depV { { Dep { controlQ, invertQ } }, ref };
 
     deps->push_back(depV);
-    mDepBuilder.mIDeps[ref] = depV;
+    mDepBuilder.putDeps(ref, depV.mDeps);
 }
 
 void efd::DependencyBuilderVisitor::visit(NDQOpGen::Ref ref) {
@@ -197,12 +270,13 @@ void efd::DependencyBuilderVisitor::visit(NDQOpGen::Ref ref) {
 
     if (!thisDeps.empty())
         deps->push_back(thisDeps);
-    mDepBuilder.mIDeps[ref] = thisDeps;
+    mDepBuilder.putDeps(ref, thisDeps.mDeps);
 }
 
 void efd::DependencyBuilderVisitor::visit(NDIfStmt::Ref ref) {
-    mDepBuilder.mIDeps[ref] = Dependencies();
     visitChildren(ref);
+    // The statement acts on the same qubits as its operation.
+    mDepBuilder.putDeps(ref, mDepBuilder.getDeps(ref->getQOp()).toDependencies().mDeps);
 }
 
 void efd::DependencyBuilderVisitor::visit(NDGOpList::Ref ref) {
@@ -212,11 +286,18 @@ void efd::DependencyBuilderVisitor::visit(NDGOpList::Ref ref) {
 bool efd::DependencyBuilderWrapperPass::run(QModule::Ref qmod) {
     mData.mLDeps.clear();
     mData.mGDeps.clear();
-    mData.mIDeps.clear();
+    mData.mIndex.clear();
+    mData.mDepsBegin.clear();
+    mData.mDepsEnd.clear();
+    mData.mCallPoint.clear();
+    mData.mDepList.clear();
 
-    auto xtn = PassCache::Get<XbitToNumberWrapperPass>(qmod);
-    auto data = xtn->getData();
-    mData.setXbitToNumber(data);
+    mData.setXbitToNumber(PassCache::GetData<XbitToNumberWrapperPass>(qmod));
+
+    // The statements are indexed first, by their position.
+    for (auto it = qmod->stmt_begin(), e = qmod->stmt_end(); it != e; ++it) {
+        mData.putDeps(it->get(), {});
+    }
 
     DependencyBuilderVisitor visitor(*qmod, mData);
     for (auto it = qmod->gates_begin(), e = qmod->gates_end(); it != e; ++it) {
@@ -12,10 +12,10 @@ DependencyGraphBuilderPass::uRef DependencyGraphBuilderPass::Create() {
 
 bool DependencyGraphBuilderPass::run(QModule* qmod) {
     auto depbuilderPass = PassCache::Get<DependencyBuilderWrapperPass>(qmod);
-    auto depbuilder = depbuilderPass->getData();
+    auto& depbuilder = depbuilderPass->getData();
     auto& dependencies = depbuilder.getDependencies();
 
-    uint32_t qubits = depbuilder.mXbitToNumber.getQSize();
+    uint32_t qubits = depbuilder.getXbitToNumber().getQSize();
     mData.reset(DependencyGraph::Create(qubits, Graph::Directed).release());
 
     for (auto& ideps : dependencies) {
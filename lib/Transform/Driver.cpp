@@ -36,7 +36,7 @@ QModule::uRef efd::Compile(QModule::uRef qmod, CompilationSettings settings) {
     }
 
     auto xbitPass = PassCache::Get<XbitToNumberWrapperPass>(qmod.get());
-    auto xbitToNumber = xbitPass->getData(); 
+    auto& xbitToNumber = xbitPass->getData();
 
     EfdAbortIf(xbitToNumber.getQSize() > settings.archGraph->size(),
                "Using more qbits than the maximum permitted by the architecture (max `"
@@ -61,7 +61,7 @@ QModule::uRef efd::Compile(QModule::uRef qmod, CompilationSettings settings) {
         success = success && aVerifierPass->getData();
 
         PassCache::Run(qmod.get(), sVerifierPass.get());
-        auto sVerifierData = sVerifierPass->getData();
+        auto& sVerifierData = sVerifierPass->getData();
         success = success && sVerifierData.isSuccess();
 
         if (!aVerifierPass->getData()) {
@@ -110,7 +110,7 @@ void efd::PrintToStream(QModule::Ref qmod, std::ostream& o, bool pretty) {
 
 void efd::PrintDependencyGraph(QModule::Ref qmod, std::ostream& o) {
     auto depgraphPass = PassCache::Get<DependencyGraphBuilderPass>(qmod);
-    auto graph = depgraphPass->getData();
+    auto& graph = depgraphPass->getData();
     o << graph->dotify() << std::endl;
 
     StatNofVertices = graph->size();
@@ -18,8 +18,8 @@ bool ErrorRateCalculationPass::run(QModule::Ref qmod) {
 
         if (IsCNOTGateCall(qopNode)) {
             auto qargs = qopNode->getQArgs();
-            uint32_t u = mArchGraph->getUId(qargs->getChild(0)->toString(false));
-            uint32_t v = mArchGraph->getUId(qargs->getChild(1)->toString(false));
+            uint32_t u = mArchGraph->getUId(qargs->getChild(0));
+            uint32_t v = mArchGraph->getUId(qargs->getChild(1));
             result = result * mArchGraph->getW(u, v);
         }
     }
@@ -0,0 +1,300 @@
+#include "enfield/Transform/InstructionStream.h"
+#include "enfield/Transform/PassCache.h"
+#include "enfield/Transform/Utils.h"
+#include "enfield/Analysis/NodeVisitor.h"
+#include "enfield/Support/RTTI.h"
+#include "enfield/Support/uRefCast.h"
+
+#include <algorithm>
+
+// --------------------- InstructionStream ------------------------
+efd::InstructionStream::InstructionStream() : mQArgsBegin(1, 0) {
+}
+
+uint32_t efd::InstructionStream::size() const {
+    return mOpcode.size();
+}
+
+void efd::InstructionStream::clear() {
+    mOpcode.clear();
+    mQArgsBegin.assign(1, 0);
+    mQArgs.clear();
+    mCBit.clear();
+    mParam.clear();
+    mCond.clear();
+    mParams.clear();
+    mConds.clear();
+}
+
+efd::InstructionStream::Opcode efd::InstructionStream::getOpcode(uint32_t i) const {
+    return static_cast<Opcode>(mOpcode[i]);
+}
+
+uint32_t efd::InstructionStream::getQArgsNumber(uint32_t i) const {
+    return mQArgsBegin[i + 1] - mQArgsBegin[i];
+}
+
+const uint32_t* efd::InstructionStream::qargs_begin(uint32_t i) const {
+    return mQArgs.data() + mQArgsBegin[i];
+}
+
+const uint32_t* efd::InstructionStream::qargs_end(uint32_t i) const {
+    return mQArgs.data() + mQArgsBegin[i + 1];
+}
+
+uint32_t efd::InstructionStream::getCBit(uint32_t i) const {
+    return mCBit[i];
+}
+
+uint32_t efd::InstructionStream::getCond(uint32_t i) const {
+    return mCond[i];
+}
+
+uint32_t efd::InstructionStream::append(Opcode op, const uint32_t* qbegin, const uint32_t* qend,
+                                        uint32_t cbit, uint32_t param, uint32_t cond) {
+    EfdAbortIf(param != _undef && param >= mParams.size(),
+               "Parameter slot out of bounds (of `" << mParams.size() << "`): `" << param << "`.");
+    EfdAbortIf(cond != _undef && cond >= mConds.size(),
+               "Condition slot out of bounds (of `" << mConds.size() << "`): `" << cond << "`.");
+
+    uint32_t i = size();
+    mOpcode.push_back(op);
+    mQArgs.insert(mQArgs.end(), qbegin, qend);
+    mQArgsBegin.push_back(mQArgs.size());
+    mCBit.push_back(cbit);
+    mParam.push_back(param);
+    mCond.push_back(cond);
+    return i;
+}
+
+uint32_t efd::InstructionStream::append(Opcode op, std::initializer_list<uint32_t> qargs,
+                                        uint32_t cond) {
+    return append(op, qargs.begin(), qargs.end(), _undef, _undef, cond);
+}
+
+uint32_t efd::InstructionStream::appendMapped(const InstructionStream& from, uint32_t i,
+                                              const Mapping& mapping) {
+    auto qbegin = from.qargs_begin(i), qend = from.qargs_end(i);
+    bool isMapped = std::all_of(qbegin, qend, [&](uint32_t a) { return mapping[a] != _undef; });
+
+    uint32_t j = append(from.getOpcode(i), qbegin, qend,
+                        from.mCBit[i], from.mParam[i], from.mCond[i]);
+
+    if (isMapped) {
+        for (uint32_t k = mQArgsBegin[j], e = mQArgsBegin[j + 1]; k < e; ++k) {
+            mQArgs[k] = mapping[mQArgs[k]];
+        }
+    }
+
+    return j;
+}
+
+std::vector<efd::Node::uRef> efd::InstructionStream::materialize(const XbitToNumber& xtn) const {
+    std::vector<Node::uRef> stmts;
+    stmts.reserve(size());
+
+    // The nodes of each qubit and cbit are looked up only once.
+    std::vector<Node::Ref> qnodes(xtn.getQSize()), cnodes(xtn.getCSize());
+    for (uint32_t u = 0, e = qnodes.size(); u < e; ++u) qnodes[u] = xtn.getQNode(u);
+    for (uint32_t c = 0, e = cnodes.size(); c < e; ++c) cnodes[c] = xtn.getCNode(c);
+
+    auto qnode = [&](uint32_t u) { return qnodes[u]->clone(); };
+
+    for (uint32_t i = 0, e = size(); i < e; ++i) {
+        const uint32_t* q = qargs_begin(i);
+        NDQOp::uRef qop;
+
+        switch (getOpcode(i)) {
+            case K_CX:
+                qop = NDQOpCX::Create(qnode(q[0]), qnode(q[1]));
+                break;
+
+            case K_U:
+                qop = NDQOpU::Create(uniqueCastForward<NDList>(mParams[mParam[i]]->getArgs()->clone()),
+                                     qnode(q[0]));
+                break;
+
+            case K_GATE:
+                {
+                    auto source = mParams[mParam[i]];
+                    auto qargs = NDList::Create();
+                    for (auto it = q, end = qargs_end(i); it != end; ++it) {
+                        qargs->addChild(qnode(*it));
+                    }
+
+                    qop = NDQOpGen::Create(uniqueCastForward<NDId>(source->getId()->clone()),
+                                           uniqueCastForward<NDList>(source->getArgs()->clone()),
+                                           std::move(qargs));
+                }
+                break;
+
+            case K_MEASURE:
+                qop = NDQOpMeasure::Create(qnode(q[0]), cnodes[mCBit[i]]->clone());
+                break;
+
+            case K_RESET:
+                qop = NDQOpReset::Create(qnode(q[0]));
+                break;
+
+            case K_BARRIER:
+                {
+                    auto qargs = NDList::Create();
+                    for (auto it = q, end = qargs_end(i); it != end; ++it) {
+                        qargs->addChild(qnode(*it));
+                    }
+
+                    qop = NDQOpBarrier::Create(std::move(qargs));
+                }
+                break;
+
+            case K_SWAP:
+                qop = CreateISwap(qnode(q[0]), qnode(q[1]));
+                break;
+
+            case K_REV_CX:
+                qop = CreateIRevCX(qnode(q[0]), qnode(q[1]));
+                break;
+
+            case K_LCX:
+                qop = CreateILongCX(qnode(q[0]), qnode(q[1]), qnode(q[2]));
+                break;
+        }
+
+        if (mCond[i] != _undef) {
+            auto& cond = mConds[mCond[i]];
+            stmts.push_back(NDIfStmt::Create(NDId::Create(StringInterner::Get(cond.mReg)),
+                                             NDInt::Create(cond.mVal),
+                                             std::move(qop)));
+        } else {
+            stmts.push_back(std::move(qop));
+        }
+    }
+
+    return stmts;
+}
+
+efd::InstructionStream efd::InstructionStream::WithTablesOf(const InstructionStream& src) {
+    InstructionStream stream;
+    stream.mParams = src.mParams;
+    stream.mConds = src.mConds;
+    return stream;
+}
+
+// --------------------- DataSizeTrait ------------------------
+uint64_t efd::DataSizeTrait<efd::InstructionStream>::Get(const InstructionStream& data) {
+    return sizeof(InstructionStream) +
+        data.mOpcode.capacity() * sizeof(uint8_t) +
+        (data.mQArgsBegin.capacity() + data.mQArgs.capacity() + data.mCBit.capacity() +
+         data.mParam.capacity() + data.mCond.capacity()) * sizeof(uint32_t) +
+        data.mParams.capacity() * sizeof(NDQOp::Ref) +
+        data.mConds.capacity() * sizeof(InstructionStream::Condition);
+}
+
+// --------------------- InstructionStreamWrapperPass ------------------------
+uint8_t efd::InstructionStreamWrapperPass::ID = 0;
+
+namespace efd {
+    class InstructionStreamVisitor : public NodeVisitor {
+        private:
+            const XbitToNumber& mXtoN;
+            InstructionStream& mStream;
+            std::vector<uint32_t> mQArgs;
+            uint32_t mCond;
+
+            /// \brief Appends \p qop, getting its qubit uids.
+            void appendQOp(InstructionStream::Opcode op, NDQOp::Ref qop,
+                           uint32_t cbit = _undef, uint32_t param = _undef);
+
+        public:
+            InstructionStreamVisitor(const XbitToNumber& xtn, InstructionStream& stream)
+                : mXtoN(xtn), mStream(stream), mCond(_undef) {}
+
+            void visit(NDQOpMeasure::Ref ref) override;
+            void visit(NDQOpReset::Ref ref) override;
+            void visit(NDQOpU::Ref ref) override;
+            void visit(NDQOpCX::Ref ref) override;
+            void visit(NDQOpBarrier::Ref ref) override;
+            void visit(NDQOpGen::Ref ref) override;
+            void visit(NDIfStmt::Ref ref) override;
+    };
+}
+
+void efd::InstructionStreamVisitor::appendQOp(InstructionStream::Opcode op, NDQOp::Ref qop,
+                                              uint32_t cbit, uint32_t param) {
+    mQArgs.clear();
+    for (auto& qarg : *qop->getQArgs()) {
+        mQArgs.push_back(mXtoN.getQUId(qarg.get()));
+    }
+
+    mStream.append(op, mQArgs.data(), mQArgs.data() + mQArgs.size(), cbit, param, mCond);
+    mCond = _undef;
+}
+
+void efd::InstructionStreamVisitor::visit(NDQOpMeasure::Ref ref) {
+    appendQOp(InstructionStream::K_MEASURE, ref, mXtoN.getCUId(ref->getCBit()));
+}
+
+void efd::InstructionStreamVisitor::visit(NDQOpReset::Ref ref) {
+    appendQOp(InstructionStream::K_RESET, ref);
+}
+
+void efd::InstructionStreamVisitor::visit(NDQOpU::Ref ref) {
+    mStream.mParams.push_back(ref);
+    appendQOp(InstructionStream::K_U, ref, _undef, mStream.mParams.size() - 1);
+}
+
+void efd::InstructionStreamVisitor::visit(NDQOpCX::Ref ref) {
+    appendQOp(InstructionStream::K_CX, ref);
+}
+
+void efd::InstructionStreamVisitor::visit(NDQOpBarrier::Ref ref) {
+    appendQOp(InstructionStream::K_BARRIER, ref);
+}
+
+void efd::InstructionStreamVisitor::visit(NDQOpGen::Ref ref) {
+    if (ref->isIntrinsic()) {
+        switch (ref->getIntrinsicKind()) {
+            case NDQOpGen::K_INTRINSIC_SWAP:
+                appendQOp(InstructionStream::K_SWAP, ref);
+                break;
+            case NDQOpGen::K_INTRINSIC_REV_CX:
+                appendQOp(InstructionStream::K_REV_CX, ref);
+                break;
+            case NDQOpGen::K_INTRINSIC_LCX:
+                appendQOp(InstructionStream::K_LCX, ref);
+                break;
+        }
+    } else {
+        mStream.mParams.push_back(ref);
+        appendQOp(InstructionStream::K_GATE, ref, _undef, mStream.mParams.size() - 1);
+    }
+}
+
+void efd::InstructionStreamVisitor::visit(NDIfStmt::Ref ref) {
+    mStream.mConds.push_back(InstructionStream::Condition {
+            ref->getCondId()->getSymbol(), ref->getCondN()->getVal() });
+    mCond = mStream.mConds.size() - 1;
+    ref->getQOp()->apply(this);
+}
+
+bool efd::InstructionStreamWrapperPass::run(QModule::Ref qmod) {
+    mData.clear();
+
+    auto xtn = PassCache::GetData<XbitToNumberWrapperPass>(qmod);
+    InstructionStreamVisitor visitor(*xtn, mData);
+
+    for (auto it = qmod->stmt_begin(), e = qmod->stmt_end(); it != e; ++it) {
+        uint32_t i = mData.size();
+        (*it)->apply(&visitor);
+
+        EfdAbortIf(mData.size() != i + 1,
+                   "Statement is not a quantum operation (the module must be flattened "
+                   "and inlined): `" << (*it)->toString(false) << "`.");
+    }
+
+    return false;
+}
+
+efd::InstructionStreamWrapperPass::uRef efd::InstructionStreamWrapperPass::Create() {
+    return uRef(new InstructionStreamWrapperPass());
+}
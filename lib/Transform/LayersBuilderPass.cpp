@@ -36,14 +36,14 @@ UsedBitsVisitor::UsedBitsVisitor(QModule::Ref qmod, XbitToNumber& xton) : mMod(q
 void UsedBitsVisitor::visitQOp(NDQOp::Ref ref) {
     mBits.clear();
     for (auto& qarg : *(ref->getQArgs())) {
-        uint32_t qid = mXton.getQUId(qarg->toString(false));
+        uint32_t qid = mXton.getQUId(qarg.get());
         mBits.push_back(qid);
     }
 }
 
 void UsedBitsVisitor::visit(NDQOpMeasure::Ref ref) {
     visitQOp(ref);
-    mBits.push_back(mXton.getQSize() + mXton.getCUId(ref->getCBit()->toString(false)));
+    mBits.push_back(mXton.getQSize() + mXton.getCUId(ref->getCBit()));
 }
 
 void UsedBitsVisitor::visit(NDQOpReset::Ref ref) {
@@ -69,13 +69,7 @@ void UsedBitsVisitor::visit(NDQOpGen::Ref ref) {
 void UsedBitsVisitor::visit(NDIfStmt::Ref ref) {
     visitQOp(ref->getQOp());
 
-    auto cregname = ref->getCondId()->getVal();
-    auto cregDecl = dynCast<NDRegDecl>(mMod->getQVar(cregname));
-    auto size = cregDecl->getSize()->getVal().mV;
-
-    for (uint32_t i = 0; i < size; ++i) {
-        std::string sid = cregname + "[" + std::to_string(i) + "]";
-        uint32_t cid = mXton.getCUId(sid);
+    for (uint32_t cid : mXton.getRegUIds(ref->getCondId()->getVal())) {
         mBits.push_back(mXton.getQSize() + cid);
     }
 }
@@ -90,7 +84,9 @@ bool LayersBuilderPass::run(QModule* qmod) {
     UsedBitsVisitor ubVisitor(qmod, xton);
     std::vector<int32_t> layerNum(qubits + cbits, -1);
 
-    for (auto it = qmod->stmt_begin(), end = qmod->stmt_end(); it != end; ++it) {
+    uint32_t index = 0;
+
+    for (auto it = qmod->stmt_begin(), end = qmod->stmt_end(); it != end; ++it, ++index) {
         auto node = it->get();
 
         int32_t maxLayer = 0;
@@ -108,14 +104,20 @@ bool LayersBuilderPass::run(QModule* qmod) {
 
         if (mData.size() <= (uint32_t) maxLayer) {
             mData.push_back(Layer());
+            mIndexes.push_back(std::vector<uint32_t>());
         }
 
         mData[maxLayer].push_back(node);
+        mIndexes[maxLayer].push_back(index);
     }
 
     return false;
 }
 
+const LayersIndexes& LayersBuilderPass::getIndexes() const {
+    return mIndexes;
+}
+
 LayersBuilderPass::uRef LayersBuilderPass::Create() {
     return uRef(new LayersBuilderPass());
 }
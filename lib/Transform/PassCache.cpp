@@ -2,3 +2,6 @@
 
 // Initializing static member.
 efd::PassCache::QModPassesMap efd::PassCache::mPasses;
+
+efd::Stat<uint64_t> efd::PassCacheBytesCopied
+("PassCacheBytesCopied", "Number of bytes of analyses copied out of the pass cache.");
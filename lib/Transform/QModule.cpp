@@ -14,7 +14,19 @@ efd::QModule::QModule() : mVersion(nullptr) {
 }
 
 efd::QModule::~QModule() {
+    // The nodes are destroyed with the arena in scope, so that their blocks
+    // are reused by the modules that share it (see clone).
+    Arena::Scope scope(mArena);
     PassCache::Clear(this);
+
+    mStatements.reset();
+    mGates.clear();
+    mRegs.clear();
+    mGateIdMap.clear();
+    mGatesMap.clear();
+    mRegsMap.clear();
+    mIncludes.clear();
+    mVersion.reset();
 }
 
 efd::NDQasmVersion::Ref efd::QModule::getVersion() {
@@ -225,7 +237,8 @@ efd::QModule::ConstIterator efd::QModule::stmt_end() const {
 }
 
 void efd::QModule::orderby(std::vector<uint32_t> order) {
-    std::vector<Node::uRef> newstmts;
+    Node::ChildVector newstmts;
+    newstmts.reserve(order.size());
     for (uint32_t i : order)
         newstmts.push_back(std::move(mStatements->mChild[i]));
     mStatements->mChild.clear();
@@ -332,8 +345,16 @@ bool efd::QModule::hasQGate(std::string id) const {
     return true;
 }
 
+efd::Arena::sRef efd::QModule::getArena() const {
+    return mArena;
+}
+
 efd::QModule::uRef efd::QModule::clone() const {
     auto qmod = new QModule();
+    // Clones share the arena, so that they reuse the blocks freed by the
+    // others (e.g.: the parsed AST, once it is turned into a module).
+    qmod->mArena = (mArena.get() != nullptr) ? mArena : Arena::Create();
+    Arena::Scope scope(qmod->mArena);
 
     if (mVersion.get() != nullptr)
         qmod->mVersion = uniqueCastForward<NDQasmVersion>(mVersion->clone());
@@ -374,19 +395,31 @@ efd::QModule::uRef efd::QModule::GetFromAST(Node::uRef ref) {
 }
 
 efd::QModule::uRef efd::QModule::Parse(std::string filename, std::string path) {
+    auto arena = Arena::Create();
+    Arena::Scope scope(arena);
+
     auto ast = efd::ParseFile(filename, path, true);
 
-    if (ast.get() != nullptr)
-        return GetFromAST(std::move(ast));
+    if (ast.get() != nullptr) {
+        auto qmod = GetFromAST(std::move(ast));
+        qmod->mArena = arena;
+        return qmod;
+    }
 
     return uRef(nullptr);
 }
 
-efd::QModule::uRef efd::QModule::ParseString(std::string program) {
+efd::QModule::uRef efd::QModule::ParseString(const std::string& program) {
+    auto arena = Arena::Create();
+    Arena::Scope scope(arena);
+
     auto ast = efd::ParseString(program, true);
 
-    if (ast != nullptr)
-        return GetFromAST(std::move(ast));
+    if (ast != nullptr) {
+        auto qmod = GetFromAST(std::move(ast));
+        qmod->mArena = arena;
+        return qmod;
+    }
 
     return uRef(nullptr);
 }
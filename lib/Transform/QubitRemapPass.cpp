@@ -17,7 +17,7 @@ void QubitRemapVisitor::visitNDQOp(NDQOp::Ref qop) {
     NDList::uRef newQArgs = NDList::Create();
 
     for (auto& qarg : *qargs) {
-        uint32_t pseudoQUId = mXtoN.getQUId(qarg->toString(false));
+        uint32_t pseudoQUId = mXtoN.getQUId(qarg.get());
         uint32_t physicalQUId = mMap[pseudoQUId];
 
         if (physicalQUId != _undef) {
@@ -66,7 +66,7 @@ void QubitRemapVisitor::visit(NDIfStmt::Ref ref) {
 QubitRemapPass::QubitRemapPass(const Mapping& m) : mMap(m) {}
 
 bool QubitRemapPass::run(QModule* qmod) {
-    auto xbitToN = PassCache::Get<XbitToNumberWrapperPass>(qmod)->getData();
+    auto& xbitToN = PassCache::Get<XbitToNumberWrapperPass>(qmod)->getData();
     QubitRemapVisitor visitor(mMap, xbitToN);
 
     for (auto it = qmod->stmt_begin(), end = qmod->stmt_end(); it != end; ++it) {
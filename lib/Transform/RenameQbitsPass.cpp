@@ -7,14 +7,14 @@ uint8_t efd::RenameQbitPass::ID = 0;
 namespace efd {
     class RenameQbitVisitor : public NodeVisitor {
         private:
-            RenameQbitPass::ArchMap& mAMap;
+            RenameQbitPass::ArchKeyMap& mAMap;
 
             /// \brief Gets the node associated with the old node (that is currently
             /// inside)
             Node::uRef getNodeFromOld(Node::Ref old);
 
         public:
-            RenameQbitVisitor(RenameQbitPass::ArchMap& map) : mAMap(map) {}
+            RenameQbitVisitor(RenameQbitPass::ArchKeyMap& map) : mAMap(map) {}
 
             void visit(NDQOpMeasure::Ref ref) override;
             void visit(NDQOpReset::Ref ref) override;
@@ -27,9 +27,10 @@ namespace efd {
 }
 
 efd::Node::uRef efd::RenameQbitVisitor::getNodeFromOld(Node::Ref old) {
-    std::string id = old->toString();
-    EfdAbortIf(mAMap.find(id) == mAMap.end(), "Node not found for id/idref: `" << id << "`.");
-    return mAMap[id]->clone();
+    auto it = mAMap.find(GetXbitKey(old));
+    EfdAbortIf(it == mAMap.end(),
+               "Node not found for id/idref: `" << old->toString(false) << "`.");
+    return it->second->clone();
 }
 
 void efd::RenameQbitVisitor::visit(NDQOpMeasure::Ref ref) {
@@ -65,7 +66,11 @@ void efd::RenameQbitVisitor::visit(NDList::Ref ref) {
     }
 }
 
-efd::RenameQbitPass::RenameQbitPass(ArchMap map) : mAMap(map) {
+efd::RenameQbitPass::RenameQbitPass(ArchMap map) {
+    // Keys are computed once, so that renaming does not build any string.
+    for (auto& pair : map) {
+        mAMap[GetXbitKey(pair.first)] = pair.second;
+    }
 }
 
 bool efd::RenameQbitPass::run(QModule::Ref qmod) {
@@ -44,8 +44,8 @@ void efd::ReverseEdgesVisitor::insertIntoRevVector
 }
 
 void efd::ReverseEdgesVisitor::visit(NDQOpCX::Ref ref) {
-    uint32_t uidLhs = mG->getUId(ref->getLhs()->toString());
-    uint32_t uidRhs = mG->getUId(ref->getRhs()->toString());
+    uint32_t uidLhs = mG->getUId(ref->getLhs());
+    uint32_t uidRhs = mG->getUId(ref->getRhs());
 
     if (!mG->hasEdge(uidLhs, uidRhs)) {
         insertIntoRevVector(ref, ref->getLhs(), ref->getRhs());
@@ -59,8 +59,8 @@ void efd::ReverseEdgesVisitor::visit(NDQOpGen::Ref ref) {
                    "CNot gate malformed: `" << ref->toString(false) << "`.");
 
         NDList* qargs = ref->getQArgs();
-        uint32_t uidLhs = mG->getUId(qargs->getChild(0)->toString());
-        uint32_t uidRhs = mG->getUId(qargs->getChild(1)->toString());
+        uint32_t uidLhs = mG->getUId(qargs->getChild(0));
+        uint32_t uidRhs = mG->getUId(qargs->getChild(1));
 
         if (!mG->hasEdge(uidLhs, uidRhs)) {
             insertIntoRevVector(ref, qargs->getChild(0), qargs->getChild(1));
@@ -159,7 +159,7 @@ void SemanticVerifierVisitor::visitNDQOp(NDQOp::Ref tgtQOp, NDIfStmt::Ref tgtIfS
 
     for (uint32_t i = 0; i < tgtQArgsChildrem; ++i) {
         auto qarg = tgtQArgs->getChild(i);
-        tgtOpQubits.push_back(mXtoNTgt.getQUId(qarg->toString(false)));
+        tgtOpQubits.push_back(mXtoNTgt.getQUId(qarg));
     }
 
     if (tgtIfStmt != nullptr) {
@@ -214,7 +214,7 @@ void SemanticVerifierVisitor::visitNDQOp(NDQOp::Ref tgtQOp, NDIfStmt::Ref tgtIfS
     uint32_t srcQArgsChildrem = srcQArgs->getChildNumber();
 
     for (uint32_t i = 0; i < srcQArgsChildrem; ++i) {
-        uint32_t qubit = mXtoNSrc.getQUId(srcQArgs->getChild(i)->toString(false));
+        uint32_t qubit = mXtoNSrc.getQUId(srcQArgs->getChild(i));
         srcOpQubits.push_back(getTgtUId(qubit));
     }
 
@@ -333,8 +333,8 @@ void SemanticVerifierVisitor::visitNDQOp(NDQOp::Ref tgtQOp, NDIfStmt::Ref tgtIfS
 }
 
 void SemanticVerifierVisitor::visit(NDQOpMeasure::Ref ref) {
-    uint32_t tgtQUId = mXtoNTgt.getQUId(ref->getQBit()->toString(false));
-    uint32_t tgtCUId = getRealTgtCUId(mXtoNTgt.getCUId(ref->getCBit()->toString(false)));
+    uint32_t tgtQUId = mXtoNTgt.getQUId(ref->getQBit());
+    uint32_t tgtCUId = getRealTgtCUId(mXtoNTgt.getCUId(ref->getCBit()));
 
     auto srcCNode = mIt[getSrcUId(tgtQUId)];
 
@@ -348,8 +348,8 @@ void SemanticVerifierVisitor::visit(NDQOpMeasure::Ref ref) {
     auto srcNode = dynCast<NDQOpMeasure>(srcCNode->node());
 
     if (srcNode != nullptr) {
-        uint32_t srcQUId = mXtoNSrc.getQUId(srcNode->getQBit()->toString(false));
-        uint32_t srcCUId = getRealSrcCUId(mXtoNSrc.getCUId(srcNode->getCBit()->toString(false)));
+        uint32_t srcQUId = mXtoNSrc.getQUId(srcNode->getQBit());
+        uint32_t srcCUId = getRealSrcCUId(mXtoNSrc.getCUId(srcNode->getCBit()));
 
         if (tgtQUId != getTgtUId(srcQUId) || tgtCUId != getTgtUId(srcCUId)) {
             mResult = ResultMsg::Error(
@@ -390,8 +390,8 @@ void SemanticVerifierVisitor::visit(NDQOpGen::Ref ref) {
     if (ref->isIntrinsic() && ref->getIntrinsicKind() == NDQOpGen::K_INTRINSIC_SWAP) {
         auto qargs = ref->getQArgs();
 
-        uint32_t u = mXtoNTgt.getQUId(qargs->getChild(0)->toString(false));
-        uint32_t v = mXtoNTgt.getQUId(qargs->getChild(1)->toString(false));
+        uint32_t u = mXtoNTgt.getQUId(qargs->getChild(0));
+        uint32_t v = mXtoNTgt.getQUId(qargs->getChild(1));
 
         uint32_t a = mInverseMap[u];
         uint32_t b = mInverseMap[v];
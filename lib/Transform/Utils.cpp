@@ -46,6 +46,9 @@ static const std::string IntrinsicGatesStr =
 
 static void ProcessIntrinsicGates() {
     if (IntrinsicGates.empty()) {
+        // These are kept until the end, so they must not be taken from the
+        // arena of the module being parsed (it would never be released).
+        Arena::Scope scope(nullptr);
         auto ast = ParseString(IntrinsicGatesStr, false);
         EfdAbortIf(!instanceOf<NDStmtList>(ast.get()), "Intrinsic gates root node of wrong type.");
 
@@ -35,6 +35,32 @@ uint32_t efd::XbitToNumber::getCUId(std::string id) const {
     return gidCMap.at(id).key;
 }
 
+uint32_t efd::XbitToNumber::getQUId(Node::Ref ref, NDGateDecl::Ref gate) const {
+    auto map = &gidQKeyMap;
+
+    if (gate != nullptr) {
+        auto it = lidQKeyMap.find(gate);
+        EfdAbortIf(it == lidQKeyMap.end(),
+                   "Trying to get an unknown gate information: `" << gate->getId()->getVal() << "`.");
+        map = &it->second;
+    }
+
+    auto it = map->find(GetXbitKey(ref));
+    EfdAbortIf(it == map->end(),
+               "Qubit id not found inside gate (`"
+               << ((gate == nullptr) ? "nullptr" : gate->getId()->getVal()) << "`): `"
+               << ref->toString(false) << "`.");
+
+    return it->second;
+}
+
+uint32_t efd::XbitToNumber::getCUId(Node::Ref ref) const {
+    auto it = gidCKeyMap.find(GetXbitKey(ref));
+    EfdAbortIf(it == gidCKeyMap.end(),
+               "Classical bit id not found: `" << ref->toString(false) << "`.");
+    return it->second;
+}
+
 uint32_t efd::XbitToNumber::getQSize(NDGateDecl::Ref gate) const {
     auto& map = getQbitMap(gate);
     return map.size();
@@ -72,7 +98,7 @@ std::string efd::XbitToNumber::getCStrId(uint32_t id) const {
 
 efd::Node::Ref efd::XbitToNumber::getQNode(uint32_t id, NDGateDecl::Ref gate) const {
     auto str = getQStrId(id, gate);
-    auto map = getQbitMap(gate);
+    auto& map = getQbitMap(gate);
     return map.at(str).node.get();
 }
 
@@ -81,6 +107,41 @@ efd::Node::Ref efd::XbitToNumber::getCNode(uint32_t id) const {
     return gidCMap.at(str).node.get();
 }
 
+// --------------------- DataSizeTrait ------------------------
+static uint64_t SizeOfXbitMap(const efd::XbitToNumber::XbitMap& map) {
+    // Each entry lives in a tree node (three pointers and a color), and may
+    // own the buffer of its key.
+    uint64_t bytes = 0;
+    for (const auto& pair : map) {
+        bytes += sizeof(pair) + 4 * sizeof(void*) + pair.first.capacity();
+    }
+    return bytes;
+}
+
+uint64_t efd::DataSizeTrait<efd::XbitToNumber>::Get(const XbitToNumber& data) {
+    uint64_t bytes = sizeof(XbitToNumber) +
+        SizeOfXbitMap(data.gidQMap) + SizeOfXbitMap(data.gidCMap);
+
+    for (const auto& pair : data.lidQMap) {
+        bytes += sizeof(pair) + sizeof(void*) + SizeOfXbitMap(pair.second);
+    }
+
+    // Hash nodes of the integer indexes: key, value and the next pointer.
+    uint64_t keyEntry = sizeof(XbitKey) + sizeof(uint32_t) + sizeof(void*);
+    bytes += (data.gidQKeyMap.size() + data.gidCKeyMap.size()) * keyEntry;
+
+    for (const auto& pair : data.lidQKeyMap) {
+        bytes += sizeof(pair) + sizeof(void*) + pair.second.size() * keyEntry;
+    }
+
+    for (const auto& pair : data.gidRegMap) {
+        bytes += sizeof(pair) + 4 * sizeof(void*) + pair.first.capacity() +
+            pair.second.capacity() * sizeof(uint32_t);
+    }
+
+    return bytes;
+}
+
 // --------------------- XbitToNumberWrapperPass ------------------------
 uint8_t efd::XbitToNumberWrapperPass::ID = 0;
 
@@ -104,8 +165,15 @@ void efd::XbitToNumberVisitor::visit(NDRegDecl::Ref ref) {
     mXbitToNumber.gidRegMap[id] = std::vector<uint32_t>();
 
     auto mapref = &mXbitToNumber.gidQMap;
-    if (ref->isCReg()) mapref = &mXbitToNumber.gidCMap;
+    auto keymapref = &mXbitToNumber.gidQKeyMap;
+
+    if (ref->isCReg()) {
+        mapref = &mXbitToNumber.gidCMap;
+        keymapref = &mXbitToNumber.gidCKeyMap;
+    }
+
     uint32_t basen = mapref->size();
+    auto sym = ref->getId()->getSymbol();
 
     // For each register declaration, we associate a
     // number to each possible xbit.
@@ -116,6 +184,7 @@ void efd::XbitToNumberVisitor::visit(NDRegDecl::Ref ref) {
         auto ref = NDIdRef::Create(NDId::Create(id), NDInt::Create(std::to_string(i)));
         auto info = XbitToNumber::XbitInfo { basen + i, toShared(std::move(ref)) };
         mapref->insert(std::make_pair(key, info));
+        keymapref->insert(std::make_pair(MakeXbitKey(sym, i), basen + i));
         mXbitToNumber.gidRegMap[id].push_back(basen + i);
     }
 }
@@ -123,6 +192,7 @@ void efd::XbitToNumberVisitor::visit(NDRegDecl::Ref ref) {
 void efd::XbitToNumberVisitor::visit(NDGateDecl::Ref ref) {
     if (mXbitToNumber.lidQMap.find(ref) == mXbitToNumber.lidQMap.end()) {
         mXbitToNumber.lidQMap[ref] = efd::XbitToNumber::XbitMap();
+        mXbitToNumber.lidQKeyMap[ref] = efd::XbitToNumber::XbitKeyMap();
 
         // Each quantum argument of each quantum gate declaration
         // will be mapped to a number.
@@ -134,6 +204,7 @@ void efd::XbitToNumberVisitor::visit(NDGateDecl::Ref ref) {
             };
 
             mXbitToNumber.lidQMap[ref][idref->getVal()] = info;
+            mXbitToNumber.lidQKeyMap[ref][GetXbitKey(idref)] = info.key;
         }
     }
 }
@@ -142,6 +213,9 @@ bool efd::XbitToNumberWrapperPass::run(QModule::Ref qmod) {
     mData.gidCMap.clear();
     mData.gidQMap.clear();
     mData.lidQMap.clear();
+    mData.gidCKeyMap.clear();
+    mData.gidQKeyMap.clear();
+    mData.lidQKeyMap.clear();
 
     XbitToNumberVisitor visitor(mData);
 
@@ -5,6 +5,8 @@
 #include "enfield/Support/RTTI.h"
 
 #include <string>
+#include <thread>
+#include <vector>
 
 using namespace efd;
 
@@ -451,3 +453,58 @@ TEST(ASTNodeTests, IncludeEqualTest) {
     auto refInclude = NDInclude::Create(Id("files/_qelib1.inc"), NDStmtList::Create());
     TestEqual(refInclude.get());
 }
+
+TEST(ASTNodeTests, IdRefKeyTest) {
+    auto ref = IdRef("q", "3");
+    ASSERT_EQ(ref->getIdSymbol(), StringInterner::Intern("q"));
+    ASSERT_EQ(ref->getIndex(), 3u);
+    ASSERT_EQ(ref->getKey(), GetXbitKey("q[3]"));
+    ASSERT_EQ(GetXbitKey(ref.get()), GetXbitKey(ref->clone().get()));
+    ASSERT_NE(ref->getKey(), IdRef("q", "4")->getKey());
+    ASSERT_NE(ref->getKey(), IdRef("r", "3")->getKey());
+
+    ref->setN(Int("4"));
+    ASSERT_EQ(ref->getKey(), GetXbitKey("q[4]"));
+    ref->setId(Id("r"));
+    ASSERT_EQ(ref->getKey(), GetXbitKey("r[4]"));
+
+    auto id = Id("q");
+    ASSERT_EQ(GetXbitKey(id.get()), GetXbitKey("q"));
+    ASSERT_NE(GetXbitKey(id.get()), GetXbitKey("q[0]"));
+    ASSERT_EQ(StringInterner::Get(id->getSymbol()), "q");
+
+    // The position of not indexed ids can't be used by a bit.
+    ASSERT_EQ(IdRef("q", "4294967294")->getIndex(), XbitKeyNoIndex - 1);
+    ASSERT_DEATH({ IdRef("q", "4294967295"); }, "Bit index too big");
+    ASSERT_DEATH({ GetXbitKey("q[4294967295]"); }, "Bit index too big");
+    ASSERT_DEATH({ GetXbitKey("q[4294967296]"); }, "Bit index too big");
+}
+
+TEST(ASTNodeTests, ConcurrentInternTest) {
+    const uint32_t threadsNumber = 4, stringsNumber = 2000;
+    std::vector<std::vector<StringInterner::Symbol>> symbols(threadsNumber);
+    std::vector<std::thread> threads;
+
+    // Every thread interns the same strings, half of them in reverse order.
+    for (uint32_t t = 0; t < threadsNumber; ++t) {
+        threads.push_back(std::thread([&, t]() {
+            symbols[t].assign(stringsNumber, 0);
+            for (uint32_t j = 0; j < stringsNumber; ++j) {
+                uint32_t i = (t % 2 == 0) ? j : stringsNumber - 1 - j;
+                symbols[t][i] = StringInterner::Intern("concurrent" + std::to_string(i));
+            }
+        }));
+    }
+
+    for (auto& thread : threads) thread.join();
+
+    for (uint32_t i = 0; i < stringsNumber; ++i) {
+        for (uint32_t t = 1; t < threadsNumber; ++t) {
+            ASSERT_EQ(symbols[t][i], symbols[0][i]);
+        }
+
+        ASSERT_EQ(StringInterner::Get(symbols[0][i]), "concurrent" + std::to_string(i));
+    }
+
+    ASSERT_GE(StringInterner::Size(), stringsNumber);
+}
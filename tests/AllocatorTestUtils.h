@@ -0,0 +1,37 @@
+#ifndef __EFD_TESTS_ALLOCATOR_TEST_UTILS_H__
+#define __EFD_TESTS_ALLOCATOR_TEST_UTILS_H__
+
+#include "OptionGuard.h"
+
+#include "enfield/Transform/QModule.h"
+#include "enfield/Transform/Allocators/QbitAllocator.h"
+#include "enfield/Support/ThreadPool.h"
+
+#include <sstream>
+#include <string>
+
+namespace efd {
+    /// \brief Runs the allocator returned by \p create on \p program, with
+    /// `-threads` set to \p threads (restored afterwards).
+    ///
+    /// Returns the mapping, followed by the allocated program.
+    template <typename CreateFn>
+        std::string AllocateWithThreads(const std::string& program,
+                                        const std::string& threads,
+                                        CreateFn create) {
+            OptionGuard guard { &Threads };
+            const char* argv[] = { "AllocateWithThreads", "-threads", threads.c_str() };
+            ParseArguments(3, argv);
+
+            auto qmod = QModule::ParseString(program);
+            auto allocator = create();
+            allocator->run(qmod.get());
+
+            std::ostringstream ss;
+            ss << MappingToString(allocator->getData()) << std::endl;
+            qmod->print(ss, true);
+            return ss.str();
+        }
+}
+
+#endif
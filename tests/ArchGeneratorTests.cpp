@@ -0,0 +1,191 @@
+#include "gtest/gtest.h"
+
+#include "enfield/Arch/ArchGenerator.h"
+#include "enfield/Arch/Architectures.h"
+#include "enfield/Support/CommandLine.h"
+
+#include "OptionGuard.h"
+#include "enfield/Support/DistanceTable.h"
+
+#include <string>
+
+using namespace efd;
+
+static uint32_t CountEdges(ArchGraph::Ref graph) {
+    uint32_t edges = 0;
+
+    for (uint32_t u = 0, e = graph->size(); u < e; ++u) {
+        edges += graph->succ(u).size();
+        // Every coupling is in both directions.
+        for (uint32_t v : graph->succ(u)) {
+            EXPECT_TRUE(graph->hasEdge(v, u));
+        }
+    }
+
+    return edges;
+}
+
+TEST(ArchGeneratorTests, NamesTest) {
+    InitializeAllArchitectures();
+
+    ASSERT_TRUE(IsParametricArchitecture("grid-4x5"));
+    ASSERT_TRUE(IsParametricArchitecture("heavyhex-7x3"));
+    ASSERT_TRUE(IsParametricArchitecture("ring-10"));
+    ASSERT_TRUE(IsParametricArchitecture("tree-15"));
+    ASSERT_TRUE(IsParametricArchitecture("tree-13x3"));
+    ASSERT_TRUE(IsParametricArchitecture("alltoall-6"));
+
+    ASSERT_FALSE(IsParametricArchitecture("grid"));
+    ASSERT_FALSE(IsParametricArchitecture("grid-"));
+    ASSERT_FALSE(IsParametricArchitecture("grid-4"));
+    ASSERT_FALSE(IsParametricArchitecture("grid-4x"));
+    ASSERT_FALSE(IsParametricArchitecture("grid-4x5x6"));
+    ASSERT_FALSE(IsParametricArchitecture("grid-4xa"));
+    ASSERT_FALSE(IsParametricArchitecture("ring-3x3"));
+    ASSERT_FALSE(IsParametricArchitecture("moebius-10"));
+    ASSERT_FALSE(IsParametricArchitecture("A_ibmqx2"));
+
+    ASSERT_TRUE(IsArchitectureName("A_ibmqx2"));
+    ASSERT_TRUE(IsArchitectureName("grid-2x2"));
+    ASSERT_FALSE(IsArchitectureName("first"));
+    ASSERT_FALSE(IsArchitectureName("A_nothing"));
+
+    ASSERT_EQ(CreateArchitectureFromName("A_ibmqx2")->size(), 5u);
+    ASSERT_EQ(CreateArchitectureFromName("grid-2x3")->size(), 6u);
+}
+
+TEST(ArchGeneratorTests, GridTest) {
+    auto graph = CreateParametricArchitecture("grid-4x5");
+
+    ASSERT_EQ(graph->size(), 20u);
+    ASSERT_TRUE(graph->isFrozen());
+    ASSERT_EQ(CountEdges(graph.get()), 2u * (4 * 4 + 5 * 3));
+    ASSERT_EQ(graph->getSId(7), "q[7]");
+
+    ArchGraph::RegsVector regs(graph->reg_begin(), graph->reg_end());
+    ASSERT_EQ(regs, ArchGraph::RegsVector({ { "q", 20 } }));
+
+    auto table = graph->getDistanceTable();
+    ASSERT_EQ(table->get(0, 19), 3u + 4u);
+    ASSERT_EQ(table->get(4, 14), 2u);
+    ASSERT_EQ(graph->getW(0, 1), 1.0);
+}
+
+TEST(ArchGeneratorTests, HeavyHexTest) {
+    // Two rows of 7 qubits, joined by 2 bridges: a single heavy hexagon
+    // with two tails on each row.
+    auto graph = CreateParametricArchitecture("heavyhex-2x1");
+
+    ASSERT_EQ(graph->size(), 16u);
+    ASSERT_EQ(CountEdges(graph.get()), 2u * (6 + 6 + 4));
+    ASSERT_TRUE(graph->hasEdge(0, 7));
+    ASSERT_TRUE(graph->hasEdge(7, 9));
+    ASSERT_TRUE(graph->hasEdge(4, 8));
+    ASSERT_TRUE(graph->hasEdge(8, 13));
+    ASSERT_EQ(graph->getDistanceTable()->get(0, 13), 6u);
+
+    auto eagle = CreateParametricArchitecture("heavyhex-7x3");
+    ASSERT_EQ(eagle->size(), 7u * 15 + 6u * 4);
+
+    for (uint32_t u = 0, e = eagle->size(); u < e; ++u) {
+        ASSERT_LE(eagle->succ(u).size(), 3u);
+        ASSERT_GE(eagle->succ(u).size(), 1u);
+    }
+}
+
+TEST(ArchGeneratorTests, TooManyQubitsTest) {
+    ASSERT_DEATH({ CreateParametricArchitecture("grid-65536x65536"); }, "too many qubits");
+    ASSERT_DEATH({ CreateParametricArchitecture("heavyhex-2x999999999"); }, "too many qubits");
+}
+
+TEST(ArchGeneratorTests, RingTreeAllToAllTest) {
+    auto ring = CreateParametricArchitecture("ring-7");
+    ASSERT_EQ(CountEdges(ring.get()), 2u * 7);
+    ASSERT_EQ(ring->getDistanceTable()->get(0, 6), 1u);
+    ASSERT_EQ(ring->getDistanceTable()->get(0, 3), 3u);
+
+    auto tree = CreateParametricArchitecture("tree-7");
+    ASSERT_EQ(CountEdges(tree.get()), 2u * 6);
+    ASSERT_EQ(tree->getDistanceTable()->get(3, 6), 4u);
+
+    auto ternary = CreateParametricArchitecture("tree-13x3");
+    ASSERT_EQ(ternary->succ(0).size(), 3u);
+    ASSERT_EQ(ternary->succ(1).size(), 4u);
+    ASSERT_EQ(ternary->getDistanceTable()->get(4, 12), 4u);
+
+    auto all = CreateParametricArchitecture("alltoall-6");
+    ASSERT_EQ(CountEdges(all.get()), 6u * 5);
+
+    for (uint32_t u = 0; u < 6; ++u) {
+        for (uint32_t v = 0; v < 6; ++v) {
+            ASSERT_EQ(all->getDistanceTable()->get(u, v), u == v ? 0u : 1u);
+        }
+    }
+}
+
+TEST(ArchGeneratorTests, RegisterGeneratorTest) {
+    RegisterArchGenerator("line", 1, 1, [](const std::vector<uint32_t>& dims) {
+        return CreateParametricArchitecture("grid-1x" + std::to_string(dims[0]));
+    });
+
+    ASSERT_TRUE(IsArchitectureName("line-5"));
+    ASSERT_EQ(CreateArchitectureFromName("line-5")->getDistanceTable()->get(0, 4), 4u);
+}
+
+static void ExpectSameAsItsJson(ArchGraph::Ref graph) {
+    auto parsed = JsonBackendParser<ArchGraph>::Parse(graph->toJson());
+    uint32_t n = graph->size();
+
+    ASSERT_EQ(parsed->size(), n);
+
+    for (uint32_t i = 0; i < n; ++i) {
+        ASSERT_EQ(parsed->getSId(i), graph->getSId(i));
+        ASSERT_EQ(parsed->succ(i), graph->succ(i));
+
+        for (uint32_t j : graph->succ(i)) {
+            ASSERT_DOUBLE_EQ(parsed->getW(i, j), graph->getW(i, j));
+        }
+    }
+}
+
+TEST(ArchGeneratorTests, JsonTest) {
+    ExpectSameAsItsJson(CreateParametricArchitecture("heavyhex-3x2").get());
+    ExpectSameAsItsJson(CreateParametricArchitecture("tree-20").get());
+}
+
+#define CREATE_ARGS(nArgs, ...)                         \
+    std::vector<std::string> argsStr = { __VA_ARGS__ }; \
+    const char **argv = new const char*[nArgs];         \
+    for (int i = 0; i < nArgs; ++i)                     \
+        argv[i] = argsStr[i].c_str();
+
+// Restores `-arch-max-error` and `-arch-error-seed` after each test.
+class ArchGeneratorOptionsTests : public ::testing::Test {
+    private:
+        OptionGuard mGuard { &ArchMaxError, &ArchErrorSeed };
+};
+
+TEST_F(ArchGeneratorOptionsTests, RandomErrorsTest) {
+    {
+        CREATE_ARGS(3, "ArchGeneratorTests", "--arch-max-error", "0.1");
+        ParseArguments(3, argv);
+    }
+
+    auto graph = CreateParametricArchitecture("grid-5x5");
+    auto again = CreateParametricArchitecture("grid-5x5");
+    bool hasError = false;
+
+    for (uint32_t u = 0, e = graph->size(); u < e; ++u) {
+        for (uint32_t v : graph->succ(u)) {
+            double w = graph->getW(u, v);
+            ASSERT_GT(w, 0.9);
+            ASSERT_LE(w, 1.0);
+            ASSERT_EQ(w, graph->getW(v, u));
+            ASSERT_EQ(w, again->getW(u, v));
+            hasError = hasError || w != 1.0;
+        }
+    }
+
+    ASSERT_TRUE(hasError);
+    ExpectSameAsItsJson(graph.get());
+}
@@ -2,9 +2,16 @@
 
 #include "enfield/Arch/ArchGraph.h"
 #include "enfield/Support/JsonParser.h"
+#include "enfield/Support/DistanceTable.h"
 
+#include "OptionGuard.h"
+
+#include <cstdio>
+#include <fstream>
 #include <string>
 
+#include <sys/stat.h>
+
 using namespace efd;
 
 TEST(ArchGraphTests, TreeCreationTest) {
@@ -141,3 +148,124 @@ TEST(ArchGraphTests, MultipleRegisterArchitecture) {
         ASSERT_FALSE(!graph->hasEdge(4, 1));
     }
 }
+
+TEST(ArchGraphTests, PrecomputedDistancesTest) {
+    const std::string gStr =
+"{\n\
+    \"qubits\": 3,\n\
+    \"registers\": [ {\"name\": \"q\", \"qubits\": 3} ],\n\
+    \"adj\": [\n\
+        [ {\"v\": \"q[1]\"} ],\n\
+        [ {\"v\": \"q[2]\"} ],\n\
+        []\n\
+    ]\n\
+}";
+
+    auto graph = JsonParser<ArchGraph>::ParseString(gStr);
+    auto table = DistanceTable::Create(graph.get());
+
+    Json::Value root;
+    std::istringstream(gStr) >> root;
+    root[JsonFields<ArchGraph>::_DistancesLabel_] = table->toJson(graph.get());
+
+    auto loaded = JsonBackendParser<ArchGraph>::Parse(root);
+    auto loadedTable = loaded->getDistanceTable();
+    ASSERT_EQ(loadedTable->get(0, 2), (uint32_t) 2);
+    ASSERT_EQ(loadedTable->next(0, 2), (uint32_t) 1);
+    ASSERT_EQ(loadedTable->next(2, 0), (uint32_t) 1);
+
+    // Loaded tables are the same object on every call.
+    ASSERT_EQ(loadedTable.get(), loaded->getDistanceTable().get());
+}
+
+TEST(ArchGraphTests, DistanceTableFileTest) {
+    const std::string gStr =
+"{\n\
+    \"qubits\": 3,\n\
+    \"registers\": [ {\"name\": \"q\", \"qubits\": 3} ],\n\
+    \"adj\": [\n\
+        [ {\"v\": \"q[1]\"} ],\n\
+        [ {\"v\": \"q[2]\"} ],\n\
+        []\n\
+    ]\n\
+}";
+
+    const std::string dir = "ArchGraphTestsDir";
+    const std::string jsonFile = dir + "/arch.json", distFile = dir + "/arch.dist";
+    mkdir(dir.c_str(), 0755);
+
+    auto graph = JsonParser<ArchGraph>::ParseString(gStr);
+    auto table = DistanceTable::Create(graph.get());
+    table->writeBinary(graph.get(), distFile);
+
+    // Changes the distance from 0 to 2 (the third entry of the distance matrix,
+    // after the header). Only the header is checked with `-dist-table-no-verify`,
+    // so it is loaded anyway.
+    {
+        std::fstream fs(distFile, std::ios::in | std::ios::out | std::ios::binary);
+        fs.seekp(32 + 2 * sizeof(uint32_t));
+        uint32_t x = 7;
+        fs.write((const char*) &x, sizeof(x));
+    }
+
+    Json::Value root;
+    std::istringstream(gStr) >> root;
+    root[JsonFields<ArchGraph>::_DistancesLabel_] = table->toJson(graph.get(), "arch.dist");
+
+    {
+        std::ofstream ofs(jsonFile);
+        ofs << root;
+    }
+
+    // By default, the whole table is checked, so it is built on demand.
+    auto loaded = JsonParser<ArchGraph>::ParseFile(jsonFile);
+    ASSERT_EQ(loaded->getDistanceTable()->get(0, 2), 2u);
+
+    {
+        OptionGuard guard { &DistTableNoVerify };
+        const char* argv[] = { "ArchGraphTests", "--dist-table-no-verify" };
+        ParseArguments(2, argv);
+
+        // The file is relative to the json, not to the current directory.
+        loaded = JsonParser<ArchGraph>::ParseFile(jsonFile);
+        ASSERT_EQ(loaded->getDistanceTable()->get(0, 2), 7u);
+    }
+
+    // A missing file is ignored, and the table is built on demand.
+    std::remove(distFile.c_str());
+    loaded = JsonParser<ArchGraph>::ParseFile(jsonFile);
+    ASSERT_EQ(loaded->getDistanceTable()->get(0, 2), 2u);
+
+    std::remove(jsonFile.c_str());
+    std::remove(dir.c_str());
+}
+
+TEST(ArchGraphTests, NodeLookupTest) {
+    const std::string gStr =
+"{\n\
+    \"qubits\": 4,\n\
+    \"registers\": [ {\"name\": \"q\", \"qubits\": 2}, {\"name\": \"r\", \"qubits\": 2} ],\n\
+    \"adj\": [\n\
+        [ {\"v\": \"r[1]\"} ],\n\
+        [],\n\
+        [],\n\
+        []\n\
+    ]\n\
+}";
+
+    auto graph = JsonParser<ArchGraph>::ParseString(gStr);
+    ASSERT_FALSE(graph.get() == nullptr);
+
+    for (uint32_t i = 0; i < graph->size(); ++i) {
+        auto node = graph->getNode(i);
+        ASSERT_TRUE(graph->hasNode(node));
+        ASSERT_EQ(graph->getUId(node), i);
+        ASSERT_EQ(graph->getUId(node), graph->getUId(graph->getSId(i)));
+    }
+
+    auto q = NDId::Create("q");
+    auto outOfBounds = NDIdRef::Create(NDId::Create("q"), NDInt::Create(std::string("2")));
+    ASSERT_FALSE(graph->hasNode(q.get()));
+    ASSERT_FALSE(graph->hasNode(outOfBounds.get()));
+    ASSERT_DEATH({ graph->getUId(outOfBounds.get()); }, "No such vertex");
+}
@@ -0,0 +1,54 @@
+#include "gtest/gtest.h"
+
+#include "enfield/Arch/Architectures.h"
+#include "enfield/Support/DistanceTable.h"
+#include "enfield/Support/JsonParser.h"
+
+#include <string>
+
+using namespace efd;
+
+// The built-in architectures are created from tables generated at build time.
+// They should be the same as the ones we get by parsing their json.
+static void ExpectSameAsJson(EnumArchitecture key, std::string json) {
+    InitializeAllArchitectures();
+
+    auto builtin = CreateArchitecture(key);
+    auto parsed = JsonParser<ArchGraph>::ParseString(json.substr(1, json.length() - 2));
+    uint32_t n = parsed->size();
+
+    ASSERT_EQ(builtin->size(), n);
+    ASSERT_TRUE(builtin->isFrozen());
+
+    for (uint32_t i = 0; i < n; ++i) {
+        ASSERT_EQ(builtin->getSId(i), parsed->getSId(i));
+        ASSERT_EQ(builtin->getNode(i)->toString(), parsed->getNode(i)->toString());
+        ASSERT_EQ(builtin->succ(i), parsed->succ(i));
+        ASSERT_EQ(builtin->pred(i), parsed->pred(i));
+
+        for (uint32_t j : parsed->succ(i)) {
+            ASSERT_EQ(builtin->getW(i, j), parsed->getW(i, j));
+        }
+    }
+
+    auto builtinTable = builtin->getDistanceTable();
+    auto parsedTable = parsed->getDistanceTable();
+
+    for (uint32_t u = 0; u < n; ++u) {
+        for (uint32_t v = 0; v < n; ++v) {
+            ASSERT_EQ(builtinTable->get(u, v), parsedTable->get(u, v));
+            ASSERT_EQ(builtinTable->prev(u, v), parsedTable->prev(u, v));
+        }
+    }
+
+    ArchGraph::RegsVector builtinRegs(builtin->reg_begin(), builtin->reg_end());
+    ArchGraph::RegsVector parsedRegs(parsed->reg_begin(), parsed->reg_end());
+    ASSERT_EQ(builtinRegs, parsedRegs);
+}
+
+#define EFD_ARCH(_Name_, _Json_) \
+TEST(ArchitecturesTests, _Name_##SameAsJsonTest) { \
+    ExpectSameAsJson(Architecture::A_##_Name_, #_Json_); \
+}
+#include "enfield/Arch/Architectures.def"
+#undef EFD_ARCH
@@ -0,0 +1,117 @@
+#include "gtest/gtest.h"
+
+#include "enfield/Support/Arena.h"
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace efd;
+
+TEST(ArenaTests, BumpAllocationTest) {
+    auto arena = Arena::Create();
+    std::vector<char*> blocks;
+
+    {
+        Arena::Scope scope(arena);
+
+        for (uint32_t i = 1; i <= 1000; ++i) {
+            auto block = static_cast<char*>(Arena::Allocate(i));
+            std::memset(block, i % 256, i);
+            blocks.push_back(block);
+        }
+    }
+
+    for (uint32_t i = 1; i <= 1000; ++i) {
+        auto block = blocks[i - 1];
+        ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(block) % sizeof(void*));
+
+        for (uint32_t j = 0; j < i; ++j) {
+            ASSERT_EQ((char) (i % 256), block[j]);
+        }
+    }
+
+    // Many blocks share a few chunks.
+    ASSERT_GT(arena->getChunksSize(), 1000u * 1001u / 2);
+    ASSERT_LT(arena->getChunksSize(), 4u * 1024u * 1024u);
+
+    for (uint32_t i = 1; i <= 1000; ++i) {
+        Arena::Deallocate(blocks[i - 1], i);
+    }
+
+    ASSERT_EQ(0u, arena->getLiveBlocks());
+}
+
+TEST(ArenaTests, HeapFallbackTest) {
+    // Without an arena in scope, blocks come from the heap.
+    auto block = Arena::Allocate(16);
+    std::memset(block, 0, 16);
+    Arena::Deallocate(block, 16);
+
+    auto arena = Arena::Create();
+    {
+        Arena::Scope scope(arena);
+        {
+            Arena::Scope heapScope(nullptr);
+            auto heapBlock = Arena::Allocate(16);
+            Arena::Deallocate(heapBlock, 16);
+        }
+    }
+
+    ASSERT_EQ(0u, arena->getChunksSize());
+}
+
+TEST(ArenaTests, BlocksOutliveArenaRefTest) {
+    std::vector<int, ArenaAllocator<int>> numbers;
+
+    {
+        auto arena = Arena::Create();
+        Arena::Scope scope(arena);
+
+        for (int i = 0; i < 10000; ++i) {
+            numbers.push_back(i);
+        }
+    }
+
+    for (int i = 0; i < 10000; ++i) {
+        ASSERT_EQ(i, numbers[i]);
+    }
+}
+
+TEST(ArenaTests, FreedBlocksReuseTest) {
+    auto arena = Arena::Create();
+    std::vector<void*> blocks, reused;
+
+    {
+        Arena::Scope scope(arena);
+
+        for (uint32_t i = 0; i < 1000; ++i) blocks.push_back(Arena::Allocate(24));
+        for (auto block : blocks) Arena::Deallocate(block, 24);
+        ASSERT_EQ(0u, arena->getLiveBlocks());
+
+        // Blocks of the same size are handed out again.
+        auto chunksSize = arena->getChunksSize();
+        for (uint32_t i = 0; i < 1000; ++i) reused.push_back(Arena::Allocate(24));
+        ASSERT_EQ(chunksSize, arena->getChunksSize());
+        ASSERT_EQ(1000u, arena->getLiveBlocks());
+    }
+
+    std::sort(blocks.begin(), blocks.end());
+    std::sort(reused.begin(), reused.end());
+    ASSERT_EQ(blocks, reused);
+
+    // Out of scope, they are only counted.
+    for (auto block : reused) Arena::Deallocate(block, 24);
+    ASSERT_EQ(0u, arena->getLiveBlocks());
+}
+
+TEST(ArenaTests, ScopeInOneThreadTest) {
+    auto arena = Arena::Create();
+    Arena::Scope scope(arena);
+
+    ASSERT_DEATH({
+        std::thread other([&]() { Arena::Scope otherScope(arena); });
+        other.join();
+    }, "another thread");
+}
@@ -0,0 +1,66 @@
+#include "gtest/gtest.h"
+
+#include "enfield/Support/BitParallelBFSDistance.h"
+#include "enfield/Support/BFSCachedDistance.h"
+
+#include <random>
+
+using namespace efd;
+
+static Graph::uRef RandomGraph(uint32_t n, uint32_t m, uint32_t seed) {
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<uint32_t> vertex(0, n - 1);
+
+    auto graph = Graph::Create(n, Graph::Directed);
+
+    for (uint32_t i = 0; i < m; ++i) {
+        uint32_t u = vertex(gen), v = vertex(gen);
+        if (u != v) graph->putEdge(u, v);
+    }
+
+    return graph;
+}
+
+static void ExpectSameAsBFS(Graph::Ref graph, uint32_t nThreads) {
+    auto bfs = BFSCachedDistance::Create();
+    auto bitBFS = BitParallelBFSDistance::Create(nThreads);
+    bfs->init(graph);
+    bitBFS->init(graph);
+
+    for (uint32_t u = 0, e = graph->size(); u < e; ++u) {
+        for (uint32_t v = 0; v < e; ++v) {
+            ASSERT_EQ(bitBFS->get(u, v), bfs->get(u, v));
+            ASSERT_EQ(bitBFS->row(u)[v], bfs->get(u, v));
+        }
+    }
+}
+
+TEST(BitParallelBFSDistanceTests, LineTest) {
+    auto graph = Graph::Create(100, Graph::Directed);
+
+    for (uint32_t i = 0; i < 99; ++i) {
+        graph->putEdge(i + 1, i);
+    }
+
+    auto bitBFS = BitParallelBFSDistance::Create();
+    bitBFS->init(graph.get());
+    ASSERT_EQ(bitBFS->get(0, 99), (uint32_t) 99);
+    ASSERT_EQ(bitBFS->get(70, 3), (uint32_t) 67);
+    ASSERT_EQ(bitBFS->get(64, 64), (uint32_t) 0);
+}
+
+TEST(BitParallelBFSDistanceTests, RandomGraphsTest) {
+    // Around the size of a batch, and with unconnected vertices.
+    for (uint32_t n : { 1u, 2u, 63u, 64u, 65u, 130u }) {
+        for (uint32_t m : { n / 2, n, 4 * n }) {
+            auto graph = RandomGraph(n, m, n * 100 + m);
+            ExpectSameAsBFS(graph.get(), 1);
+        }
+    }
+}
+
+TEST(BitParallelBFSDistanceTests, ThreadedTest) {
+    auto graph = RandomGraph(300, 600, 17);
+    graph->freeze();
+    ExpectSameAsBFS(graph.get(), 4);
+}
@@ -11,8 +11,14 @@
 #include "enfield/Support/RTTI.h"
 #include "enfield/Support/uRefCast.h"
 #include "enfield/Support/ApproxTSFinder.h"
+#include "enfield/Support/CommandLine.h"
+#include "enfield/Support/ThreadPool.h"
+
+#include "AllocatorTestUtils.h"
 
 #include <string>
+#include <sstream>
+#include <algorithm>
 
 using namespace efd;
 
@@ -90,6 +96,12 @@ void TestAllocation(const std::string program) {
         FillIBMT(allocator.get());
         TestAllocator(qmod.get(), g, allocator.get());
     }
+    {
+        auto allocator = BoundedMappingTreeQAllocator::Create(g);
+        FillBMT(allocator.get());
+        allocator->setDedupeCandidates(true);
+        TestAllocator(qmod.get(), g, allocator.get());
+    }
 }
 
 TEST(BoundedMappingTreeQAllocatorTests, SimpleNoSwapProgram) {
@@ -154,3 +166,195 @@ test q[4], q[1], q[0];\
         TestAllocation(program);
     }
 }
+
+static std::string AllocateWithThreads(const std::string program, std::string threads) {
+    static ArchGraph::sRef g(nullptr);
+    if (g.get() == nullptr) g = createGraph();
+
+    return efd::AllocateWithThreads(program, threads, [&]() {
+        auto allocator = BoundedMappingTreeQAllocator::Create(g);
+        FillBMT(allocator.get());
+        return allocator;
+    });
+}
+
+TEST(BoundedMappingTreeQAllocatorTests, ParallelPhase2Test) {
+    const std::string program =
+"\
+qreg q[5];\
+CX q[0], q[1];\
+CX q[1], q[2];\
+CX q[2], q[3];\
+CX q[3], q[4];\
+CX q[4], q[0];\
+CX q[0], q[2];\
+CX q[1], q[3];\
+CX q[2], q[4];\
+CX q[3], q[0];\
+CX q[4], q[1];\
+";
+
+    auto serial = AllocateWithThreads(program, "1");
+    EXPECT_EQ(serial, AllocateWithThreads(program, "2"));
+    EXPECT_EQ(serial, AllocateWithThreads(program, "4"));
+}
+
+static std::string AllocateWithPruning(const std::string program, bool prune,
+                                       uint64_t& pruned) {
+    static ArchGraph::sRef g(nullptr);
+    if (g.get() == nullptr) g = createGraph();
+
+    auto qmod = QModule::ParseString(program);
+    auto allocator = BoundedMappingTreeQAllocator::Create(g);
+    FillBMT(allocator.get());
+    allocator->setPhase2Pruning(prune);
+    allocator->run(qmod.get());
+    pruned = allocator->getPrunedTransitions();
+
+    std::ostringstream ss;
+    ss << MappingToString(allocator->getData()) << std::endl;
+    qmod->print(ss, true);
+    return ss.str();
+}
+
+TEST(BoundedMappingTreeQAllocatorTests, Phase2PruningTest) {
+    const std::string program =
+"\
+qreg q[5];\
+CX q[3], q[0];\
+CX q[0], q[1];\
+CX q[1], q[4];\
+CX q[1], q[4];\
+CX q[2], q[1];\
+CX q[0], q[1];\
+CX q[3], q[4];\
+CX q[2], q[4];\
+CX q[1], q[2];\
+CX q[1], q[3];\
+CX q[4], q[2];\
+CX q[0], q[3];\
+CX q[1], q[4];\
+CX q[4], q[0];\
+CX q[0], q[4];\
+CX q[4], q[0];\
+";
+
+    uint64_t pruned, notPruned;
+    auto withPruning = AllocateWithPruning(program, true, pruned);
+    auto withoutPruning = AllocateWithPruning(program, false, notPruned);
+
+    // Same mappings and swaps, thus the same cost.
+    EXPECT_EQ(withoutPruning, withPruning);
+    EXPECT_GT(pruned, 0u);
+    EXPECT_EQ(0u, notPruned);
+}
+
+TEST(BoundedMappingTreeQAllocatorTests, MappingArenaReusesMemoryTest) {
+    bmt::MappingArena arena(4), other(4);
+
+    uint32_t r = other.push();
+    for (uint32_t i = 0; i < 4; ++i) other.row(r)[i] = i;
+
+    for (uint32_t step = 0; step < 3; ++step) {
+        arena.clear();
+
+        for (uint32_t i = 0; i < 10; ++i) {
+            uint32_t cpy = arena.push(other, r);
+            ASSERT_EQ(i, cpy);
+            ASSERT_TRUE(std::equal(other.row(r), other.row(r) + 4, arena.row(cpy)));
+        }
+    }
+
+    uint32_t growths = arena.getGrowths();
+    arena.clear();
+    for (uint32_t i = 0; i < 10; ++i) arena.push();
+
+    EXPECT_EQ(10u, arena.size());
+    EXPECT_EQ(growths, arena.getGrowths());
+}
+
+TEST(BoundedMappingTreeQAllocatorTests, CandidateDeduplicatorTest) {
+    // Rows hold a 3-qubit mapping followed by one extra (ignored) element.
+    std::vector<std::vector<uint32_t>> rows {
+        { 0, 1, 2, 7 }, { 1, 0, 2, 8 }, { 0, 1, 2, 9 }, { 2, 1, 0, 7 }, { 1, 0, 2, 7 }
+    };
+
+    bmt::MappingArena arena(4);
+    for (auto& row : rows) {
+        uint32_t r = arena.push();
+        std::copy(row.begin(), row.end(), arena.row(r));
+    }
+
+    bmt::ACandidateVector candidates { { 0, 5 }, { 1, 3 }, { 2, 4 }, { 3, 6 }, { 4, 1 } };
+
+    bmt::CandidateDeduplicator deduplicator;
+    ASSERT_EQ(2u, deduplicator.dedupe(arena, 3, candidates));
+    ASSERT_EQ(3u, candidates.size());
+
+    // Kept in the position of the first copy, with the cheapest row.
+    EXPECT_EQ(2u, candidates[0].row);
+    EXPECT_EQ(4u, candidates[0].cost);
+    EXPECT_EQ(4u, candidates[1].row);
+    EXPECT_EQ(1u, candidates[1].cost);
+    EXPECT_EQ(3u, candidates[2].row);
+    EXPECT_EQ(6u, candidates[2].cost);
+
+    // No duplicates left, and the table is not reallocated.
+    uint32_t growths = deduplicator.getGrowths();
+    EXPECT_EQ(0u, deduplicator.dedupe(arena, 3, candidates));
+    EXPECT_EQ(3u, candidates.size());
+    EXPECT_EQ(growths, deduplicator.getGrowths());
+}
+
+TEST(BoundedMappingTreeQAllocatorTests, FlatGeoDistanceEstimatorTest) {
+    auto g = createGraph();
+    uint32_t qubits = g->size();
+
+    auto geo = GeoDistanceSwapCEstimator::Create();
+    auto scalar = FlatGeoDistanceSwapCEstimator::Create();
+    auto simd = FlatGeoDistanceSwapCEstimator::Create();
+    scalar->setUseAVX2(false);
+    ASSERT_FALSE(scalar->usesAVX2());
+
+    geo->init(g.get());
+    scalar->init(g.get());
+    simd->init(g.get());
+
+    Mapping fromM = IdentityMapping(qubits);
+
+    // Enough qubits for, at least, one full AVX2 iteration.
+    for (uint32_t n = qubits; n <= 2 * qubits; ++n) {
+        Mapping from(n), to(n);
+
+        do {
+            for (uint32_t i = 0; i < n; ++i) {
+                from[i] = (i % 3 == 0) ? _undef : fromM[i % qubits];
+                to[i] = fromM[(i + n) % qubits];
+            }
+
+            auto expected = geo->estimate(from, to);
+            EXPECT_EQ(expected, scalar->estimate(from, to));
+            EXPECT_EQ(expected, simd->estimate(from, to));
+        } while (std::next_permutation(fromM.begin(), fromM.end()));
+    }
+}
+
+TEST(BoundedMappingTreeQAllocatorTests, FlatGeoDistanceUnconnectedTest) {
+    // The distance between the two halves is `_undef`, which doesn't fit
+    // in the flat table.
+    auto g = Graph::Create(4);
+    g->putEdge(0, 1);
+    g->putEdge(2, 3);
+
+    auto geo = GeoDistanceSwapCEstimator::Create();
+    auto flat = FlatGeoDistanceSwapCEstimator::Create();
+    geo->init(g.get());
+    flat->init(g.get());
+
+    Mapping from { 0, 1, _undef };
+    Mapping to { 2, 0, 3 };
+    EXPECT_EQ(geo->estimate(from, to), flat->estimate(from, to));
+
+    to = { 1, 0, 3 };
+    EXPECT_EQ(2u, flat->estimate(from, to));
+}
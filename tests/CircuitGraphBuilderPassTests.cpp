@@ -17,7 +17,7 @@ static void CheckCircuitGraph(std::string prog, Checker checker) {
     auto cgbp = CircuitGraphBuilderPass::Create();
     cgbp->run(qmod.get());
 
-    auto cgraph = cgbp->getData();
+    auto& cgraph = cgbp->getData();
     auto it = cgraph.build_iterator();
     auto xbits = cgraph.size();
 
@@ -61,6 +61,8 @@ static void CheckCircuitGraph(std::string prog, Checker checker) {
         for (auto cnode : completed) {
             bool found = false;
 
+            ASSERT_EQ(qmod->getStatement(cnode->index()), cnode->node());
+
             uint32_t i = 0;
             for (uint32_t e = checker.used.size(); i < e; ++i) {
                 std::set<uint32_t> idSet;
@@ -9,6 +9,7 @@
 #include "enfield/Support/uRefCast.h"
 
 #include <string>
+#include <type_traits>
 #include <unordered_map>
 
 using namespace efd;
@@ -34,7 +35,7 @@ gate cnot x, y {\
         NDGateDecl::Ref gate = dynCast<NDGateDecl>(sign);
         ASSERT_FALSE(gate == nullptr);
 
-        auto data = pass->getData();
+        auto& data = pass->getData();
         auto deps = data.getDependencies(gate);
         // Has only one parallel dependency.
         ASSERT_EQ(deps.size(), (uint32_t) 1);
@@ -77,7 +78,7 @@ gate cnot x, y {\
         NDGateDecl::Ref cnotGate = dynCast<NDGateDecl>(cnotSign);
         ASSERT_FALSE(cnotGate == nullptr);
 
-        auto data = pass->getData();
+        auto& data = pass->getData();
         auto cxDeps = data.getDependencies(cxGate);
         auto cnotDeps = data.getDependencies(cnotGate);
 
@@ -120,7 +121,7 @@ CX q[0], q[1];\
         uint32_t q0 = 0;
         uint32_t q1 = 1;
 
-        auto data = pass->getData();
+        auto& data = pass->getData();
         auto deps = data.getDependencies();
 
         // Has only one parallel dependency.
@@ -196,7 +197,7 @@ measure carry[0] -> carryout[0];\
             { "ccx", { 6, 6 } }, { "cx", { 1, 1 } }, { "x", { 0, 0 } }, { "majority", { 3, 8 } }, { "add4", { 9, 65 } }, { "unmaj", { 3, 8 } }
         };
 
-        auto data = pass->getData();
+        auto& data = pass->getData();
         DependencyBuilder::DepsVector deps;
         for (auto pair : gatesInfo) {
             auto sign = qmod->getQGate(pair.first);
@@ -214,3 +215,113 @@ measure carry[0] -> carryout[0];\
         PassCache::Clear();
     }
 }
+
+TEST(DependencyBuilderWrapperPassTest, InstructionDependenciesTest) {
+    const std::string program = \
+"\
+include \"qelib1.inc\";\
+qreg q[3];\
+creg c[3];\
+CX q[0], q[1];\
+h q[2];\
+ccx q[0], q[1], q[2];\
+if (c == 1) CX q[2], q[0];\
+";
+
+    auto qmod = toShared(QModule::ParseString(program));
+    auto pass = DependencyBuilderWrapperPass::Create();
+    pass->run(qmod.get());
+
+    auto& data = pass->getData();
+    std::vector<Node::Ref> stmts;
+    for (auto it = qmod->stmt_begin(), e = qmod->stmt_end(); it != e; ++it) {
+        stmts.push_back(it->get());
+    }
+
+    // Statements are indexed by their position.
+    for (uint32_t i = 0; i < stmts.size(); ++i) {
+        ASSERT_EQ(data.getIndex(stmts[i]), i);
+        ASSERT_EQ(data.getDepsAt(i).mCallPoint, stmts[i]);
+    }
+
+    // CX; h; ccx; if.
+    ASSERT_EQ(stmts.size(), 4u);
+
+    auto cx = data.getDeps(stmts[0]);
+    ASSERT_EQ(cx.size(), 1u);
+    ASSERT_EQ(cx[0].mFrom, 0u);
+    ASSERT_EQ(cx[0].mTo, 1u);
+
+    ASSERT_TRUE(data.getDeps(stmts[1]).empty());
+    ASSERT_EQ(data.getDeps(stmts[2]).size(), 6u);
+
+    // The `if` has the dependencies of the instruction inside (which is
+    // indexed as well).
+    auto ifStmt = dynCast<NDIfStmt>(stmts[3]);
+    ASSERT_FALSE(ifStmt == nullptr);
+    ASSERT_EQ(data.getDeps(ifStmt).size(), 1u);
+    ASSERT_EQ(data.getDeps(ifStmt)[0].mFrom, 2u);
+    ASSERT_EQ(data.getDeps(ifStmt)[0].mTo, 0u);
+    ASSERT_EQ(data.getDeps(ifStmt).mCallPoint, ifStmt);
+
+    auto inner = data.getDeps(ifStmt->getQOp());
+    ASSERT_EQ(inner.size(), 1u);
+    ASSERT_EQ(inner[0].mFrom, 2u);
+    ASSERT_EQ(inner[0].mTo, 0u);
+    ASSERT_EQ(inner.mCallPoint, ifStmt->getQOp());
+    ASSERT_GE(data.getIndex(ifStmt->getQOp()), stmts.size());
+
+    auto copy = inner.toDependencies();
+    ASSERT_EQ(copy.size(), 1u);
+    ASSERT_EQ(copy.mCallPoint, ifStmt->getQOp());
+
+    // Instructions never seen have no dependencies.
+    auto unknown = NDQOpCX::Create(stmts[0]->getChild(0)->clone(),
+                                   stmts[0]->getChild(1)->clone());
+    ASSERT_EQ(data.getIndex(unknown.get()), _undef);
+    ASSERT_TRUE(data.getDeps(unknown.get()).empty());
+    ASSERT_EQ(data.getDeps(unknown.get()).mCallPoint, unknown.get());
+
+    PassCache::Clear();
+}
+
+TEST(DependencyBuilderWrapperPassTest, PassCacheSharingTest) {
+    const std::string program =
+"\
+qreg q[3];\
+CX q[0], q[1];\
+CX q[1], q[2];\
+";
+
+    auto qmod = toShared(QModule::ParseString(program));
+
+    auto xtn = PassCache::Get<XbitToNumberWrapperPass>(qmod.get());
+    auto dbw = PassCache::Get<DependencyBuilderWrapperPass>(qmod.get());
+
+    // Handles point to the data inside the cached passes. Nothing is copied.
+    auto xtnData = PassCache::GetData<XbitToNumberWrapperPass>(qmod.get());
+    auto dbwData = PassCache::GetData<DependencyBuilderWrapperPass>(qmod.get());
+    ASSERT_EQ(xtnData.get(), &xtn->getData());
+    ASSERT_EQ(dbwData.get(), &dbw->getData());
+
+    // The dependency builder shares the qubit map it was built from.
+    ASSERT_EQ(&dbwData->getXbitToNumber(), xtnData.get());
+
+    // Handles outlive the cache.
+    PassCache::Clear(qmod.get());
+    ASSERT_EQ(dbwData->getXbitToNumber().getQSize(), 3u);
+    ASSERT_EQ(dbwData->getDependencies().size(), 2u);
+    ASSERT_EQ(dbwData->getDepsAt(1)[0].mFrom, 1u);
+
+    // Only explicit copies are accounted, and `auto x = pass->getData()` does not compile.
+    static_assert(!std::is_convertible<const DependencyBuilder&, DependencyBuilder>::value,
+                  "DependencyBuilder must not be implicitly copied.");
+    static_assert(!std::is_convertible<const XbitToNumber&, XbitToNumber>::value,
+                  "XbitToNumber must not be implicitly copied.");
+    uint64_t copied = PassCacheBytesCopied.getVal();
+    auto copy = PassCache::CopyData<DependencyBuilderWrapperPass>(qmod.get());
+    ASSERT_EQ(copy.getDependencies().size(), 2u);
+    ASSERT_GT(PassCacheBytesCopied.getVal(), copied);
+
+    PassCache::Clear();
+}
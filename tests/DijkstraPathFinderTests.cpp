@@ -0,0 +1,29 @@
+#include "gtest/gtest.h"
+
+#include "enfield/Support/DijkstraPathFinder.h"
+
+using namespace efd;
+
+TEST(DijkstraPathFinderTests, CheapestPathTest) {
+    auto graph = WeightedGraph<uint32_t>::Create(5, Graph::Directed);
+    graph->putEdge(0, 1, 10);
+    graph->putEdge(1, 4, 10);
+    graph->putEdge(0, 2, 1);
+    graph->putEdge(2, 3, 1);
+    graph->putEdge(4, 3, 1);
+
+    auto finder = DijkstraPathFinder<uint32_t>::Create();
+    ASSERT_EQ(finder->find(graph.get(), 0, 4), std::vector<uint32_t>({ 0, 2, 3, 4 }));
+    ASSERT_EQ(finder->find(graph.get(), 4, 0), std::vector<uint32_t>({ 4, 3, 2, 0 }));
+    ASSERT_EQ(finder->find(graph.get(), 1, 1), std::vector<uint32_t>({ 1 }));
+}
+
+TEST(DijkstraPathFinderTests, DoubleWeightsTest) {
+    auto graph = WeightedGraph<double>::Create(3, Graph::Directed);
+    graph->putEdge(0, 1, 0.25);
+    graph->putEdge(1, 2, 0.25);
+    graph->putEdge(0, 2, 0.75);
+
+    auto finder = DijkstraPathFinder<double>::Create();
+    ASSERT_EQ(finder->find(graph.get(), 0, 2), std::vector<uint32_t>({ 0, 1, 2 }));
+}
@@ -0,0 +1,196 @@
+#include "gtest/gtest.h"
+
+#include "enfield/Support/DistanceTable.h"
+#include "enfield/Support/BFSPathFinder.h"
+#include "enfield/Support/Defs.h"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+using namespace efd;
+
+static const std::string gStr =
+"{\
+    \"vertices\": 6,\
+    \"type\": \"Directed\",\
+    \"adj\": [\
+        [ {\"v\": 1} ],\
+        [ {\"v\": 2} ],\
+        [],\
+        [ {\"v\": 2}, {\"v\": 4} ],\
+        [ {\"v\": 0} ],\
+        []\
+    ]\
+}";
+
+TEST(DistanceTableTests, DistancesTest) {
+    auto graph = JsonParser<Graph>::ParseString(gStr);
+    auto table = DistanceTable::Create(graph.get());
+
+    ASSERT_EQ(table->size(), 6u);
+    ASSERT_EQ(table->get(0, 0), 0u);
+    ASSERT_EQ(table->get(0, 1), 1u);
+    ASSERT_EQ(table->get(2, 0), 2u);
+    ASSERT_EQ(table->get(1, 3), 2u);
+    ASSERT_EQ(table->get(0, 5), _undef);
+
+    for (uint32_t u = 0; u < 6; ++u)
+        for (uint32_t v = 0; v < 6; ++v)
+            ASSERT_EQ(table->get(u, v), table->get(v, u));
+}
+
+TEST(DistanceTableTests, PathAndNextTest) {
+    auto graph = JsonParser<Graph>::ParseString(gStr);
+    auto table = DistanceTable::Create(graph.get());
+    auto finder = BFSPathFinder::Create();
+
+    for (uint32_t u = 0; u < 5; ++u) {
+        for (uint32_t v = 0; v < 5; ++v) {
+            auto path = table->path(u, v);
+            ASSERT_EQ(path, finder->find(graph.get(), u, v));
+            ASSERT_EQ(path.size(), table->get(u, v) + 1);
+
+            if (u == v) {
+                ASSERT_EQ(table->next(u, v), _undef);
+                continue;
+            }
+
+            uint32_t w = table->next(u, v);
+            ASSERT_EQ(table->get(w, v) + 1, table->get(u, v));
+            ASSERT_EQ(table->prev(u, v), path[path.size() - 2]);
+        }
+    }
+
+    ASSERT_EQ(table->next(0, 5), _undef);
+    ASSERT_TRUE(table->path(0, 5).empty());
+}
+
+TEST(DistanceTableTests, ThreadedTest) {
+    auto graph = JsonParser<Graph>::ParseString(gStr);
+    auto seq = DistanceTable::Create(graph.get());
+    auto par = DistanceTable::Create(graph.get(), 3);
+
+    for (uint32_t u = 0; u < 6; ++u)
+        for (uint32_t v = 0; v < 6; ++v) {
+            ASSERT_EQ(seq->get(u, v), par->get(u, v));
+            ASSERT_EQ(seq->path(u, v), par->path(u, v));
+        }
+}
+
+TEST(DistanceTableTests, BitParallelTest) {
+    // Big enough for the bit-parallel BFS (see `-dist-table-bit-bfs-min`): a
+    // directed ring with a few chords, and one vertex left unreachable.
+    const uint32_t n = 200;
+    auto graph = Graph::Create(n, Graph::Type::Directed);
+
+    for (uint32_t u = 0; u + 1 < n - 1; ++u) graph->putEdge(u, u + 1);
+    for (uint32_t u = 0; u + 37 < n - 1; u += 13) graph->putEdge(u + 37, u);
+    graph->freeze();
+
+    auto table = DistanceTable::Create(graph.get(), 2);
+    auto finder = BFSPathFinder::Create();
+
+    for (uint32_t u = 0; u < n - 1; ++u) {
+        ASSERT_EQ(table->get(u, n - 1), _undef);
+        ASSERT_TRUE(table->path(u, n - 1).empty());
+
+        for (uint32_t v = 0; v < n - 1; ++v) {
+            auto path = table->path(u, v);
+            ASSERT_EQ(path.size(), finder->find(graph.get(), u, v).size());
+            ASSERT_EQ(path.size(), table->get(u, v) + 1);
+            ASSERT_EQ(path.front(), u);
+            ASSERT_EQ(path.back(), v);
+
+            for (uint32_t i = 1; i < path.size(); ++i) {
+                uint32_t a = path[i - 1], b = path[i];
+                ASSERT_TRUE(graph->hasEdge(a, b) || graph->hasEdge(b, a));
+            }
+        }
+    }
+}
+
+TEST(DistanceTableTests, SharedByGraphTest) {
+    auto graph = JsonParser<Graph>::ParseString(gStr);
+    auto t1 = graph->getDistanceTable();
+    auto t2 = graph->getDistanceTable();
+    ASSERT_EQ(t1.get(), t2.get());
+
+    graph->putEdge(2, 5);
+    auto t3 = graph->getDistanceTable();
+    ASSERT_NE(t1.get(), t3.get());
+    ASSERT_EQ(t3->get(0, 5), 3u);
+    ASSERT_EQ(t1->get(0, 5), _undef);
+}
+
+static void ExpectSameTable(DistanceTable::Ref lhs, DistanceTable::Ref rhs) {
+    ASSERT_EQ(lhs->size(), rhs->size());
+
+    for (uint32_t u = 0, e = lhs->size(); u < e; ++u)
+        for (uint32_t v = 0; v < e; ++v) {
+            ASSERT_EQ(lhs->get(u, v), rhs->get(u, v));
+            ASSERT_EQ(lhs->next(u, v), rhs->next(u, v));
+            ASSERT_EQ(lhs->prev(u, v), rhs->prev(u, v));
+        }
+}
+
+TEST(DistanceTableTests, JsonRoundTripTest) {
+    auto graph = JsonParser<Graph>::ParseString(gStr);
+    auto table = DistanceTable::Create(graph.get());
+
+    auto root = table->toJson(graph.get());
+    auto loaded = DistanceTable::FromJson(graph.get(), root);
+    ASSERT_FALSE(loaded.get() == nullptr);
+    ExpectSameTable(table.get(), loaded.get());
+
+    // A table of some other graph is refused.
+    auto other = JsonParser<Graph>::ParseString(gStr);
+    other->putEdge(2, 5);
+    ASSERT_TRUE(DistanceTable::FromJson(other.get(), root).get() == nullptr);
+
+    root[JsonFields<DistanceTable>::_DistLabel_][0][1] = 3;
+    ASSERT_TRUE(DistanceTable::FromJson(graph.get(), root).get() == nullptr);
+}
+
+TEST(DistanceTableTests, BinaryRoundTripTest) {
+    auto graph = JsonParser<Graph>::ParseString(gStr);
+    auto table = DistanceTable::Create(graph.get());
+    const std::string filename = "DistanceTableTests.dist";
+
+    table->writeBinary(graph.get(), filename);
+    auto checksum = DistanceTable::ChecksumFromJson(table->toJson(graph.get(), filename));
+    ASSERT_EQ(checksum, table->checksum(graph.get()));
+
+    auto loaded = DistanceTable::LoadBinary(graph.get(), filename, checksum);
+    ASSERT_FALSE(loaded.get() == nullptr);
+    ExpectSameTable(table.get(), loaded.get());
+
+    ASSERT_TRUE(DistanceTable::LoadBinary(graph.get(), filename, checksum + 1).get() == nullptr);
+
+    auto other = Graph::Create(4);
+    ASSERT_TRUE(DistanceTable::LoadBinary(other.get(), filename, checksum).get() == nullptr);
+
+    // A corrupted body (with an intact header) is also refused.
+    {
+        std::fstream file(filename, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(-1, std::ios::end);
+        file.put('\x7f');
+    }
+
+    ASSERT_TRUE(DistanceTable::LoadBinary(graph.get(), filename, checksum).get() == nullptr);
+
+    std::remove(filename.c_str());
+    ASSERT_TRUE(DistanceTable::LoadBinary(graph.get(), filename, checksum).get() == nullptr);
+}
+
+TEST(DistanceTableTests, MalformedChecksumTest) {
+    Json::Value root(Json::objectValue);
+    root[JsonFields<DistanceTable>::_ChecksumLabel_] = "00000000000000ff";
+    ASSERT_EQ(DistanceTable::ChecksumFromJson(root), 0xffu);
+
+    root[JsonFields<DistanceTable>::_ChecksumLabel_] = "not a checksum";
+    ASSERT_DEATH({ DistanceTable::ChecksumFromJson(root); }, "not a 64-bit hexadecimal number");
+
+    root[JsonFields<DistanceTable>::_ChecksumLabel_] = "00000000000000000ff";
+    ASSERT_DEATH({ DistanceTable::ChecksumFromJson(root); }, "not a 64-bit hexadecimal number");
+}
@@ -2,10 +2,15 @@
 
 #include "enfield/Analysis/Driver.h"
 #include "enfield/Support/RTTI.h"
+#include "enfield/Support/ThreadPool.h"
 
 #include <vector>
+#include <cstdio>
 #include <fstream>
 #include <string>
+#include <thread>
+
+#include <sys/stat.h>
 
 using namespace efd;
 
@@ -29,3 +34,70 @@ TEST(DriverFileTests, ParsingFilesTest) {
         ASSERT_FALSE(root.get() == nullptr);
     }
 }
+
+TEST(DriverFileTests, ConcurrentParsingTest) {
+    const uint32_t rounds = 8;
+    uint32_t n = files.size() * rounds;
+
+    std::vector<std::string> expected;
+    for (const std::string& file : files) {
+        expected.push_back(efd::ParseFile(file, dir)->toString(true));
+    }
+
+    // Each file is parsed many times, by different threads at once.
+    std::vector<std::string> parsed(n);
+    auto pool = ThreadPool::Create(4);
+    pool->run(n, [&](uint32_t tid, uint32_t i) {
+        auto root = efd::ParseFile(files[i % files.size()], dir);
+        if (root.get() != nullptr) parsed[i] = root->toString(true);
+    });
+
+    for (uint32_t i = 0; i < n; ++i) {
+        ASSERT_EQ(parsed[i], expected[i % files.size()]) << files[i % files.size()];
+    }
+}
+
+TEST(DriverFileTests, ParsedBytesTest) {
+    const std::string mainFile = "DriverFileTestsMain.qasm";
+    const std::string incFile = "DriverFileTestsInc.inc";
+    const std::string fifoFile = "DriverFileTestsFifo.qasm";
+
+    const std::string inc = "gate g a { U(0, 0, 0) a; }\n";
+    const std::string program =
+        "OPENQASM 2.0;\ninclude \"" + incFile + "\";\nqreg q[1];\ng q[0];\n";
+
+    {
+        std::ofstream ofs(mainFile);
+        ofs << program;
+        std::ofstream incOfs(incFile);
+        incOfs << inc;
+    }
+
+    // The included file is accounted along with the one that includes it.
+    uint64_t before = ParsedBytes.getVal();
+    ASSERT_FALSE(efd::ParseFile(mainFile, "./", false).get() == nullptr);
+    ASSERT_EQ(ParsedBytes.getVal() - before, program.size() + inc.size());
+
+    // So is the standard library.
+    before = ParsedBytes.getVal();
+    ASSERT_FALSE(efd::ParseFile(mainFile, "./", true).get() == nullptr);
+    ASSERT_GT(ParsedBytes.getVal() - before, program.size() + inc.size());
+
+    // Files that can't be mapped (e.g.: pipes) are accounted as well.
+    std::remove(fifoFile.c_str());
+    ASSERT_EQ(mkfifo(fifoFile.c_str(), 0600), 0);
+    std::thread writer([&]() {
+        std::ofstream ofs(fifoFile);
+        ofs << program;
+    });
+
+    before = ParsedBytes.getVal();
+    auto root = efd::ParseFile(fifoFile, "./", false);
+    writer.join();
+    ASSERT_FALSE(root.get() == nullptr);
+    ASSERT_EQ(ParsedBytes.getVal() - before, program.size() + inc.size());
+
+    std::remove(fifoFile.c_str());
+    std::remove(incFile.c_str());
+    std::remove(mainFile.c_str());
+}
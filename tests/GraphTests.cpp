@@ -5,6 +5,7 @@
 #include "enfield/Support/JsonParser.h"
 
 #include <string>
+#include <vector>
 
 using namespace efd;
 
@@ -56,3 +57,54 @@ TEST(GraphTests, SomeReverseEdgesTest) {
     ASSERT_TRUE(graph->hasEdge(1, 4));
     ASSERT_TRUE(graph->hasEdge(4, 1));
 }
+
+TEST(GraphTests, FrozenViewTest) {
+    auto graph = Graph::Create(5, Graph::Type::Directed);
+    graph->putEdge(0, 1);
+    graph->putEdge(3, 0);
+    graph->putEdge(0, 2);
+    graph->putEdge(4, 3);
+
+    ASSERT_FALSE(graph->isFrozen());
+    std::vector<uint32_t> adj(graph->adj(0).begin(), graph->adj(0).end());
+    ASSERT_EQ(adj, std::vector<uint32_t>({ 1, 2, 3 }));
+
+    graph->freeze();
+    ASSERT_TRUE(graph->isFrozen());
+
+    for (uint32_t i = 0; i < 5; ++i) {
+        for (uint32_t j = 0; j < 5; ++j) {
+            auto& succ = graph->succ(i);
+            ASSERT_EQ(graph->hasEdge(i, j), succ.find(j) != succ.end());
+        }
+    }
+
+    adj.assign(graph->adj(0).begin(), graph->adj(0).end());
+    ASSERT_EQ(adj, std::vector<uint32_t>({ 1, 2, 3 }));
+    ASSERT_EQ(graph->adj(3).size(), 2u);
+    ASSERT_TRUE(graph->adj(1).size() == 1 && *graph->adj(1).begin() == 0);
+
+    // A new edge discards the frozen view.
+    graph->putEdge(1, 4);
+    ASSERT_FALSE(graph->isFrozen());
+    ASSERT_TRUE(graph->hasEdge(1, 4));
+    ASSERT_FALSE(graph->hasEdge(4, 1));
+    ASSERT_EQ(graph->adj(4).size(), 2u);
+}
+
+TEST(GraphTests, ClearSuccAndPredTest) {
+    auto graph = Graph::Create(3, Graph::Type::Directed);
+    graph->putEdge(0, 1);
+    graph->putEdge(2, 0);
+    graph->freeze();
+
+    graph->clearSuccAndPred(0);
+    ASSERT_FALSE(graph->isFrozen());
+    ASSERT_TRUE(graph->succ(0).empty());
+    ASSERT_TRUE(graph->pred(0).empty());
+    ASSERT_FALSE(graph->hasEdge(0, 1));
+
+    // The other ends keep the edges.
+    ASSERT_EQ(graph->pred(1).size(), 1u);
+    ASSERT_TRUE(graph->hasEdge(2, 0));
+}
@@ -0,0 +1,185 @@
+#include "gtest/gtest.h"
+
+#include "enfield/Transform/InstructionStream.h"
+#include "enfield/Transform/Allocators/BoundedMappingTreeQAllocator.h"
+#include "enfield/Transform/Allocators/BMT/DefaultBMTQAllocatorImpl.h"
+#include "enfield/Transform/PassCache.h"
+#include "enfield/Transform/QModule.h"
+#include "enfield/Arch/ArchGraph.h"
+#include "enfield/Support/ApproxTSFinder.h"
+#include "enfield/Support/Defs.h"
+
+#include <string>
+
+using namespace efd;
+
+static const std::string program =
+"\
+OPENQASM 2.0;\
+include \"qelib1.inc\";\
+qreg q[3];\
+creg c[3];\
+CX q[0], q[1];\
+U(pi, 0, pi) q[2];\
+cu1(pi / 2) q[1], q[2];\
+intrinsic_swap__ q[0], q[2];\
+barrier q[0], q[1], q[2];\
+if (c == 1) CX q[1], q[0];\
+reset q[1];\
+measure q[2] -> c[0];\
+";
+
+static std::string StatementsToString(std::vector<Node::uRef>& stmts) {
+    std::string str;
+    for (auto& stmt : stmts) str += stmt->toString(false);
+    return str;
+}
+
+static std::string StatementsToString(QModule::Ref qmod) {
+    std::string str;
+    for (auto it = qmod->stmt_begin(), e = qmod->stmt_end(); it != e; ++it)
+        str += (*it)->toString(false);
+    return str;
+}
+
+TEST(InstructionStreamTests, BuildTest) {
+    auto qmod = QModule::ParseString(program);
+    auto stream = PassCache::GetData<InstructionStreamWrapperPass>(qmod.get());
+
+    std::vector<InstructionStream::Opcode> opcodes {
+        InstructionStream::K_CX, InstructionStream::K_U, InstructionStream::K_GATE,
+        InstructionStream::K_SWAP, InstructionStream::K_BARRIER, InstructionStream::K_CX,
+        InstructionStream::K_RESET, InstructionStream::K_MEASURE
+    };
+
+    std::vector<std::vector<uint32_t>> qargs {
+        { 0, 1 }, { 2 }, { 1, 2 }, { 0, 2 }, { 0, 1, 2 }, { 1, 0 }, { 1 }, { 2 }
+    };
+
+    ASSERT_EQ(stream->size(), opcodes.size());
+
+    for (uint32_t i = 0, e = stream->size(); i < e; ++i) {
+        ASSERT_EQ(stream->getOpcode(i), opcodes[i]);
+        ASSERT_EQ(std::vector<uint32_t>(stream->qargs_begin(i), stream->qargs_end(i)), qargs[i]);
+        ASSERT_EQ(stream->getCond(i) != _undef, i == 5);
+        ASSERT_EQ(stream->getCBit(i) != _undef, i == 7);
+    }
+
+    ASSERT_EQ(stream->getCBit(7), 0u);
+    ASSERT_EQ(stream->mParams.size(), 2u);
+    ASSERT_EQ(stream->mConds.size(), 1u);
+
+    PassCache::Clear();
+}
+
+TEST(InstructionStreamTests, MaterializeTest) {
+    auto qmod = QModule::ParseString(program);
+    auto xtn = PassCache::GetData<XbitToNumberWrapperPass>(qmod.get());
+    auto stream = PassCache::GetData<InstructionStreamWrapperPass>(qmod.get());
+
+    auto stmts = stream->materialize(*xtn);
+    ASSERT_EQ(StatementsToString(stmts), StatementsToString(qmod.get()));
+
+    PassCache::Clear();
+}
+
+TEST(InstructionStreamTests, RemapTest) {
+    auto qmod = QModule::ParseString(program);
+    auto xtn = PassCache::GetData<XbitToNumberWrapperPass>(qmod.get());
+    auto stream = PassCache::GetData<InstructionStreamWrapperPass>(qmod.get());
+
+    Mapping mapping { 2, 0, 1 };
+    auto issued = InstructionStream::WithTablesOf(*stream);
+
+    for (uint32_t i = 0, e = stream->size(); i < e; ++i) {
+        issued.appendMapped(*stream, i, mapping);
+    }
+
+    issued.append(InstructionStream::K_REV_CX, { 0, 1 }, stream->getCond(5));
+    issued.append(InstructionStream::K_LCX, { 0, 1, 2 });
+
+    auto stmts = issued.materialize(*xtn);
+
+    const std::string expected =
+"\
+OPENQASM 2.0;\
+include \"qelib1.inc\";\
+qreg q[3];\
+creg c[3];\
+CX q[2], q[0];\
+U(pi, 0, pi) q[1];\
+cu1(pi / 2) q[0], q[1];\
+intrinsic_swap__ q[2], q[1];\
+barrier q[2], q[0], q[1];\
+if (c == 1) CX q[0], q[2];\
+reset q[0];\
+measure q[1] -> c[0];\
+if (c == 1) intrinsic_rev_cx__ q[0], q[1];\
+intrinsic_lcx__ q[0], q[1], q[2];\
+";
+
+    auto expectedMod = QModule::ParseString(expected);
+    ASSERT_EQ(StatementsToString(stmts), StatementsToString(expectedMod.get()));
+
+    // Not every qubit is mapped, so none of them is replaced.
+    Mapping partial { 2, _undef, 1 };
+    auto kept = InstructionStream::WithTablesOf(*stream);
+    kept.appendMapped(*stream, 0, partial);
+    ASSERT_EQ(std::vector<uint32_t>(kept.qargs_begin(0), kept.qargs_end(0)),
+              std::vector<uint32_t>({ 0, 1 }));
+
+    PassCache::Clear();
+}
+
+TEST(InstructionStreamTests, ConditionalReversedCXTest) {
+    const std::string gStr =
+"{\n\
+    \"qubits\": 2,\n\
+    \"registers\": [ {\"name\": \"q\", \"qubits\": 2} ],\n\
+    \"adj\": [\n\
+        [ {\"v\": \"q[1]\"} ],\n\
+        []\n\
+    ]\n\
+}";
+
+    // The unconditional CXs fix the mapping, so that the conditional one
+    // has to be reversed.
+    const std::string condProgram =
+"\
+qreg q[2];\
+creg c[2];\
+CX q[0], q[1];\
+CX q[0], q[1];\
+if (c == 1) CX q[1], q[0];\
+";
+
+    ArchGraph::sRef g = JsonParser<ArchGraph>::ParseString(gStr);
+    auto qmod = QModule::ParseString(condProgram);
+
+    auto allocator = BoundedMappingTreeQAllocator::Create(g);
+    allocator->setNodeCandidatesGenerator(SeqNCandidatesGenerator::Create());
+    allocator->setChildrenSelector(FirstCandidateSelector::Create());
+    allocator->setPartialSolutionSelector(FirstCandidateSelector::Create());
+    allocator->setSwapCostEstimator(GeoDistanceSwapCEstimator::Create());
+    allocator->setLiveQubitsPreProcessor(GeoNearestLQPProcessor::Create());
+    allocator->setMapSeqSelector(BestNMSSelector::Create());
+    allocator->setTokenSwapFinder(ApproxTSFinder::Create());
+    allocator->run(qmod.get());
+
+    ASSERT_EQ(allocator->getData(), Mapping({ 0, 1 }));
+
+    // The reversed CX keeps the condition of the one it replaces.
+    const std::string expected =
+"\
+qreg q[2];\
+creg c[2];\
+CX q[0], q[1];\
+CX q[0], q[1];\
+if (c == 1) intrinsic_rev_cx__ q[1], q[0];\
+";
+
+    auto expectedMod = QModule::ParseString(expected);
+    ASSERT_EQ(StatementsToString(qmod.get()), StatementsToString(expectedMod.get()));
+
+    PassCache::Clear();
+}
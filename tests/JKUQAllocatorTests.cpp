@@ -9,6 +9,9 @@
 #include "enfield/Support/JsonParser.h"
 #include "enfield/Support/RTTI.h"
 #include "enfield/Support/uRefCast.h"
+#include "enfield/Support/CommandLine.h"
+
+#include "OptionGuard.h"
 
 #include <string>
 
@@ -135,3 +138,31 @@ test q[4], q[1], q[0];\
         TestAllocation(program);
     }
 }
+
+// Restores `-jku-max-nodes` and `-jku-beam-width` after each test.
+class JKUQAllocatorOptionsTests : public ::testing::Test {
+    private:
+        OptionGuard mGuard { &JKUMaxNodes, &JKUBeamWidth };
+};
+
+TEST_F(JKUQAllocatorOptionsTests, MaxNodesBeamTest) {
+    // Keeps the pool tiny, so that the search falls back to a beam.
+    const char* argv[] = { "JKUQAllocatorTests", "--jku-max-nodes", "4", "--jku-beam-width", "2" };
+    efd::ParseArguments(5, argv);
+
+    uint32_t fallbacks = JKUBeamFallbacks.getVal();
+
+    {
+        const std::string program =
+"\
+qreg q[5];\
+gate test a, b, c {CX a, b;CX a, c;CX b, c;}\
+test q[0], q[1], q[2];\
+test q[4], q[1], q[0];\
+test q[3], q[0], q[4];\
+";
+        TestAllocation(program);
+    }
+
+    EXPECT_GT(JKUBeamFallbacks.getVal(), fallbacks);
+}
@@ -10,9 +10,11 @@ static void TestLayersEquality(std::string program,
     auto qmod = QModule::ParseString(program);
     auto lbPass = LayersBuilderPass::Create();
     lbPass->run(qmod.get());
-    auto layers = lbPass->getData();
+    auto& layers = lbPass->getData();
+    auto& indexes = lbPass->getIndexes();
 
     ASSERT_EQ(layers.size(), rLayers.size());
+    ASSERT_EQ(indexes.size(), rLayers.size());
 
     for (uint32_t i = 0, e = layers.size(); i < e; ++i) {
         auto layer = layers[i];
@@ -21,6 +23,11 @@ static void TestLayersEquality(std::string program,
         std::set<std::string> layerStringSet;
         for (auto node : layer) layerStringSet.insert(node->toString(false));
 
+        ASSERT_EQ(indexes[i].size(), layer.size());
+        for (uint32_t j = 0, f = layer.size(); j < f; ++j) {
+            EXPECT_EQ(qmod->getStatement(indexes[i][j]), layer[j]);
+        }
+
         std::vector<std::string> layerStringV(layerStringSet.begin(), layerStringSet.end());
         std::vector<std::string> rLayerStringV(rLayer.begin(), rLayer.end());
 
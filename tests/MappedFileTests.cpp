@@ -0,0 +1,95 @@
+#include "gtest/gtest.h"
+
+#include "enfield/Support/MappedFile.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <unistd.h>
+
+using namespace efd;
+
+static std::string ReadWithIfstream(const std::string& path) {
+    std::ifstream ifs(path.c_str());
+    return std::string(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+}
+
+TEST(MappedFileTests, SameContentsTest) {
+    const std::string path = "files/qft.qasm";
+    std::string expected = ReadWithIfstream(path);
+
+    auto file = MappedFile::Open(path);
+    ASSERT_FALSE(file.get() == nullptr);
+    ASSERT_EQ(file->size(), expected.size());
+    ASSERT_EQ(std::string(file->data(), file->size()), expected);
+
+    std::string streamed(std::istreambuf_iterator<char>(file->getStream()),
+                         std::istreambuf_iterator<char>());
+    ASSERT_EQ(streamed, expected);
+}
+
+TEST(MappedFileTests, StreamTest) {
+    const std::string text = "qreg q[5];\nCX q[0], q[1];\n";
+    MemoryStreamBuf buf(text.data(), text.size());
+    std::istream in(&buf);
+
+    std::string word;
+    in >> word;
+    ASSERT_EQ(word, "qreg");
+
+    char chunk[4];
+    in.read(chunk, 4);
+    ASSERT_EQ(std::string(chunk, 4), " q[5");
+
+    std::getline(in, word);
+    std::getline(in, word);
+    ASSERT_EQ(word, "CX q[0], q[1];");
+    ASSERT_FALSE(std::getline(in, word));
+}
+
+TEST(MappedFileTests, EmptyFileTest) {
+    const std::string path = "mapped-file-tests-empty.qasm";
+    std::ofstream(path.c_str()).close();
+
+    auto file = MappedFile::Open(path);
+    ASSERT_FALSE(file.get() == nullptr);
+    ASSERT_EQ(file->size(), 0u);
+    ASSERT_EQ(file->getStream().get(), std::char_traits<char>::eof());
+
+    std::remove(path.c_str());
+}
+
+TEST(MappedFileTests, PaddingTest) {
+    const std::string path = "mapped-file-tests-padding.qasm";
+    // A file that fills its last page has no zeros mapped after it.
+    const std::string text(sysconf(_SC_PAGESIZE), 'x');
+    std::ofstream(path.c_str()) << text;
+
+    {
+        auto file = MappedFile::Open(path);
+        ASSERT_FALSE(file.get() == nullptr);
+        ASSERT_EQ(file->size(), text.size());
+
+        char* data = file->data();
+        for (uint32_t i = 0; i < MappedFile::Padding; ++i) {
+            ASSERT_EQ(data[text.size() + i], '\0');
+        }
+
+        data[0] = 'y';
+        data[text.size()] = 'y';
+    }
+
+    ASSERT_EQ(ReadWithIfstream(path), text);
+    std::remove(path.c_str());
+}
+
+TEST(MappedFileTests, ErrorTest) {
+    errno = 0;
+    ASSERT_TRUE(MappedFile::Open("files/does-not-exist.qasm").get() == nullptr);
+    ASSERT_EQ(errno, ENOENT);
+
+    ASSERT_TRUE(MappedFile::Open("files").get() == nullptr);
+    ASSERT_EQ(errno, EISDIR);
+}
@@ -0,0 +1,47 @@
+#ifndef __EFD_TESTS_OPTION_GUARD_H__
+#define __EFD_TESTS_OPTION_GUARD_H__
+
+#include "enfield/Support/CommandLine.h"
+
+#include <initializer_list>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace efd {
+    /// \brief Saves the values of some command line options, and restores them
+    /// (by parsing them again) when destroyed.
+    ///
+    /// Boolean options are toggled when parsed. So, an option is only parsed
+    /// again if its value has changed.
+    class OptionGuard {
+        private:
+            std::vector<std::pair<OptBase*, std::string>> mSaved;
+
+        public:
+            OptionGuard(std::initializer_list<OptBase*> opts) {
+                for (auto opt : opts) {
+                    mSaved.push_back(std::make_pair(opt, opt->getStringVal()));
+                }
+            }
+
+            ~OptionGuard() {
+                for (auto& saved : mSaved) {
+                    auto opt = saved.first;
+                    if (opt->getStringVal() == saved.second) continue;
+
+                    // `ParseArguments` removes the first '-'.
+                    std::string flag = "-" + opt->mName;
+                    std::vector<const char*> argv { "OptionGuard", flag.c_str() };
+                    if (opt->argsConsumed() > 0) argv.push_back(saved.second.c_str());
+
+                    ParseArguments(argv.size(), argv.data());
+                }
+            }
+
+            OptionGuard(const OptionGuard&) = delete;
+            OptionGuard& operator=(const OptionGuard&) = delete;
+    };
+}
+
+#endif
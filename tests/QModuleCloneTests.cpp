@@ -118,3 +118,62 @@ reset q0[0];\
 barrier q0, q1;\
 notid(pi + 3 / 8) q0[0], q[1];\
 ");
+
+TEST(NodeCloneTests, CloneOutlivesOriginalTest) {
+    const std::string program =
+"\
+OPENQASM 2.0;\
+include \"qelib1.inc\";\
+qreg q[3];\
+cx q[0], q[1];\
+h q[2];\
+";
+
+    auto qmod = QModule::ParseString(program);
+    ASSERT_FALSE(qmod->getArena().get() == nullptr);
+
+    auto clone = qmod->clone();
+    ASSERT_FALSE(clone->getArena().get() == nullptr);
+    ASSERT_TRUE(clone->getArena() == qmod->getArena());
+
+    auto expected = qmod->toString();
+    // A statement detached from its module keeps its arena alive.
+    Node::uRef stmt;
+    {
+        Arena::Scope scope(qmod->getArena());
+        stmt = qmod->getStatement(0)->clone();
+    }
+
+    auto stmtStr = stmt->toString();
+    qmod.reset();
+
+    ASSERT_EQ(expected, clone->toString());
+    ASSERT_EQ(stmtStr, stmt->toString());
+}
+
+TEST(NodeCloneTests, CloneReusesArenaTest) {
+    const std::string program =
+"\
+OPENQASM 2.0;\
+include \"qelib1.inc\";\
+qreg q[3];\
+cx q[0], q[1];\
+h q[2];\
+";
+
+    auto qmod = QModule::ParseString(program);
+    auto arena = qmod->getArena();
+    auto expected = qmod->toString();
+
+    // The blocks of a destroyed clone are reused by the next one.
+    qmod->clone().reset();
+    auto chunksSize = arena->getChunksSize();
+    auto clone = qmod->clone();
+    ASSERT_EQ(chunksSize, arena->getChunksSize());
+    ASSERT_EQ(expected, clone->toString());
+
+    // No node outlives the modules (e.g.: the intrinsic gates).
+    qmod.reset();
+    clone.reset();
+    ASSERT_EQ(0u, arena->getLiveBlocks());
+}
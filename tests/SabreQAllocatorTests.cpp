@@ -9,8 +9,13 @@
 #include "enfield/Arch/ArchGraph.h"
 #include "enfield/Support/RTTI.h"
 #include "enfield/Support/uRefCast.h"
+#include "enfield/Support/CommandLine.h"
+#include "enfield/Support/ThreadPool.h"
+
+#include "AllocatorTestUtils.h"
 
 #include <string>
+#include <sstream>
 
 using namespace efd;
 
@@ -33,9 +38,10 @@ static ArchGraph::sRef createGraph() {
     return g;
 }
 
-void TestAllocation(const std::string program) {
-    static ArchGraph::sRef g(nullptr);
-    if (g.get() == nullptr) g = createGraph();
+void TestAllocation(const std::string program, ArchGraph::sRef arch = nullptr) {
+    static ArchGraph::sRef defaultGraph(nullptr);
+    if (defaultGraph.get() == nullptr) defaultGraph = createGraph();
+    auto g = (arch.get() != nullptr) ? arch : defaultGraph;
 
     auto qmod = QModule::ParseString(program);
     auto qmodCopy = qmod->clone();
@@ -120,3 +126,82 @@ test q[4], q[1], q[0];\
         TestAllocation(program);
     }
 }
+
+// Restores `-seed` and `-sabre-error-weight` after each test.
+class SabreQAllocatorOptionsTests : public ::testing::Test {
+    private:
+        OptionGuard mGuard { &Seed, &SabreErrorWeight };
+
+    protected:
+        void SetUp() override {
+            const char* argv[] = { "SabreQAllocatorTests", "-seed", "17" };
+            efd::ParseArguments(3, argv);
+        }
+};
+
+static std::string AllocateWithThreads(const std::string program, std::string threads) {
+    static ArchGraph::sRef g(nullptr);
+    if (g.get() == nullptr) g = createGraph();
+
+    return efd::AllocateWithThreads(program, threads, [&]() {
+        return SabreQAllocator::Create(g);
+    });
+}
+
+TEST_F(SabreQAllocatorOptionsTests, ParallelIterationsTest) {
+    const std::string program =
+"\
+qreg q[5];\
+CX q[0], q[1];\
+CX q[1], q[2];\
+CX q[2], q[3];\
+CX q[3], q[4];\
+CX q[4], q[0];\
+CX q[0], q[2];\
+CX q[1], q[3];\
+CX q[2], q[4];\
+CX q[3], q[0];\
+CX q[4], q[1];\
+";
+
+    auto serial = AllocateWithThreads(program, "1");
+    EXPECT_EQ(serial, AllocateWithThreads(program, "1"));
+    EXPECT_EQ(serial, AllocateWithThreads(program, "2"));
+    EXPECT_EQ(serial, AllocateWithThreads(program, "4"));
+}
+
+TEST_F(SabreQAllocatorOptionsTests, ErrorWeightTest) {
+    const std::string program =
+"\
+qreg q[5];\
+CX q[0], q[1];\
+CX q[1], q[2];\
+CX q[2], q[3];\
+CX q[3], q[4];\
+CX q[4], q[0];\
+";
+
+    // The edge (0, 2) fails half of the times.
+    const std::string gStr =
+"{\n\
+    \"qubits\": 5,\n\
+    \"registers\": [ {\"name\": \"q\", \"qubits\": 5} ],\n\
+    \"adj\": [\n\
+        [ {\"v\": \"q[1]\", \"w\": 0.01}, {\"v\": \"q[2]\", \"w\": 0.5} ],\n\
+        [ {\"v\": \"q[2]\", \"w\": 0.01} ],\n\
+        [],\n\
+        [ {\"v\": \"q[2]\", \"w\": 0.01}, {\"v\": \"q[4]\", \"w\": 0.01} ],\n\
+        [ {\"v\": \"q[2]\", \"w\": 0.01} ]\n\
+    ]\n\
+}";
+
+    ArchGraph::sRef g = JsonParser<ArchGraph>::ParseString(gStr);
+
+    // Without errors, the weighted distances are the number of edges.
+    auto unweighted = AllocateWithThreads(program, "1");
+
+    const char* argv[] = { "SabreQAllocatorTests", "--sabre-error-weight", "10" };
+    efd::ParseArguments(3, argv);
+    TestAllocation(program, g);
+    EXPECT_EQ(unweighted, AllocateWithThreads(program, "1"));
+}
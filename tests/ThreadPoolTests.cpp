@@ -0,0 +1,60 @@
+#include "gtest/gtest.h"
+
+#include "enfield/Support/ThreadPool.h"
+
+#include <numeric>
+
+using namespace efd;
+
+TEST(ThreadPoolTests, SerialPoolTest) {
+    auto pool = ThreadPool::Create(1);
+    ASSERT_EQ(pool->size(), (uint32_t) 1);
+
+    std::vector<uint32_t> order;
+    pool->run(10, [&](uint32_t tid, uint32_t i) {
+        EXPECT_EQ(tid, (uint32_t) 0);
+        order.push_back(i);
+    });
+
+    std::vector<uint32_t> expected(10);
+    std::iota(expected.begin(), expected.end(), 0);
+    EXPECT_EQ(order, expected);
+}
+
+TEST(ThreadPoolTests, EveryIndexOnceTest) {
+    const uint32_t nThreads = 4;
+    const uint32_t n = 1000;
+
+    auto pool = ThreadPool::Create(nThreads);
+    ASSERT_EQ(pool->size(), nThreads);
+
+    // Reusing the same pool for many loops, including empty ones.
+    for (uint32_t round = 0; round < 50; ++round) {
+        std::vector<uint32_t> counter(n, 0);
+        std::vector<uint32_t> tids(n, nThreads);
+
+        pool->run(round % 5 == 0 ? 0 : n, [&](uint32_t tid, uint32_t i) {
+            ++counter[i];
+            tids[i] = tid;
+        });
+
+        for (uint32_t i = 0; i < n; ++i) {
+            if (round % 5 == 0) {
+                ASSERT_EQ(counter[i], (uint32_t) 0);
+            } else {
+                ASSERT_EQ(counter[i], (uint32_t) 1);
+                ASSERT_LT(tids[i], nThreads);
+            }
+        }
+    }
+}
+
+TEST(ThreadPoolTests, HardwareThreadsTest) {
+    auto pool = ThreadPool::Create(0);
+    ASSERT_GE(pool->size(), (uint32_t) 1);
+
+    std::vector<uint64_t> partial(pool->size(), 0);
+    pool->run(100, [&](uint32_t tid, uint32_t i) { partial[tid] += i; });
+
+    EXPECT_EQ(std::accumulate(partial.begin(), partial.end(), (uint64_t) 0), (uint64_t) 4950);
+}
@@ -0,0 +1,122 @@
+#include "gtest/gtest.h"
+
+#include "enfield/Support/WeightedDistance.h"
+#include "enfield/Support/DistanceTable.h"
+
+#include <random>
+
+using namespace efd;
+
+typedef WeightedDistance<double> WDouble;
+typedef WeightedDistance<uint32_t> WUInt;
+
+static WeightedGraph<uint32_t>::uRef RandomGraph(uint32_t n, uint32_t m, uint32_t seed) {
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<uint32_t> vertex(0, n - 1);
+    std::uniform_int_distribution<uint32_t> weight(1, 20);
+
+    auto graph = WeightedGraph<uint32_t>::Create(n, Graph::Directed);
+
+    for (uint32_t i = 0; i < m; ++i) {
+        uint32_t u = vertex(gen), v = vertex(gen);
+        if (u != v && !graph->hasEdge(u, v)) graph->putEdge(u, v, weight(gen));
+    }
+
+    return graph;
+}
+
+// Checks that \p path goes through edges of \p g, and costs \p cost.
+static void ExpectPathCost(WeightedGraph<uint32_t>::Ref g, std::vector<uint32_t> path,
+                           uint32_t cost) {
+    uint32_t total = 0;
+
+    for (uint32_t i = 1; i < path.size(); ++i) {
+        uint32_t a = path[i - 1], b = path[i], w = WUInt::Inf();
+        if (g->hasEdge(a, b)) w = std::min(w, g->getW(a, b));
+        if (g->hasEdge(b, a)) w = std::min(w, g->getW(b, a));
+        ASSERT_NE(w, WUInt::Inf());
+        total += w;
+    }
+
+    ASSERT_EQ(total, cost);
+}
+
+TEST(WeightedDistanceTests, SmallGraphTest) {
+    // 0 -> 1 -> 2 is cheaper than 0 -> 2.
+    auto graph = WeightedGraph<double>::Create(4, Graph::Directed);
+    graph->putEdge(0, 1, 1.0);
+    graph->putEdge(1, 2, 1.5);
+    graph->putEdge(0, 2, 3.0);
+
+    for (auto method : { WDouble::M_Dijkstra, WDouble::M_FloydWarshall }) {
+        auto dist = WDouble::Create(method);
+        dist->init(graph.get());
+
+        ASSERT_DOUBLE_EQ(dist->get(0, 2), 2.5);
+        ASSERT_DOUBLE_EQ(dist->get(2, 0), 2.5);
+        ASSERT_DOUBLE_EQ(dist->get(1, 1), 0);
+        ASSERT_EQ(dist->get(0, 3), WDouble::Inf());
+        ASSERT_EQ(dist->path(0, 2), std::vector<uint32_t>({ 0, 1, 2 }));
+        ASSERT_TRUE(dist->path(3, 0).empty());
+    }
+}
+
+TEST(WeightedDistanceTests, EdgeCostTest) {
+    auto graph = WeightedGraph<double>::Create(3, Graph::Directed);
+    graph->putEdge(0, 1, 0.5);
+    graph->putEdge(1, 2, 0.25);
+
+    auto dist = WDouble::Create(WDouble::M_Auto, [](uint32_t u, uint32_t v, double w) {
+        return 1 + w;
+    });
+    dist->init(graph.get());
+
+    ASSERT_DOUBLE_EQ(dist->get(0, 2), 2.75);
+}
+
+TEST(WeightedDistanceTests, UnweightedIsBFSTest) {
+    auto graph = Graph::Create(40, Graph::Directed);
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<uint32_t> vertex(0, 39);
+
+    for (uint32_t i = 0; i < 60; ++i) {
+        uint32_t u = vertex(gen), v = vertex(gen);
+        if (u != v) graph->putEdge(u, v);
+    }
+
+    auto table = DistanceTable::Create(graph.get());
+    auto dist = WUInt::Create();
+    dist->init(graph.get());
+
+    for (uint32_t u = 0; u < 40; ++u)
+        for (uint32_t v = 0; v < 40; ++v) {
+            uint32_t expected = table->get(u, v) == _undef ? WUInt::Inf() : table->get(u, v);
+            ASSERT_EQ(dist->get(u, v), expected);
+        }
+}
+
+TEST(WeightedDistanceTests, DijkstraEqualsFloydWarshallTest) {
+    // Sizes around the block size of the Floyd-Warshall.
+    for (uint32_t n : { 5u, 31u, 32u, 33u, 70u }) {
+        for (uint32_t m : { n, 3 * n, n * n / 2 }) {
+            auto graph = RandomGraph(n, m, n * 1000 + m);
+
+            auto dijkstra = WUInt::Create(WUInt::M_Dijkstra);
+            auto fw = WUInt::Create(WUInt::M_FloydWarshall);
+            dijkstra->init(graph.get());
+            fw->init(graph.get());
+
+            for (uint32_t u = 0; u < n; ++u) {
+                for (uint32_t v = 0; v < n; ++v) {
+                    uint32_t d = dijkstra->get(u, v);
+                    ASSERT_EQ(d, fw->get(u, v));
+
+                    if (d != WUInt::Inf()) {
+                        ExpectPathCost(graph.get(), dijkstra->path(u, v), d);
+                        ExpectPathCost(graph.get(), fw->path(u, v), d);
+                    }
+                }
+            }
+        }
+    }
+}
@@ -25,7 +25,7 @@ qreg q[5];\
         auto pass = XbitToNumberWrapperPass::Create();
         pass->run(qmod.get());
 
-        auto data = pass->getData();
+        auto& data = pass->getData();
         ASSERT_DEATH({ data.getQUId("q"); }, "");
         ASSERT_TRUE(data.getQUId("q[0]") == 0);
         ASSERT_TRUE(data.getQUId("q[1]") == 1);
@@ -51,7 +51,7 @@ gate mygate(a, b, c) x, y, z {\
         auto sign = qmod->getQGate("mygate");
         ASSERT_FALSE(sign == nullptr);
 
-        auto data = pass->getData();
+        auto& data = pass->getData();
         ASSERT_DEATH({ data.getQUId("mygate"); }, "Qubit id not found");
         ASSERT_DEATH({ data.getQUId("x"); }, "Qubit id not found");
         ASSERT_DEATH({ data.getQUId("y"); }, "Qubit id not found");
@@ -90,7 +90,7 @@ measure q[4] -> c[4];\
         auto pass = XbitToNumberWrapperPass::Create();
         pass->run(qmod.get());
 
-        auto data = pass->getData();
+        auto& data = pass->getData();
 
         auto idSign = qmod->getQGate("id");
         ASSERT_FALSE(idSign == nullptr);
@@ -126,3 +126,46 @@ measure q[4] -> c[4];\
         PassCache::Clear();
     }
 }
+
+TEST(XbitToNumberWrapperPassTests, NodeLookupTest) {
+    const std::string program = \
+"\
+qreg q[3];\
+creg c[2];\
+qreg r[2];\
+gate cnot a, b {\
+    CX a, b;\
+}\
+";
+
+    auto qmod = toShared(QModule::ParseString(program));
+    auto pass = XbitToNumberWrapperPass::Create();
+    pass->run(qmod.get());
+
+    auto& data = pass->getData();
+    auto gate = dynCast<NDGateDecl>(qmod->getQGate("cnot"));
+    ASSERT_FALSE(gate == nullptr);
+
+    for (auto reg : { "q", "r" }) {
+        for (uint32_t i = 0; i < 2; ++i) {
+            auto ref = NDIdRef::Create(NDId::Create(reg), NDInt::Create(std::to_string(i)));
+            ASSERT_EQ(data.getQUId(ref.get()), data.getQUId(ref->toString(false)));
+        }
+    }
+
+    for (uint32_t i = 0; i < 2; ++i) {
+        auto ref = NDIdRef::Create(NDId::Create("c"), NDInt::Create(std::to_string(i)));
+        ASSERT_EQ(data.getCUId(ref.get()), data.getCUId(ref->toString(false)));
+    }
+
+    auto a = NDId::Create("a");
+    auto b = NDId::Create("b");
+    ASSERT_EQ(data.getQUId(a.get(), gate), 0u);
+    ASSERT_EQ(data.getQUId(b.get(), gate), 1u);
+    ASSERT_DEATH({ data.getQUId(a.get()); }, "Qubit id not found");
+
+    auto outOfBounds = NDIdRef::Create(NDId::Create("q"), NDInt::Create(std::string("3")));
+    ASSERT_DEATH({ data.getQUId(outOfBounds.get()); }, "Qubit id not found");
+
+    PassCache::Clear();
+}
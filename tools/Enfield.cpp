@@ -79,9 +79,10 @@ static Opt<bool> InlineOutput
 
 static Opt<EnumAllocator> Alloc
 ("alloc", "Sets the allocator to be used.", Allocator::Q_dynprog, false);
-static efd::Opt<EnumArchitecture> Arch
-("arch", "Name of the architechture, or a file with the connectivity graph.",
-Architecture::A_ibmqx2, false);
+static efd::Opt<std::string> Arch
+("arch", "Name of the architechture: either a built-in one (e.g.: `A_ibmqx2`), \
+or a parametric one (`grid-RxC`, `heavyhex-RxC`, `ring-N`, `tree-N`, `alltoall-N`).",
+"A_ibmqx2", false);
 
 static Opt<std::string> PrintDepGraphFile
 ("-print-depgraph", "Choose a file to print the dependency graph.", "", false);
@@ -123,12 +124,12 @@ int main(int argc, char** argv) {
 
     if (qmod.get() != nullptr) {
         ArchGraph::sRef archGraph;
-        if (!ArchFilepath.isParsed() && HasArchitecture(Arch.getVal())) {
-            archGraph = CreateArchitecture(Arch.getVal());
+        if (!ArchFilepath.isParsed() && IsArchitectureName(Arch.getVal())) {
+            archGraph = CreateArchitectureFromName(Arch.getVal());
         } else if (ArchFilepath.isParsed()) {
             archGraph = JsonParser<ArchGraph>::ParseFile(ArchFilepath.getVal());
         } else {
-            ERR << "Architecture: " << Arch.getVal().getStringValue()
+            ERR << "Architecture: " << Arch.getVal()
                 << " not found." << std::endl;
         }
 
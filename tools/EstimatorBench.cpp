@@ -0,0 +1,119 @@
+#include "enfield/Arch/ArchGraph.h"
+#include "enfield/Arch/Architectures.h"
+#include "enfield/Transform/Allocators/BMT/DefaultBMTQAllocatorImpl.h"
+#include "enfield/Transform/Allocators/BMT/ImprovedBMTQAllocatorImpl.h"
+#include "enfield/Support/CommandLine.h"
+#include "enfield/Support/Timer.h"
+#include "enfield/Support/Defs.h"
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+
+using namespace efd;
+
+static Opt<std::string> Arch
+("arch", "Name of the architecture used for the distances (built-in or \
+parametric, e.g.: `heavyhex-7x3`).", "A_ibmqx20", false);
+static Opt<uint32_t> Grid
+("grid", "Uses a NxN grid instead of the architecture (if not 0).", 0, false);
+static Opt<uint32_t> Mappings
+("mappings", "Number of (random) pairs of mappings.", 1000, false);
+static Opt<uint32_t> Reps
+("reps", "Number of times each pair of mappings is estimated.", 200, false);
+static Opt<uint32_t> MappingsSeed
+("seed", "Seed for generating the mappings.", 0, false);
+
+static ArchGraph::sRef CreateGrid(uint32_t n) {
+    ArchGraph::sRef ag(ArchGraph::Create(n * n).release());
+    ag->putReg("q", std::to_string(n * n));
+
+    for (uint32_t i = 0; i < n; ++i) {
+        for (uint32_t j = 0; j < n; ++j) {
+            uint32_t u = i * n + j;
+            if (j + 1 < n) ag->putEdge(u, u + 1, 1.0);
+            if (i + 1 < n) ag->putEdge(u, u + n, 1.0);
+        }
+    }
+
+    ag->freeze();
+    return ag;
+}
+
+// Returns the total time (in nanoseconds) for estimating every pair
+// \p reps times, and accumulates the estimations in \p checksum.
+static uint64_t Run(SwapCostEstimator::Ref estimator,
+                    const std::vector<std::pair<Mapping, Mapping>>& pairs,
+                    uint32_t reps, uint64_t& checksum) {
+    Timer timer;
+    checksum = 0;
+
+    timer.start();
+    for (uint32_t r = 0; r < reps; ++r) {
+        for (const auto& pair : pairs) {
+            checksum += estimator->estimate(pair.first, pair.second);
+        }
+    }
+    timer.stop();
+
+    return timer.getNanoseconds();
+}
+
+int main(int argc, char** argv) {
+    InitializeAllArchitectures();
+    ParseArguments(argc, argv);
+
+    ArchGraph::sRef ag;
+
+    if (Grid.getVal() > 0) {
+        ag = CreateGrid(Grid.getVal());
+    } else {
+        ag.reset(CreateArchitectureFromName(Arch.getVal()).release());
+    }
+
+    uint32_t qubits = ag->size();
+    std::mt19937 gen(MappingsSeed.getVal());
+    std::bernoulli_distribution live(0.75);
+    std::vector<std::pair<Mapping, Mapping>> pairs;
+
+    for (uint32_t i = 0; i < Mappings.getVal(); ++i) {
+        Mapping fromM = IdentityMapping(qubits), toM = IdentityMapping(qubits);
+        std::shuffle(fromM.begin(), fromM.end(), gen);
+        std::shuffle(toM.begin(), toM.end(), gen);
+
+        for (auto& u : fromM) {
+            if (!live(gen)) u = _undef;
+        }
+
+        pairs.push_back(std::make_pair(fromM, toM));
+    }
+
+    auto geo = GeoDistanceSwapCEstimator::Create();
+    auto scalar = FlatGeoDistanceSwapCEstimator::Create();
+    auto simd = FlatGeoDistanceSwapCEstimator::Create();
+    scalar->setUseAVX2(false);
+
+    geo->init(ag.get());
+    scalar->init(ag.get());
+    simd->init(ag.get());
+
+    uint64_t estimations = (uint64_t) Mappings.getVal() * Reps.getVal();
+    uint64_t geoSum, scalarSum, simdSum;
+    uint64_t geoNs = Run(geo.get(), pairs, Reps.getVal(), geoSum);
+    uint64_t scalarNs = Run(scalar.get(), pairs, Reps.getVal(), scalarSum);
+    uint64_t simdNs = Run(simd.get(), pairs, Reps.getVal(), simdSum);
+
+    EfdAbortIf(geoSum != scalarSum || geoSum != simdSum,
+               "Estimations differ: " << geoSum << ", " << scalarSum << ", " << simdSum);
+
+    std::cout << "Qubits: " << qubits << std::endl;
+    std::cout << "Estimations: " << estimations << std::endl;
+    std::cout << "GeoDistance: " << (double) geoNs / estimations << " ns" << std::endl;
+    std::cout << "FlatGeoDistance (scalar): " << (double) scalarNs / estimations << " ns ("
+              << (double) geoNs / scalarNs << "x)" << std::endl;
+    std::cout << "FlatGeoDistance (" << (simd->usesAVX2() ? "avx2" : "scalar") << "): "
+              << (double) simdNs / estimations << " ns ("
+              << (double) geoNs / simdNs << "x)" << std::endl;
+
+    return 0;
+}
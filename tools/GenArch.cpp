@@ -0,0 +1,29 @@
+#include "enfield/Arch/Architectures.h"
+#include "enfield/Support/CommandLine.h"
+#include "enfield/Support/Defs.h"
+
+#include <fstream>
+
+static efd::Opt<std::string> Arch
+("arch", "Name of the architecture: either a built-in one (e.g.: `A_ibmqx2`), \
+or a parametric one (`grid-RxC`, `heavyhex-RxC`, `ring-N`, `tree-N`, `alltoall-N`).",
+"", true);
+static efd::Opt<std::string> Out
+("o", "Name of the output json file.", "/dev/stdout", false);
+
+int main(int argc, char **argv) {
+    efd::InitializeAllArchitectures();
+    efd::ParseArguments(argc, argv);
+
+    EfdAbortIf(!efd::IsArchitectureName(Arch.getVal()),
+               "No such architecture: `" << Arch.getVal() << "`.");
+    auto graph = efd::CreateArchitectureFromName(Arch.getVal());
+
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "";
+
+    std::ofstream o(Out.getVal());
+    o << Json::writeString(builder, graph->toJson()) << std::endl;
+    o.close();
+    return 0;
+}
@@ -0,0 +1,70 @@
+#include "enfield/Arch/ArchGraph.h"
+#include "enfield/Support/CommandLine.h"
+#include "enfield/Support/DistanceTable.h"
+#include "enfield/Support/JsonParser.h"
+#include "enfield/Support/Defs.h"
+
+#include <fstream>
+
+// Returns the directory of \p path (with a trailing `/`), or "" if it has none.
+static std::string DirName(const std::string& path) {
+    auto slash = path.find_last_of('/');
+    return (slash == std::string::npos) ? "" : path.substr(0, slash + 1);
+}
+
+static efd::Opt<std::string> ArchFilepath
+("arch-file", "The architecture json file.", "", true);
+static efd::Opt<std::string> Out
+("o", "Name of the output json file.", "/dev/stdout", false);
+static efd::Opt<std::string> Sidecar
+("-sidecar", "Name of the binary distance table file \
+(default: the output name followed by `.dist`). \
+A relative name is relative to the directory of the output json.", "", false);
+static efd::Opt<uint32_t> SidecarMin
+("-sidecar-min", "Minimum number of qubits for writing the table into a \
+binary file, instead of inside the json.", 256, false);
+
+int main(int argc, char **argv) {
+    efd::ParseArguments(argc, argv);
+
+    Json::Value root;
+    std::ifstream ifs(ArchFilepath.getVal());
+    EfdAbortIf(!ifs, "Could not open `" << ArchFilepath.getVal() << "`.");
+    ifs >> root;
+
+    // An old table could be stale, so we do not even try to load it.
+    root.removeMember(efd::JsonFields<efd::ArchGraph>::_DistancesLabel_);
+
+    auto graph = efd::JsonBackendParser<efd::ArchGraph>::Parse(root);
+    auto table = graph->getDistanceTable();
+
+    Json::Value distances;
+
+    if (graph->size() >= SidecarMin.getVal()) {
+        // The default output is the standard output, which has no directory.
+        EfdAbortIf(!Out.isParsed() && !Sidecar.isParsed(),
+                   "The distance table of `" << graph->size() << "` qubits is written into "
+                   "a binary file. Either `-o` or `--sidecar` must be given.");
+
+        // The json refers to the sidecar relative to its own directory.
+        auto dir = Out.isParsed() ? DirName(Out.getVal()) : "";
+        auto sidecar = Sidecar.isParsed() ?
+            Sidecar.getVal() : Out.getVal().substr(dir.size()) + ".dist";
+        auto path = (sidecar[0] == '/') ? sidecar : dir + sidecar;
+
+        table->writeBinary(graph.get(), path);
+        distances = table->toJson(graph.get(), sidecar);
+    } else {
+        distances = table->toJson(graph.get());
+    }
+
+    root[efd::JsonFields<efd::ArchGraph>::_DistancesLabel_] = distances;
+
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "";
+
+    std::ofstream o(Out.getVal());
+    o << Json::writeString(builder, root) << std::endl;
+    o.close();
+    return 0;
+}